@@ -0,0 +1,188 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * nz_client - client of the inference server nz_server, which also
+ * benchmarks the server with concurrent requests.
+ */
+
+#define _DEFAULT_SOURCE
+#include <neuz/neuz.h>
+#include <ctype.h>
+#include <signal.h>
+
+/* benchmark of a thread */
+typedef struct{
+  const char *path;
+  int nrequest;
+  double *latency;  /* latencies of requests in seconds */
+  bool ok;
+} bench_t;
+
+/* send requests of random inputs one by one. */
+void *client_bench(void *arg)
+{
+  bench_t *bench;
+  nzServeClient client;
+  zVec input, output;
+  double t;
+  int i;
+
+  bench = (bench_t *)arg;
+  bench->ok = false;
+  if( !nzServeClientConnect( &client, bench->path ) ) return NULL;
+  input = zVecAlloc( client.ninput );
+  output = zVecAlloc( client.noutput );
+  if( input && output ){
+    for( i=0; i<bench->nrequest; i++ ){
+      zVecRandUniform( input, -1, 1 );
+      t = nzStatsClock();
+      if( !nzServeClientPredict( &client, input, output ) ) break;
+      bench->latency[i] = nzStatsClock() - t;
+    }
+    bench->ok = i == bench->nrequest;
+  }
+  zVecFreeAtOnce( 2, input, output );
+  nzServeClientClose( &client );
+  return NULL;
+}
+
+/* benchmark the server with concurrent clients. */
+bool client_bench_run(const char *path, int nrequest, int nthread)
+{
+  static const double p[] = { 50, 90, 99, 99.9 };
+  bench_t *bench;
+  pthread_t *thread;
+  double *latency, q[4], t;
+  int i, n;
+  bool ok = true;
+
+  bench = zAlloc( bench_t, nthread );
+  thread = zAlloc( pthread_t, nthread );
+  latency = zAlloc( double, nrequest * nthread );
+  if( !bench || !thread || !latency ){
+    ZALLOCERROR();
+    ok = false;
+    goto TERMINATE;
+  }
+  t = nzStatsClock();
+  for( n=0; n<nthread; n++ ){
+    bench[n].path = path;
+    bench[n].nrequest = nrequest;
+    bench[n].latency = latency + n * nrequest;
+    if( pthread_create( &thread[n], NULL, client_bench, &bench[n] ) != 0 ){
+      ZRUNERROR( NEUZ_ERR_THREAD_CREATE );
+      ok = false;
+      break;
+    }
+  }
+  for( i=0; i<n; i++ ){
+    pthread_join( thread[i], NULL );
+    if( !bench[i].ok ) ok = false;
+  }
+  t = nzStatsClock() - t;
+  if( !ok ) goto TERMINATE;
+  nzServePercentile( latency, nrequest * nthread, p, q, 4 );
+  printf( "%d requests by %d clients in %.3f sec (%.1f requests/sec)\n",
+    nrequest * nthread, nthread, t, nrequest * nthread / t );
+  printf( "latency (usec): p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+    1.0e6*q[0], 1.0e6*q[1], 1.0e6*q[2], 1.0e6*q[3], 1.0e6*latency[nrequest*nthread-1] );
+
+ TERMINATE:
+  free( bench );
+  free( thread );
+  free( latency );
+  return ok;
+}
+
+/* predict outputs for inputs read from the standard input, a sample per line. */
+bool client_predict(const char *path)
+{
+  nzServeClient client;
+  zVec input, output;
+  char buf[BUFSIZ], *p, *q;
+  int i;
+  bool ok = false;
+
+  if( !nzServeClientConnect( &client, path ) ) return false;
+  input = zVecAlloc( client.ninput );
+  output = zVecAlloc( client.noutput );
+  if( !input || !output ) goto TERMINATE;
+  while( fgets( buf, BUFSIZ, stdin ) ){
+    for( p=buf, i=0; i<client.ninput; i++, p=q ){
+      zVecSetElem( input, i, strtod( p, &q ) );
+      if( q == p ) break;
+      while( *q == ',' || isspace( *q ) ) q++;
+    }
+    if( i == 0 ) continue; /* empty line */
+    if( i < client.ninput ){
+      ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, client.ninput, i );
+      continue;
+    }
+    if( !nzServeClientPredict( &client, input, output ) ) goto TERMINATE;
+    zVecPrint( output );
+  }
+  ok = true;
+ TERMINATE:
+  zVecFreeAtOnce( 2, input, output );
+  nzServeClientClose( &client );
+  return ok;
+}
+
+/* print statistics of the server. */
+bool client_stats(const char *path)
+{
+  nzServeClient client;
+  char *stats;
+
+  if( !nzServeClientConnect( &client, path ) ) return false;
+  if( ( stats = nzServeClientStats( &client ) ) ){
+    printf( "%s", stats );
+    free( stats );
+  }
+  nzServeClientClose( &client );
+  return stats != NULL;
+}
+
+void client_usage(const char *cmd)
+{
+  eprintf( "Usage: %s [options]\n", cmd );
+  eprintf( " inputs of samples are read from the standard input, a sample per line,\n" );
+  eprintf( " and outputs of the network are printed unless -n or -S is given.\n" );
+  eprintf( " -s <path>  path of the socket (default: %s)\n", NZ_SERVE_DEFAULT_PATH );
+  eprintf( " -n <n>     benchmark with n requests of random inputs per client\n" );
+  eprintf( " -c <n>     number of concurrent clients of a benchmark (default: 1)\n" );
+  eprintf( " -S         print statistics of the server\n" );
+}
+
+int main(int argc, char *argv[])
+{
+  const char *path = NZ_SERVE_DEFAULT_PATH;
+  int i, nrequest = 0, nthread = 1;
+  bool stats = false, ok;
+
+  for( i=1; i<argc; i++ ){
+    if( strcmp( argv[i], "-s" ) == 0 && i+1 < argc )
+      path = argv[++i];
+    else if( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+      nrequest = atoi( argv[++i] );
+    else if( strcmp( argv[i], "-c" ) == 0 && i+1 < argc )
+      nthread = atoi( argv[++i] );
+    else if( strcmp( argv[i], "-S" ) == 0 )
+      stats = true;
+    else
+      break;
+  }
+  if( i < argc || nrequest < 0 || nthread < 1 ){
+    client_usage( argv[0] );
+    return EXIT_FAILURE;
+  }
+  signal( SIGPIPE, SIG_IGN );
+  zRandInit();
+  if( stats )
+    ok = client_stats( path );
+  else if( nrequest > 0 )
+    ok = client_bench_run( path, nrequest, nthread );
+  else
+    ok = client_predict( path );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,381 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * nz_server - inference server of a neural network with dynamic
+ * micro-batching over a Unix domain socket.
+ */
+
+#define _DEFAULT_SOURCE
+#include <neuz/neuz.h>
+#include <neuz/neuz_serve.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_DEFAULT_BATCH   64 /* maximum number of samples of a batch */
+#define SERVER_DEFAULT_BUDGET 200 /* latency budget to wait for a batch in microseconds */
+#define SERVER_LATENCY_WINDOW 65536 /* number of latest requests to compute percentiles */
+
+/* request of prediction from a connection */
+typedef struct _request_t{
+  const double *input;
+  double *output;
+  int n;                    /* number of samples */
+  double t_arrive;          /* arrival time */
+  bool done;
+  struct _request_t *next;
+} request_t;
+
+/* server */
+typedef struct{
+  nzDenseNet dn;
+  int maxbatch;             /* maximum number of samples of a batch */
+  double budget;            /* latency budget in seconds */
+  int listener;             /* listening socket */
+  pthread_mutex_t mutex;    /* lock of the following members */
+  pthread_cond_t cond_queue;/* signal of a new request */
+  pthread_cond_t cond_done; /* signal of completion of a batch */
+  request_t *head, *tail;   /* queue of requests */
+  int nqueued;              /* number of samples in the queue */
+  int nwaiting;             /* number of requests in the queue */
+  int nconnection;          /* number of connections */
+  /* statistics */
+  double t_start;
+  unsigned long nrequest, nsample, nbatch;
+  double *latency;          /* ring buffer of latencies in seconds */
+  unsigned long nlatency;   /* number of latencies recorded */
+} server_t;
+
+static server_t server;
+static volatile sig_atomic_t server_quit = 0;
+
+/* load a network from a ZTK file or a binary file of a compiled network. */
+bool server_load(server_t *sv, const char filename[])
+{
+  nzNet net;
+  const char *ext;
+  bool ret;
+
+  ext = strrchr( filename, '.' );
+  if( !ext || strcmp( ext, ".ztk" ) != 0 ) /* binary file shared with other processes */
+    return nzDenseNetMapBinary( &sv->dn, filename ) != NULL;
+  if( !nzNetReadZTK( &net, filename ) ) return false;
+  ret = nzDenseNetCompile( &sv->dn, &net ) != NULL;
+  nzNetDestroy( &net );
+  return ret;
+}
+
+/* statistics of the server. */
+int server_stats(server_t *sv, char *buf, size_t size)
+{
+  static const double p[] = { 50, 90, 99, 99.9 };
+  double q[4], *lat, elapsed;
+  unsigned long nrequest, nsample, nbatch;
+  int n, nconnection;
+
+  pthread_mutex_lock( &sv->mutex );
+  nrequest = sv->nrequest;
+  nsample = sv->nsample;
+  nbatch = sv->nbatch;
+  nconnection = sv->nconnection;
+  n = zMin( sv->nlatency, SERVER_LATENCY_WINDOW );
+  if( ( lat = zAlloc( double, n + 1 ) ) ) memcpy( lat, sv->latency, sizeof(double) * n );
+  pthread_mutex_unlock( &sv->mutex );
+  if( !lat ) return snprintf( buf, size, "out of memory\n" );
+  nzServePercentile( lat, n, p, q, 4 );
+  elapsed = nzStatsClock() - sv->t_start;
+  n = snprintf( buf, size,
+    "uptime: %.3f sec\n"
+    "connections: %d\n"
+    "requests: %lu (%.1f requests/sec)\n"
+    "samples: %lu (%.1f samples/sec)\n"
+    "batches: %lu (%.2f samples/batch)\n"
+    "latency of %d latest requests (usec): p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+    elapsed, nconnection,
+    nrequest, nrequest / elapsed, nsample, nsample / elapsed,
+    nbatch, nbatch > 0 ? (double)nsample / nbatch : 0,
+    n, 1.0e6*q[0], 1.0e6*q[1], 1.0e6*q[2], 1.0e6*q[3], n > 0 ? 1.0e6*lat[n-1] : 0 );
+  free( lat );
+  return n;
+}
+
+/* batcher thread, which coalesces requests in the queue into a batch and propagates it. */
+void *server_batcher(void *arg)
+{
+  server_t *sv;
+  request_t *req, *batch, *last;
+  zMat input, output;
+  struct timespec ts;
+  double deadline, t;
+  int n, m, capacity;
+
+  sv = (server_t *)arg;
+  capacity = sv->maxbatch;
+  input = zMatAlloc( sv->maxbatch, nzDenseNetInputSize(&sv->dn) );
+  output = zMatAlloc( sv->maxbatch, nzDenseNetOutputSize(&sv->dn) );
+  if( !input || !output ){
+    ZALLOCERROR();
+    exit( EXIT_FAILURE );
+  }
+  pthread_mutex_lock( &sv->mutex );
+  while( !server_quit ){
+    while( !sv->head && !server_quit )
+      pthread_cond_wait( &sv->cond_queue, &sv->mutex );
+    if( server_quit ) break;
+    /* wait for following requests within the budget of the oldest one
+     * unless every connection, which has a request at once, has sent one */
+    deadline = sv->head->t_arrive + sv->budget;
+    while( sv->nqueued < sv->maxbatch && sv->nwaiting < sv->nconnection &&
+           nzStatsClock() < deadline && !server_quit ){
+      ts.tv_sec = (time_t)deadline;
+      ts.tv_nsec = (long)( 1.0e9 * ( deadline - ts.tv_sec ) );
+      pthread_cond_timedwait( &sv->cond_queue, &sv->mutex, &ts );
+    }
+    /* take requests up to the maximum size of a batch, at least one */
+    batch = last = sv->head;
+    for( n=batch->n, m=1; last->next && n + last->next->n <= sv->maxbatch; last=last->next, m++ )
+      n += last->next->n;
+    if( !( sv->head = last->next ) ) sv->tail = NULL;
+    last->next = NULL;
+    sv->nqueued -= n;
+    sv->nwaiting -= m;
+    pthread_mutex_unlock( &sv->mutex );
+
+    if( n > capacity ){ /* a large request is propagated as it is */
+      zMatFree( input );
+      zMatFree( output );
+      input = zMatAlloc( n, nzDenseNetInputSize(&sv->dn) );
+      output = zMatAlloc( n, nzDenseNetOutputSize(&sv->dn) );
+      if( !input || !output ){
+        ZALLOCERROR();
+        exit( EXIT_FAILURE );
+      }
+      capacity = n;
+    }
+    zMatSetRowSizeNC( input, n );
+    zMatSetRowSizeNC( output, n );
+    for( n=0, req=batch; req; n+=req->n, req=req->next )
+      memcpy( zMatRowBufNC(input,n), req->input, sizeof(double) * req->n * zMatColSizeNC(input) );
+    nzDenseNetPropagateBatch( &sv->dn, input, output );
+    for( n=0, req=batch; req; n+=req->n, req=req->next )
+      memcpy( req->output, zMatRowBufNC(output,n), sizeof(double) * req->n * zMatColSizeNC(output) );
+    t = nzStatsClock();
+
+    pthread_mutex_lock( &sv->mutex );
+    for( req=batch; req; req=req->next ){
+      req->done = true;
+      sv->latency[sv->nlatency++ % SERVER_LATENCY_WINDOW] = t - req->t_arrive;
+      sv->nrequest++;
+    }
+    sv->nsample += n;
+    sv->nbatch++;
+    pthread_cond_broadcast( &sv->cond_done );
+  }
+  pthread_mutex_unlock( &sv->mutex );
+  zMatFreeAtOnce( 2, input, output );
+  return NULL;
+}
+
+/* put a request into the queue, and wait for completion. */
+void server_predict(server_t *sv, request_t *req)
+{
+  req->done = false;
+  req->next = NULL;
+  pthread_mutex_lock( &sv->mutex );
+  req->t_arrive = nzStatsClock();
+  if( sv->tail )
+    sv->tail->next = req;
+  else
+    sv->head = req;
+  sv->tail = req;
+  sv->nqueued += req->n;
+  sv->nwaiting++;
+  pthread_cond_signal( &sv->cond_queue );
+  while( !req->done )
+    pthread_cond_wait( &sv->cond_done, &sv->mutex );
+  pthread_mutex_unlock( &sv->mutex );
+}
+
+/* connection thread, which serves requests from a client one by one. */
+void *server_connection(void *arg)
+{
+  server_t *sv = &server;
+  request_t req;
+  void *buf = NULL;
+  double *output = NULL, *p;
+  size_t size = 0;
+  char msg[BUFSIZ];
+  uint32_t code, len, info[2];
+  int fd, nin, nout;
+  bool ret = true;
+
+  fd = (int)(long)arg;
+  nin = nzDenseNetInputSize(&sv->dn);
+  nout = nzDenseNetOutputSize(&sv->dn);
+  while( ret && nzServeRecv( fd, &code, &len, &buf, &size ) ){
+    switch( code ){
+    case NZ_SERVE_PREDICT:
+      if( len == 0 || len % ( sizeof(double) * nin ) != 0 ){
+        len = snprintf( msg, BUFSIZ, "payload of %u bytes is not inputs of samples of %d inputs", len, nin );
+        ret = nzServeSend( fd, NZ_SERVE_ERROR, msg, len + 1 );
+        break;
+      }
+      req.n = len / ( sizeof(double) * nin );
+      if( !( p = zRealloc( output, double, req.n * nout ) ) ){
+        ret = nzServeSend( fd, NZ_SERVE_ERROR, "out of memory", 14 );
+        break;
+      }
+      output = p;
+      req.input = (const double *)buf;
+      req.output = output;
+      server_predict( sv, &req );
+      ret = nzServeSend( fd, NZ_SERVE_OK, output, sizeof(double) * req.n * nout );
+      break;
+    case NZ_SERVE_INFO:
+      info[0] = nin;
+      info[1] = nout;
+      ret = nzServeSend( fd, NZ_SERVE_OK, info, sizeof(info) );
+      break;
+    case NZ_SERVE_STATS:
+      len = server_stats( sv, msg, BUFSIZ );
+      ret = nzServeSend( fd, NZ_SERVE_OK, msg, zMin( len, BUFSIZ-1 ) );
+      break;
+    default:
+      len = snprintf( msg, BUFSIZ, "unknown request %u", code );
+      ret = nzServeSend( fd, NZ_SERVE_ERROR, msg, len + 1 );
+    }
+  }
+  close( fd );
+  free( buf );
+  free( output );
+  pthread_mutex_lock( &sv->mutex );
+  sv->nconnection--;
+  pthread_mutex_unlock( &sv->mutex );
+  return NULL;
+}
+
+/* open a listening socket. */
+bool server_listen(server_t *sv, const char path[])
+{
+  struct sockaddr_un addr;
+
+  if( strlen( path ) >= sizeof(addr.sun_path) ){
+    ZRUNERROR( NEUZ_ERR_SERVE_PATH, path );
+    return false;
+  }
+  memset( &addr, 0, sizeof(addr) );
+  addr.sun_family = AF_UNIX;
+  strcpy( addr.sun_path, path );
+  unlink( path );
+  if( ( sv->listener = socket( AF_UNIX, SOCK_STREAM, 0 ) ) < 0 ||
+      bind( sv->listener, (struct sockaddr *)&addr, sizeof(addr) ) < 0 ||
+      listen( sv->listener, SOMAXCONN ) < 0 ){
+    perror( path );
+    return false;
+  }
+  return true;
+}
+
+void server_handler(int sig)
+{
+  server_quit = 1;
+}
+
+void server_usage(const char *cmd)
+{
+  eprintf( "Usage: %s [options] <network file>\n", cmd );
+  eprintf( " a network is read from a ZTK file (*.ztk) or mapped from a binary file\n" );
+  eprintf( " written by nzDenseNetWriteBinary(), which is shared by processes.\n" );
+  eprintf( " -s <path>  path of the socket (default: %s)\n", NZ_SERVE_DEFAULT_PATH );
+  eprintf( " -b <n>     maximum number of samples of a batch (default: %d)\n", SERVER_DEFAULT_BATCH );
+  eprintf( " -l <usec>  latency budget to wait for following requests (default: %d)\n", SERVER_DEFAULT_BUDGET );
+}
+
+int main(int argc, char *argv[])
+{
+  const char *path = NZ_SERVE_DEFAULT_PATH, *filename = NULL;
+  struct sigaction sa;
+  pthread_t batcher, thread;
+  pthread_condattr_t attr;
+  char buf[BUFSIZ];
+  int i, fd;
+
+  server.maxbatch = SERVER_DEFAULT_BATCH;
+  server.budget = 1.0e-6 * SERVER_DEFAULT_BUDGET;
+  for( i=1; i<argc; i++ ){
+    if( strcmp( argv[i], "-s" ) == 0 && i+1 < argc )
+      path = argv[++i];
+    else if( strcmp( argv[i], "-b" ) == 0 && i+1 < argc )
+      server.maxbatch = atoi( argv[++i] );
+    else if( strcmp( argv[i], "-l" ) == 0 && i+1 < argc )
+      server.budget = 1.0e-6 * atof( argv[++i] );
+    else if( argv[i][0] != '-' && !filename )
+      filename = argv[i];
+    else
+      break;
+  }
+  if( i < argc || !filename || server.maxbatch < 1 || server.budget < 0 ){
+    server_usage( argv[0] );
+    return EXIT_FAILURE;
+  }
+  if( !server_load( &server, filename ) ) return EXIT_FAILURE;
+  if( !( server.latency = zAlloc( double, SERVER_LATENCY_WINDOW ) ) ){
+    ZALLOCERROR();
+    return EXIT_FAILURE;
+  }
+  server.head = server.tail = NULL;
+  server.nqueued = server.nwaiting = server.nconnection = 0;
+  server.nrequest = server.nsample = server.nbatch = server.nlatency = 0;
+  pthread_mutex_init( &server.mutex, NULL );
+  pthread_condattr_init( &attr );
+  pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+  pthread_cond_init( &server.cond_queue, &attr );
+  pthread_cond_init( &server.cond_done, NULL );
+  if( !server_listen( &server, path ) ) return EXIT_FAILURE;
+
+  /* accept() is interrupted by signals to quit */
+  memset( &sa, 0, sizeof(sa) );
+  sa.sa_handler = server_handler;
+  sigaction( SIGINT, &sa, NULL );
+  sigaction( SIGTERM, &sa, NULL );
+  signal( SIGPIPE, SIG_IGN );
+
+  server.t_start = nzStatsClock();
+  if( pthread_create( &batcher, NULL, server_batcher, &server ) != 0 ){
+    ZRUNERROR( NEUZ_ERR_THREAD_CREATE );
+    return EXIT_FAILURE;
+  }
+  eprintf( "serving %s (%d inputs, %d outputs) at %s\n", filename,
+    nzDenseNetInputSize(&server.dn), nzDenseNetOutputSize(&server.dn), path );
+  while( !server_quit ){
+    if( ( fd = accept( server.listener, NULL, NULL ) ) < 0 ){
+      if( errno != EINTR ) perror( "accept" );
+      continue;
+    }
+    pthread_mutex_lock( &server.mutex );
+    server.nconnection++;
+    pthread_mutex_unlock( &server.mutex );
+    if( pthread_create( &thread, NULL, server_connection, (void *)(long)fd ) != 0 ){
+      ZRUNERROR( NEUZ_ERR_THREAD_CREATE );
+      close( fd );
+      pthread_mutex_lock( &server.mutex );
+      server.nconnection--;
+      pthread_mutex_unlock( &server.mutex );
+      continue;
+    }
+    pthread_detach( thread );
+  }
+  /* connections are closed at exit */
+  pthread_mutex_lock( &server.mutex );
+  pthread_cond_broadcast( &server.cond_queue );
+  pthread_mutex_unlock( &server.mutex );
+  pthread_join( batcher, NULL );
+  close( server.listener );
+  unlink( path );
+  server_stats( &server, buf, BUFSIZ );
+  eprintf( "%s", buf );
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * neuz_bench - benchmark of propagation, back-propagation, training
+ * and file I/O of neural networks. Results are printed in JSON.
+ */
+
+#include <sys/resource.h>
+#include <neuz/neuz.h>
+
+#define BENCH_ZTK_FILE "neuz_bench.ztk"
+
+/* benchmark configuration */
+typedef struct{
+  int input;     /* size of the input layer */
+  int width;     /* size of hidden layers */
+  int depth;     /* number of hidden layers */
+  int output;    /* size of the output layer */
+  nzActivator *activator;
+  int batch;     /* number of samples of a batch */
+  int nthread;   /* number of threads attached to the network */
+  double mintime; /* minimum time of each measurement */
+  const char *file;
+} bench_t;
+
+/* peak resident set size in kilobytes. */
+long bench_peak_rss(void)
+{
+  struct rusage ru;
+
+  if( getrusage( RUSAGE_SELF, &ru ) != 0 ) return -1;
+  return ru.ru_maxrss;
+}
+
+void bench_usage(const char *cmd)
+{
+  eprintf( "Usage: %s [options]\n", cmd );
+  eprintf( " -i <n>     size of the input layer (default: 16)\n" );
+  eprintf( " -w <n>     size of hidden layers (default: 256)\n" );
+  eprintf( " -d <n>     number of hidden layers (default: 2)\n" );
+  eprintf( " -o <n>     size of the output layer (default: 4)\n" );
+  eprintf( " -a <type>  activator of hidden layers (default: sigmoid)\n" );
+  eprintf( " -b <n>     number of samples of a batch (default: 64)\n" );
+  eprintf( " -j <n>     number of threads to propagate a network (default: 1)\n" );
+  eprintf( " -t <sec>   minimum time of each measurement (default: 0.5)\n" );
+  eprintf( " -f <file>  temporary ZTK file (default: %s)\n", BENCH_ZTK_FILE );
+}
+
+bool bench_option(bench_t *bench, int argc, char *argv[])
+{
+  int i;
+
+  bench->input = 16;
+  bench->width = 256;
+  bench->depth = 2;
+  bench->output = 4;
+  bench->activator = &nz_activator_sigmoid;
+  bench->batch = 64;
+  bench->nthread = 1;
+  bench->mintime = 0.5;
+  bench->file = BENCH_ZTK_FILE;
+  for( i=1; i<argc; i++ ){
+    if( argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i+1 >= argc ) goto FAILURE;
+    switch( argv[i++][1] ){
+    case 'i': bench->input = atoi( argv[i] ); break;
+    case 'w': bench->width = atoi( argv[i] ); break;
+    case 'd': bench->depth = atoi( argv[i] ); break;
+    case 'o': bench->output = atoi( argv[i] ); break;
+    case 'a':
+      if( !( bench->activator = nzActivatorAssignByStr( argv[i] ) ) ) goto FAILURE;
+      break;
+    case 'b': bench->batch = atoi( argv[i] ); break;
+    case 'j': bench->nthread = atoi( argv[i] ); break;
+    case 't': bench->mintime = atof( argv[i] ); break;
+    case 'f': bench->file = argv[i]; break;
+    default: goto FAILURE;
+    }
+  }
+  if( bench->input < 1 || bench->width < 1 || bench->depth < 1 || bench->output < 1 || bench->batch < 1 ) goto FAILURE;
+  return true;
+
+ FAILURE:
+  bench_usage( argv[0] );
+  return false;
+}
+
+/* create a fully-connected network. */
+bool bench_net(bench_t *bench, nzNet *net)
+{
+  int i;
+
+  nzNetInit( net );
+  if( !nzNetAddGroupSetActivator( net, bench->input, NULL ) ) return false;
+  for( i=0; i<bench->depth; i++ )
+    if( !nzNetAddGroupSetActivator( net, bench->width, bench->activator ) ||
+        !nzNetConnectGroup( net, i, i+1 ) ) return false;
+  return nzNetAddGroupSetActivator( net, bench->output, &nz_activator_ident ) &&
+         nzNetConnectGroup( net, bench->depth, bench->depth+1 );
+}
+
+/* number of connections of a network. */
+int bench_connections(bench_t *bench)
+{
+  return bench->input * bench->width + ( bench->depth - 1 ) * bench->width * bench->width + bench->width * bench->output;
+}
+
+/* result of a measurement. */
+typedef struct{
+  const char *name;
+  int n;    /* number of calls */
+  int s;    /* number of samples processed per call */
+  double t; /* elapsed time */
+} bench_result_t;
+
+#define BENCH_RESULT_NUM 9
+
+/* print a result of a measurement. */
+void bench_report(bench_t *bench, bench_result_t *r, bool last)
+{
+  printf( "    { \"name\": \"%s\", \"calls\": %d, \"seconds\": %.6g, \"usec_per_call\": %.6g, \"samples_per_sec\": %.6g, \"ns_per_connection\": %.6g }%s\n",
+    r->name, r->n, r->t, 1.0e6 * r->t / r->n, r->s > 0 ? (double)r->n * r->s / r->t : 0, 1.0e9 * r->t / ( (double)r->n * zMax( r->s, 1 ) * bench_connections( bench ) ), last ? "" : "," );
+}
+
+/* measure a function repeatedly for the minimum time, and store the result. */
+#define BENCH_MEASURE(bench,r,_name,_s,statement) do{\
+  double __t0;\
+  (r)->name = _name;\
+  (r)->s = _s;\
+  for( (r)->n=1; ; (r)->n*=2 ){\
+    int __i;\
+    __t0 = nzStatsClock();\
+    for( __i=0; __i<(r)->n; __i++ ){ statement; }\
+    if( ( (r)->t = nzStatsClock() - __t0 ) >= (bench)->mintime ) break;\
+  }\
+  (r)++;\
+} while(0)
+
+int main(int argc, char *argv[])
+{
+  bench_t bench;
+  nzNet net, net_read;
+  nzThreadPool pool;
+  nzDenseNet dn;
+  zVec input, des;
+  zMat input_batch, output_batch, des_batch;
+  bench_result_t result[BENCH_RESULT_NUM], *r;
+  int i, nfail = 0, ret = EXIT_FAILURE;
+
+  if( !bench_option( &bench, argc, argv ) ) return EXIT_FAILURE;
+  zRandInit();
+  if( !bench_net( &bench, &net ) ) return EXIT_FAILURE;
+  if( bench.nthread > 1 ){
+    if( !nzThreadPoolCreate( &pool, bench.nthread ) ) return EXIT_FAILURE;
+    nzNetSetThreadPool( &net, &pool );
+  }
+  input = zVecAlloc( bench.input );
+  des = zVecAlloc( bench.output );
+  input_batch = zMatAlloc( bench.batch, bench.input );
+  output_batch = zMatAlloc( bench.batch, bench.output );
+  des_batch = zMatAlloc( bench.batch, bench.output );
+  for( i=0; i<bench.input; i++ ) zVecElemNC(input,i) = zRandF( -1, 1 );
+  for( i=0; i<bench.output; i++ ) zVecElemNC(des,i) = zRandF( -1, 1 );
+  for( i=0; i<bench.batch*bench.input; i++ ) zMatBufNC(input_batch)[i] = zRandF( -1, 1 );
+  for( i=0; i<bench.batch*bench.output; i++ ) zMatBufNC(des_batch)[i] = zRandF( -1, 1 );
+
+  /* measurements */
+  nzDenseNetInit( &dn );
+  if( !nzNetWriteZTK( &net, bench.file ) || !nzNetReadZTK( &net_read, bench.file ) ){
+    eprintf( "failed to write or read %s\n", bench.file );
+    goto TERMINATE;
+  }
+  nzNetDestroy( &net_read );
+  r = result;
+  BENCH_MEASURE( &bench, r, "nzNetPropagate", 1, nzNetPropagate( &net, input ) );
+  BENCH_MEASURE( &bench, r, "nzNetBackPropagate", 1, nzNetBackPropagate( &net, input, des, nzLossGradSquareSum ) );
+  BENCH_MEASURE( &bench, r, "nzNetTrainSDM", 0, nzNetTrainSDM( &net, 0 ) );
+  BENCH_MEASURE( &bench, r, "nzNetWriteZTK", 0, if( !nzNetWriteZTK( &net, bench.file ) ) nfail++ );
+  BENCH_MEASURE( &bench, r, "nzNetReadZTK", 0, if( nzNetReadZTK( &net_read, bench.file ) ) nzNetDestroy( &net_read ); else nfail++ );
+  remove( bench.file );
+  if( nfail > 0 ){
+    eprintf( "failed to write or read %s %d times\n", bench.file, nfail );
+    goto TERMINATE;
+  }
+  if( !nzDenseNetCompile( &dn, &net ) ) goto TERMINATE;
+  BENCH_MEASURE( &bench, r, "nzDenseNetPropagate", 1, nzDenseNetPropagate( &dn, input ) );
+  BENCH_MEASURE( &bench, r, "nzDenseNetPropagateBatch", bench.batch, nzDenseNetPropagateBatch( &dn, input_batch, output_batch ) );
+  BENCH_MEASURE( &bench, r, "nzDenseNetBackPropagateBatch", bench.batch, nzDenseNetBackPropagateBatch( &dn, input_batch, des_batch, nzLossGradSquareSum ) );
+  BENCH_MEASURE( &bench, r, "nzDenseNetTrainSDM", 0, nzDenseNetTrainSDM( &dn, 0 ) );
+
+  /* results are printed only after every measurement succeeds */
+  printf( "{\n" );
+  printf( "  \"config\": { \"input\": %d, \"width\": %d, \"depth\": %d, \"output\": %d, \"activator\": \"%s\", \"batch\": %d, \"threads\": %d, \"connections\": %d, \"precision\": \"%s\", \"simd_level\": %d },\n",
+    bench.input, bench.width, bench.depth, bench.output, bench.activator->typestr, bench.batch, bench.nthread,
+    bench_connections( &bench ), sizeof(nzReal) == sizeof(float) ? "single" : "double", nzSIMDLevel() );
+  printf( "  \"results\": [\n" );
+  for( i=0; i<BENCH_RESULT_NUM; i++ )
+    bench_report( &bench, &result[i], i == BENCH_RESULT_NUM-1 );
+  printf( "  ],\n" );
+  printf( "  \"peak_rss_kb\": %ld\n", bench_peak_rss() );
+  printf( "}\n" );
+  ret = EXIT_SUCCESS;
+
+ TERMINATE:
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &net );
+  if( bench.nthread > 1 ) nzThreadPoolDestroy( &pool );
+  zVecFreeAtOnce( 2, input, des );
+  zMatFreeAtOnce( 3, input_batch, output_batch, des_batch );
+  return ret;
+}
@@ -0,0 +1,80 @@
+#include <neuz/neuz.h>
+
+#define N     100000
+#define RANGE     20
+#define N_REPEAT 200
+
+/* nanoseconds per element of an array operation */
+double measure(void (* f_array)(const nzReal[],nzReal[],int), nzReal *x, nzReal *y)
+{
+  double t0;
+  int i;
+
+  t0 = nzStatsClock();
+  for( i=0; i<N_REPEAT; i++ ) f_array( x, y, N );
+  return 1.0e9 * ( nzStatsClock() - t0 ) / N_REPEAT / N;
+}
+
+/* fast activators and the maximum errors documented in neuz_activator.h */
+typedef struct{
+  nzActivator *approx;
+  nzActivator *exact;
+  double bound_f;
+  double bound_df;
+} fast_t;
+
+fast_t fast[] = {
+  { &nz_activator_sigmoid_fast,  &nz_activator_sigmoid,  8.0e-7, 1.2e-6 },
+  { &nz_activator_sigmoid_table, &nz_activator_sigmoid,  1.0e-7, 2.0e-7 },
+  { &nz_activator_softplus_fast, &nz_activator_softplus, 1.4e-6, 8.0e-7 },
+  { NULL, NULL, 0, 0 },
+};
+
+bool compare(fast_t *fa, nzReal *x, nzReal *y, nzReal *z)
+{
+  double err_f = 0, err_df = 0, err_array = 0, err_darray = 0, slack;
+  int i;
+
+  for( i=0; i<N; i++ ){
+    err_f = zMax( err_f, fabs( fa->approx->f( x[i] ) - fa->exact->f( x[i] ) ) );
+    err_df = zMax( err_df, fabs( fa->approx->df( x[i] ) - fa->exact->df( x[i] ) ) );
+  }
+  fa->approx->f_array( x, y, N );
+  fa->exact->f_array( x, z, N );
+  for( i=0; i<N; i++ )
+    err_array = zMax( err_array, fabs( y[i] - z[i] ) );
+  fa->approx->df_array( x, y, N );
+  fa->exact->df_array( x, z, N );
+  for( i=0; i<N; i++ )
+    err_darray = zMax( err_darray, fabs( y[i] - z[i] ) );
+  printf( "%-14s max.error f: %.3g df: %.3g array: %.3g %.3g, %.3g ns/element (%s: %.3g ns/element)\n",
+    fa->approx->typestr, err_f, err_df, err_array, err_darray,
+    measure( fa->approx->f_array, x, y ), fa->exact->typestr, measure( fa->exact->f_array, x, y ) );
+  /* arrays in single precision are rounded up to about 20 * 2^-23 */
+  slack = sizeof(nzReal) == sizeof(float) ? 4.0e-6 : 0;
+  if( err_f <= fa->bound_f && err_df <= fa->bound_df &&
+      err_array <= fa->bound_f + slack && err_darray <= fa->bound_df + slack ) return true;
+  printf( "  exceeds the documented bounds f: %.3g df: %.3g\n", fa->bound_f, fa->bound_df );
+  return false;
+}
+
+int main(int argc, char *argv[])
+{
+  nzReal *x, *y, *z;
+  int i, level;
+  bool ok = true;
+
+  x = zAlloc( nzReal, N );
+  y = zAlloc( nzReal, N );
+  z = zAlloc( nzReal, N );
+  for( i=0; i<N; i++ ) x[i] = RANGE * ( 2.0 * i / ( N - 1 ) - 1 );
+  for( level=nzSIMDLevel(); level>=NZ_SIMD_NONE; level-- ){
+    printf( "SIMD level %d\n", nzSIMDSetLevel( level ) );
+    for( i=0; fast[i].approx; i++ )
+      if( !compare( &fast[i], x, y, z ) ) ok = false;
+  }
+  zFree( x );
+  zFree( y );
+  zFree( z );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
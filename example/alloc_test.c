@@ -0,0 +1,103 @@
+/* count heap allocations in training steps.
+ * malloc(), calloc() and realloc() are replaced with counting wrappers
+ * of the allocators of the GNU C library. */
+#include <neuz/neuz.h>
+
+#define N_STEP  1000
+#define N_BATCH   16
+#define RATE    0.01
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static long alloc_count = 0;
+
+void *malloc(size_t size){ alloc_count++; return __libc_malloc( size ); }
+void *calloc(size_t nmemb, size_t size){ alloc_count++; return __libc_calloc( nmemb, size ); }
+void *realloc(void *ptr, size_t size){ alloc_count++; return __libc_realloc( ptr, size ); }
+#else
+static long alloc_count = -1; /* not counted */
+#endif /* __GLIBC__ */
+
+void make_sample(zVec input, zVec des)
+{
+  int i;
+
+  for( i=0; i<zVecSizeNC(input); i++ ) zVecElemNC(input,i) = zRandF( -1, 1 );
+  for( i=0; i<zVecSizeNC(des); i++ ) zVecElemNC(des,i) = sin( zVecElemNC(input,i%zVecSizeNC(input)) );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzNetWorkspace ws;
+  nzDenseNet dn;
+  zVec input, des;
+  zMat input_batch, des_batch;
+  long count;
+  bool ok = true;
+  int i, j;
+
+  zRandInit();
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, 4, NULL );
+  nzNetAddGroupSetActivator( &net, 32, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, 32, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, 2, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  input = zVecAlloc( nzNetInputSize(&net) );
+  des = zVecAlloc( nzNetOutputSize(&net) );
+
+  /* online learning with nzNetBackPropagate() */
+  count = alloc_count;
+  for( i=0; i<N_STEP; i++ ){
+    make_sample( input, des );
+    nzNetInitGrad( &net );
+    nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+    nzNetTrainSDM( &net, RATE );
+  }
+  printf( "nzNetBackPropagate: %g allocations per step\n", (double)( alloc_count - count ) / N_STEP );
+
+  /* online learning with a workspace */
+  if( !nzNetWorkspaceAlloc( &ws, &net ) ) return EXIT_FAILURE;
+  count = alloc_count;
+  for( i=0; i<N_STEP; i++ ){
+    make_sample( input, des );
+    nzNetPropagate( &net, input );
+    nzNetInitGrad( &net );
+    nzNetBackPropagateWorkspace( &net, &ws, des, nzLossGradSquareSum );
+    nzNetTrainSDM( &net, RATE );
+  }
+  printf( "nzNetBackPropagateWorkspace: %g allocations per step\n", (double)( alloc_count - count ) / N_STEP );
+  if( alloc_count != count ) ok = false;
+  nzNetWorkspaceDestroy( &ws );
+
+  /* mini-batch learning of a compiled network */
+  if( !nzDenseNetCompile( &dn, &net ) ) return EXIT_FAILURE;
+  input_batch = zMatAlloc( N_BATCH, nzNetInputSize(&net) );
+  des_batch = zMatAlloc( N_BATCH, nzNetOutputSize(&net) );
+  nzDenseNetBackPropagateBatch( &dn, input_batch, des_batch, nzLossGradSquareSum ); /* warm-up */
+  count = alloc_count;
+  for( i=0; i<N_STEP; i++ ){
+    for( j=0; j<N_BATCH; j++ ){
+      make_sample( input, des );
+      memcpy( zMatRowBufNC(input_batch,j), zVecBufNC(input), sizeof(double)*zVecSizeNC(input) );
+      memcpy( zMatRowBufNC(des_batch,j), zVecBufNC(des), sizeof(double)*zVecSizeNC(des) );
+    }
+    nzDenseNetInitGrad( &dn );
+    nzDenseNetBackPropagateBatch( &dn, input_batch, des_batch, nzLossGradSquareSum );
+    nzDenseNetTrainSDM( &dn, RATE );
+  }
+  printf( "nzDenseNetBackPropagateBatch: %g allocations per step\n", (double)( alloc_count - count ) / N_STEP );
+  if( alloc_count != count ) ok = false;
+
+  zMatFreeAtOnce( 2, input_batch, des_batch );
+  zVecFreeAtOnce( 2, input, des );
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &net );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
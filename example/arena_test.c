@@ -0,0 +1,78 @@
+/* compare a fully connected layer allocated from the arena of a network
+ * with the same layer allocated from the heap.
+ * the heap path is reproduced by detaching neuron groups from the arena
+ * before neurons are added, as standalone neuron groups do. */
+#include <neuz/neuz.h>
+
+#define N_UNIT  1000
+#define N_PROP   100
+#define N_TRIAL    3
+
+/* build a network with a fully connected layer of N_UNIT x N_UNIT. */
+bool create_net(nzNet *net, bool use_arena)
+{
+  nzNeuronGroup *ng;
+  int i;
+
+  nzNetInit( net );
+  for( i=0; i<2; i++ ){
+    if( !nzNetAddGroup( net, use_arena ? N_UNIT : 0 ) ) return false;
+    if( use_arena ) continue;
+    ng = nzNetFindGroup( net, i );
+    ng->arena = NULL;
+    if( !nzNeuronGroupAdd( ng, N_UNIT ) ) return false;
+  }
+  nzNeuronGroupSetActivator( nzNetFindGroup( net, 0 ), NULL );
+  nzNeuronGroupSetActivator( nzNetFindGroup( net, 1 ), &nz_activator_sigmoid );
+  return nzNetConnectGroup( net, 0, 1 );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net[2];
+  nzDenseNet dn;
+  zVec input, output[2];
+  double t, t_build[2], t_prop[2], t_destroy[2];
+  const char *name[] = { "heap", "arena" };
+  bool ok = true;
+  int i, j, k;
+
+  zRandInit();
+  input = zVecAlloc( N_UNIT );
+  output[0] = zVecAlloc( N_UNIT );
+  output[1] = zVecAlloc( N_UNIT );
+  zVecRandUniform( input, -1, 1 );
+  for( i=0; i<2; i++ )
+    t_build[i] = t_prop[i] = t_destroy[i] = HUGE_VAL;
+  for( k=0; k<N_TRIAL; k++ ){
+    for( i=0; i<2; i++ ){
+      t = nzStatsClock();
+      if( !create_net( &net[i], i ) ) return EXIT_FAILURE;
+      t_build[i] = zMin( t_build[i], nzStatsClock() - t );
+    }
+    /* let both networks have the same weights */
+    if( !nzDenseNetCompile( &dn, &net[1] ) ) return EXIT_FAILURE;
+    nzDenseNetCopyToNet( &dn, &net[0] );
+    nzDenseNetDestroy( &dn );
+    for( i=0; i<2; i++ ){
+      nzNetPropagate( &net[i], input ); /* warm-up */
+      t = nzStatsClock();
+      for( j=0; j<N_PROP; j++ )
+        nzNetPropagate( &net[i], input );
+      t_prop[i] = zMin( t_prop[i], ( nzStatsClock() - t ) / N_PROP );
+      nzNetGetOutput( &net[i], output[i] );
+    }
+    if( zVecDist( output[0], output[1] ) > 0 ) ok = false;
+    for( i=0; i<2; i++ ){
+      t = nzStatsClock();
+      nzNetDestroy( &net[i] );
+      t_destroy[i] = zMin( t_destroy[i], nzStatsClock() - t );
+    }
+  }
+  printf( "%dx%d layer, best of %d trials [ms]\n", N_UNIT, N_UNIT, N_TRIAL );
+  for( i=0; i<2; i++ )
+    printf( "  %-5s: build %8.3f, propagate %8.3f, destroy %8.3f\n", name[i], t_build[i]*1e3, t_prop[i]*1e3, t_destroy[i]*1e3 );
+  printf( "outputs %s\n", ok ? "match" : "differ" );
+  zVecFreeAtOnce( 3, input, output[0], output[1] );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
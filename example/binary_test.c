@@ -0,0 +1,74 @@
+#include <neuz/neuz.h>
+
+#define ZTK_FILENAME "large.ztk"
+#define BIN_FILENAME "large.nzb"
+
+#define N_TEST 100
+
+/* maximum difference between outputs of two compiled networks for random inputs. */
+double output_dist(nzDenseNet *dn1, nzDenseNet *dn2)
+{
+  zVec input, output1, output2;
+  double e = 0;
+  int i, j;
+
+  input = zVecAlloc( nzDenseNetInputSize(dn1) );
+  output1 = zVecAlloc( nzDenseNetOutputSize(dn1) );
+  output2 = zVecAlloc( nzDenseNetOutputSize(dn2) );
+  for( i=0; i<N_TEST; i++ ){
+    for( j=0; j<zVecSizeNC(input); j++ ) zVecElemNC(input,j) = zRandF( -1, 1 );
+    nzDenseNetPropagate( dn1, input );
+    nzDenseNetGetOutput( dn1, output1 );
+    nzDenseNetPropagate( dn2, input );
+    nzDenseNetGetOutput( dn2, output2 );
+    e = zMax( e, zVecDist( output1, output2 ) );
+  }
+  zVecFreeAtOnce( 3, input, output1, output2 );
+  return e;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net, net_ztk;
+  nzDenseNet dn, dn_ztk, dn_read, dn_map;
+  int n;
+  double t0, t;
+
+  zRandInit();
+  n = argc > 1 ? atoi( argv[1] ) : 500;
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, n, NULL );
+  nzNetAddGroupSetActivator( &net, n, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, n, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &net, 10, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  if( !nzDenseNetCompile( &dn, &net ) ) return EXIT_FAILURE;
+  printf( "%d weights and biases\n", dn.nparam );
+  if( !nzNetWriteZTK( &net, ZTK_FILENAME ) ) return EXIT_FAILURE;
+  if( !nzDenseNetWriteBinary( &dn, BIN_FILENAME ) ) return EXIT_FAILURE;
+
+  t0 = nzStatsClock();
+  if( !nzNetReadZTK( &net_ztk, ZTK_FILENAME ) || !nzDenseNetCompile( &dn_ztk, &net_ztk ) ) return EXIT_FAILURE;
+  t = nzStatsClock() - t0;
+  printf( "ZTK:    %10.6f sec., max. error of outputs = %g\n", t, output_dist( &dn, &dn_ztk ) );
+  t0 = nzStatsClock();
+  if( !nzDenseNetReadBinary( &dn_read, BIN_FILENAME ) ) return EXIT_FAILURE;
+  t = nzStatsClock() - t0;
+  printf( "read:   %10.6f sec., max. error of outputs = %g\n", t, output_dist( &dn, &dn_read ) );
+  t0 = nzStatsClock();
+  if( !nzDenseNetMapBinary( &dn_map, BIN_FILENAME ) ) return EXIT_FAILURE;
+  t = nzStatsClock() - t0;
+  printf( "mmap:   %10.6f sec., max. error of outputs = %g\n", t, output_dist( &dn, &dn_map ) );
+
+  remove( ZTK_FILENAME );
+  remove( BIN_FILENAME );
+  nzDenseNetDestroy( &dn );
+  nzDenseNetDestroy( &dn_ztk );
+  nzDenseNetDestroy( &dn_read );
+  nzDenseNetDestroy( &dn_map );
+  nzNetDestroy( &net );
+  nzNetDestroy( &net_ztk );
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include <neuz/neuz.h>
+
+#define N0  16
+#define N1 128
+#define N2 128
+#define N3   4
+
+#define N_SAMPLE 20000
+#define N_GRAD     200
+#define N_THREAD     4
+
+/* samples shared by workers, each of which has its own context of the same network */
+typedef struct{
+  nzThreadPool *pool;
+  nzNetContext *ctx;
+  zMat input;
+  zMat des;
+  zMat output;
+  int n;
+} task_t;
+
+/* propagate a chunk of samples in the context of a worker. */
+void propagate_task(void *arg, int id)
+{
+  task_t *task;
+  zVec input, output;
+  int i, i1;
+
+  task = (task_t *)arg;
+  input = zVecAlloc( N0 );
+  output = zVecAlloc( N3 );
+  i  = nzThreadPartition( task->n, id,   task->pool->size );
+  i1 = nzThreadPartition( task->n, id+1, task->pool->size );
+  for( ; i<i1; i++ ){
+    zMatGetRow( task->input, i, input );
+    nzNetContextPropagate( &task->ctx[id], input );
+    nzNetContextGetOutput( &task->ctx[id], output );
+    zMatPutRow( task->output, i, output );
+  }
+  zVecFreeAtOnce( 2, input, output );
+}
+
+/* back-propagate a chunk of samples in the context of a worker. */
+void backpropagate_task(void *arg, int id)
+{
+  task_t *task;
+  zVec input, des;
+  int i, i1;
+
+  task = (task_t *)arg;
+  input = zVecAlloc( N0 );
+  des = zVecAlloc( N3 );
+  i  = nzThreadPartition( task->n, id,   task->pool->size );
+  i1 = nzThreadPartition( task->n, id+1, task->pool->size );
+  nzNetContextInitGrad( &task->ctx[id] );
+  for( ; i<i1; i++ ){
+    zMatGetRow( task->input, i, input );
+    zMatGetRow( task->des, i, des );
+    nzNetContextPropagate( &task->ctx[id], input );
+    nzNetContextBackPropagate( &task->ctx[id], des, nzLossGradSquareSum );
+  }
+  zVecFreeAtOnce( 2, input, des );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzThreadPool pool;
+  task_t task;
+  zVec input, des, output, grad, grad_ref;
+  zMat output_ref;
+  double t0, t_serial, t_context, err;
+  int i, j, nthread;
+  bool ok = true;
+
+  zRandInit();
+  nthread = argc > 1 ? atoi( argv[1] ) : N_THREAD;
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, N0, NULL );
+  nzNetAddGroupSetActivator( &net, N1, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, N2, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &net, N3, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  if( !nzThreadPoolCreate( &pool, nthread ) ) return EXIT_FAILURE;
+  task.pool = &pool;
+  task.n = N_SAMPLE;
+  task.input = zMatAlloc( N_SAMPLE, N0 );
+  task.des = zMatAlloc( N_SAMPLE, N3 );
+  task.output = zMatAlloc( N_SAMPLE, N3 );
+  output_ref = zMatAlloc( N_SAMPLE, N3 );
+  task.ctx = zAlloc( nzNetContext, pool.size );
+  grad = zVecAlloc( nzNetNumParam(&net) );
+  grad_ref = zVecAlloc( nzNetNumParam(&net) );
+  input = zVecAlloc( N0 );
+  des = zVecAlloc( N3 );
+  output = zVecAlloc( N3 );
+  for( i=0; i<N_SAMPLE; i++ ){
+    for( j=0; j<N0; j++ ) zMatElemNC(task.input,i,j) = zRandF(-1,1);
+    for( j=0; j<N3; j++ ) zMatElemNC(task.des,i,j) = zRandF(-1,1);
+  }
+  for( i=0; i<pool.size; i++ )
+    if( !nzNetContextAlloc( &task.ctx[i], &net ) ) return EXIT_FAILURE;
+
+  /* inference on the shared network */
+  t0 = nzStatsClock();
+  for( i=0; i<N_SAMPLE; i++ ){
+    zMatGetRow( task.input, i, input );
+    nzNetPropagate( &net, input );
+    nzNetGetOutput( &net, output );
+    zMatPutRow( output_ref, i, output );
+  }
+  t_serial = nzStatsClock() - t0;
+  t0 = nzStatsClock();
+  nzThreadPoolRun( &pool, propagate_task, &task );
+  t_context = nzStatsClock() - t0;
+  for( err=0, i=0; i<N_SAMPLE*N3; i++ )
+    err = zMax( err, fabs( zMatBufNC(task.output)[i] - zMatBufNC(output_ref)[i] ) );
+  printf( "propagation of %d samples: network %.3f sec, %d contexts %.3f sec (x%.2f), difference = %g\n",
+    N_SAMPLE, t_serial, pool.size, t_context, t_serial / t_context, err );
+  if( err != 0 ) ok = false;
+
+  /* back-propagation with contexts, gradients of which are added in the order of workers */
+  nzNetInitGrad( &net );
+  for( i=0; i<N_GRAD; i++ ){
+    zMatGetRow( task.input, i, input );
+    zMatGetRow( task.des, i, des );
+    nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  }
+  nzNetGetGrad( &net, grad_ref );
+  nzNetInitGrad( &net );
+  task.n = N_GRAD;
+  nzThreadPoolRun( &pool, backpropagate_task, &task );
+  for( i=0; i<pool.size; i++ )
+    nzNetContextAddGradToNet( &task.ctx[i] );
+  nzNetGetGrad( &net, grad );
+  err = zVecDist( grad, grad_ref ) / zVecNorm( grad_ref );
+  printf( "relative difference of gradients = %g\n", err );
+  if( err > ( pool.size == 1 ? 0 : 1.0e-12 ) ) ok = false;
+
+  for( i=0; i<pool.size; i++ )
+    nzNetContextDestroy( &task.ctx[i] );
+  zFree( task.ctx );
+  zVecFreeAtOnce( 2, grad, grad_ref );
+  zMatFreeAtOnce( 4, task.input, task.des, task.output, output_ref );
+  zVecFreeAtOnce( 3, input, des, output );
+  nzThreadPoolDestroy( &pool );
+  nzNetDestroy( &net );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
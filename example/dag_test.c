@@ -0,0 +1,141 @@
+#include <neuz/neuz.h>
+
+#define N_INPUT    8
+#define N_BRANCH 256
+#define N_OUTPUT   4
+
+#define N_STEP   200
+#define N_THREAD   4
+#define DW      1.0e-6 /* perturbation of a weight for finite differences */
+
+/* a network of two parallel branches with a skip connection from the input to the output.
+ * the second branch is added before the first one, which depends on it, so that groups
+ * are not in a topological order. */
+bool create_net(nzNet *net)
+{
+  int i, j;
+
+  nzNetInit( net );
+  nzNetAddGroupSetActivator( net, N_INPUT, NULL );                  /* 0: input */
+  nzNetAddGroupSetActivator( net, N_BRANCH, &nz_activator_sigmoid ); /* 1: second layer of branch A */
+  nzNetAddGroupSetActivator( net, N_BRANCH, &nz_activator_relu );    /* 2: first layer of branch A */
+  nzNetAddGroupSetActivator( net, N_BRANCH, &nz_activator_sigmoid ); /* 3: branch B */
+  nzNetAddGroupSetActivator( net, N_OUTPUT, &nz_activator_ident );   /* 4: output */
+  nzNetConnectGroup( net, 0, 2 );
+  nzNetConnectGroup( net, 2, 1 );
+  nzNetConnectGroup( net, 0, 3 );
+  nzNetConnectGroup( net, 1, 4 );
+  nzNetConnectGroup( net, 3, 4 );
+  for( i=0; i<N_OUTPUT; i++ ) /* skip connections */
+    for( j=0; j<N_INPUT; j++ )
+      if( !nzNetConnect( net, 0, j, 4, i, zRandF(-1,1) ) ) return false;
+  return true;
+}
+
+/* output of a neuron evaluated recursively from the definition. */
+double eval(nzNeuron *np, zVec input)
+{
+  nzAxon *ap;
+  double x;
+
+  if( !np->data.activator ) return zVecElemNC(input,np->data.nid);
+  x = np->data.bias;
+  for( ap=np->data.axon; ap; ap=ap->next )
+    x += ap->weight * eval( (nzNeuron *)ap->upstream, input );
+  return np->data.activator->f( x );
+}
+
+/* loss of a network for an input and a desired output. */
+double loss(nzNet *net, zVec input, zVec des, zVec output)
+{
+  nzNetPropagate( net, input );
+  nzNetGetOutput( net, output );
+  return nzLossSquareSum( output, des );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzThreadPool pool;
+  nzNeuron *np;
+  nzAxon *ap;
+  zVec input, des, output, output_serial;
+  double err, dw, w, l1, l2, t0, t_serial, t_parallel;
+  int i, nthread;
+  bool cyclic, ok = true;
+
+  zRandInit();
+  nthread = argc > 1 ? atoi( argv[1] ) : N_THREAD;
+  if( !create_net( &net ) ) return EXIT_FAILURE;
+  input = zVecAlloc( N_INPUT );
+  des = zVecAlloc( N_OUTPUT );
+  output = zVecAlloc( N_OUTPUT );
+  output_serial = zVecAlloc( N_OUTPUT );
+  zVecRandUniform( input, -1, 1 );
+  zVecRandUniform( des, -1, 1 );
+
+  /* propagation in the topological order */
+  if( !nzNetPropagate( &net, input ) ) return EXIT_FAILURE;
+  nzNetGetOutput( &net, output );
+  printf( "%d groups sorted into %d levels (grouped: %s)\n",
+    zListSize(&net), net.schedule.nlevel, net.schedule.grouped ? "yes" : "no" );
+  err = 0;
+  zListForEach( &nzNetOutputLayer(&net)->list, np )
+    err = zMax( err, fabs( eval( np, input ) - zVecElemNC(output,np->data.nid) ) );
+  printf( "max. difference of outputs from recursive evaluation = %g\n", err );
+  if( err > 0 ) ok = false;
+
+  /* gradients of weights of the skip connections and of branch A compared with finite differences */
+  nzNetInitGrad( &net );
+  nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  err = 0;
+  for( i=0; i<2; i++ ){
+    np = i == 0 ? nzNetFindNeuron( &net, 4, 0 ) : nzNetFindNeuron( &net, 2, 0 );
+    for( ap=np->data.axon; ap; ap=ap->next ){
+      w = ap->weight;
+      ap->weight = w + DW;
+      l1 = loss( &net, input, des, output );
+      ap->weight = w - DW;
+      l2 = loss( &net, input, des, output );
+      ap->weight = w;
+      dw = ( l1 - l2 ) / ( 2 * DW );
+      err = zMax( err, fabs( dw - ap->_dw ) );
+    }
+  }
+  printf( "max. difference of gradients from finite differences = %g\n", err );
+  if( err > 1.0e-6 ) ok = false;
+
+  /* wavefront parallelism, where both branches are processed at once */
+  if( !nzThreadPoolCreate( &pool, nthread ) ) return EXIT_FAILURE;
+  t0 = nzStatsClock();
+  for( i=0; i<N_STEP; i++ ){
+    nzNetPropagate( &net, input );
+    nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  }
+  t_serial = nzStatsClock() - t0;
+  nzNetGetOutput( &net, output_serial );
+  nzNetSetThreadPool( &net, &pool );
+  t0 = nzStatsClock();
+  for( i=0; i<N_STEP; i++ ){
+    nzNetPropagate( &net, input );
+    nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  }
+  t_parallel = nzStatsClock() - t0;
+  nzNetGetOutput( &net, output );
+  err = zVecDist( output, output_serial );
+  printf( "%d steps: serial %.3f sec, %d threads %.3f sec (x%.2f), difference of outputs = %g\n",
+    N_STEP, t_serial, pool.size, t_parallel, t_serial / t_parallel, err );
+  if( err > 0 ) ok = false;
+  nzNetSetThreadPool( &net, NULL );
+
+  /* a cycle is rejected */
+  nzNetConnect( &net, 4, 0, 2, 0, 1.0 );
+  cyclic = !nzNetPropagate( &net, input );
+  printf( "cyclic network rejected: %s\n", cyclic ? "yes" : "no" );
+  if( !cyclic ) ok = false;
+
+  zVecFreeAtOnce( 4, input, des, output, output_serial );
+  nzThreadPoolDestroy( &pool );
+  nzNetDestroy( &net );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+#include <neuz/neuz.h>
+
+#define SIN_CSV     "dataset_test.csv"
+#define SIN_DATASET "dataset_test.dat"
+#define BIG_DATASET "dataset_test_big.dat"
+
+#define N_SAMPLE   1000
+#define N_EPOCH     200
+#define N_BATCH      10
+#define RATE       0.05
+
+#define N_BIG_SAMPLE 500000
+#define N_BIG_INPUT      31
+#define N_BIG_BATCH     256
+
+/* write samples of sine and cosine functions to a CSV file. */
+bool write_csv(const char filename[])
+{
+  FILE *fp;
+  double theta;
+  int i;
+
+  if( !( fp = fopen( filename, "w" ) ) ) return false;
+  fprintf( fp, "theta,sin,cos\n" );
+  for( i=0; i<N_SAMPLE; i++ ){
+    theta = zRandF( -zPI, zPI );
+    fprintf( fp, "%.17g,%.17g,%.17g\n", theta, 0.25*(sin(theta)+1), 0.25*(cos(theta)+1) );
+  }
+  fclose( fp );
+  return true;
+}
+
+/* train a network with mini-batches of a dataset. */
+bool train(nzDataset *ds)
+{
+  nzNet nn;
+  nzDenseNet dn;
+  nzDenseLayer *layer;
+  zMat input, des;
+  double l;
+  int i, j, n, count;
+
+  nzNetInit( &nn );
+  nzNetAddGroupSetActivator( &nn, nzDatasetInputSize(ds), NULL );
+  nzNetAddGroupSetActivator( &nn, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &nn, nzDatasetOutputSize(ds), &nz_activator_sigmoid );
+  nzNetConnectGroup( &nn, 0, 1 );
+  nzNetConnectGroup( &nn, 1, 2 );
+  if( !nzDenseNetCompile( &dn, &nn ) ) return false;
+  input = zMatAlloc( N_BATCH, nzDatasetInputSize(ds) );
+  des = zMatAlloc( N_BATCH, nzDatasetOutputSize(ds) );
+  layer = nzDenseNetOutputLayer(&dn);
+  for( i=0; i<N_EPOCH; i++ ){
+    nzDatasetRewind( ds );
+    for( l=0, count=0; ( n = nzDatasetNextBatch( ds, input, des ) ) == N_BATCH; count+=n ){
+      nzDenseNetInitGrad( &dn );
+      nzDenseNetBackPropagateBatch( &dn, input, des, nzLossGradSquareSum );
+      for( j=0; j<N_BATCH*nzDatasetOutputSize(ds); j++ )
+        l += 0.5 * zSqr( layer->batch_output[j] - zMatBufNC(des)[j] );
+      nzDenseNetTrainSDM( &dn, RATE );
+    }
+    if( i % 20 == 0 || i == N_EPOCH-1 )
+      printf( "epoch %03d: %d samples, mean loss %.10g\n", i, count, l / count );
+  }
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &nn );
+  zMatFreeAtOnce( 2, input, des );
+  return true;
+}
+
+/* write a large dataset, the first input of each sample of which is its index. */
+bool write_big(const char filename[])
+{
+  nzDatasetWriter writer;
+  double input[N_BIG_INPUT], des[1];
+  int i, j;
+
+  if( !nzDatasetWriterOpen( &writer, filename, N_BIG_INPUT, 1, sizeof(float) ) ) return false;
+  for( i=0; i<N_BIG_SAMPLE; i++ ){
+    input[0] = i;
+    for( j=1; j<N_BIG_INPUT; j++ ) input[j] = zRandF( -1, 1 );
+    des[0] = i % 2;
+    nzDatasetWriterAdd( &writer, input, des );
+  }
+  return nzDatasetWriterClose( &writer );
+}
+
+/* read an epoch of a large dataset, and check if every sample is visited once. */
+bool read_big(nzDataset *ds, const char *name)
+{
+  zMat input, des;
+  char *visited;
+  double t0, t;
+  size_t count = 0;
+  int i, n;
+  bool ok = true;
+
+  input = zMatAlloc( N_BIG_BATCH, nzDatasetInputSize(ds) );
+  des = zMatAlloc( N_BIG_BATCH, nzDatasetOutputSize(ds) );
+  visited = zAlloc( char, nzDatasetSize(ds) );
+  nzDatasetRewind( ds );
+  t0 = nzStatsClock();
+  while( ( n = nzDatasetNextBatch( ds, input, des ) ) > 0 )
+    for( i=0; i<n; i++, count++ ){
+      if( visited[(int)zMatElemNC(input,i,0)]++ ) ok = false;
+      if( zMatElemNC(des,i,0) != (int)zMatElemNC(input,i,0) % 2 ) ok = false;
+    }
+  t = nzStatsClock() - t0;
+  if( count != nzDatasetSize(ds) ) ok = false;
+  printf( "%-14s: %lu samples in %.3f sec, %.3f GB/s of file, %s\n", name, (unsigned long)count, t,
+    1.0e-9 * count * ds->rowsize / t, ok ? "every sample visited once" : "wrong order" );
+  zFree( visited );
+  zMatFreeAtOnce( 2, input, des );
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  nzDataset ds;
+  bool ok = true;
+
+  zRandInit();
+  /* CSV file to a dataset */
+  if( !write_csv( SIN_CSV ) ) return EXIT_FAILURE;
+  printf( "%ld samples converted\n", nzDatasetConvertText( SIN_CSV, SIN_DATASET, 1, 2, sizeof(double) ) );
+  if( !nzDatasetOpen( &ds, SIN_DATASET ) ) return EXIT_FAILURE;
+  ok = train( &ds );
+  nzDatasetClose( &ds );
+
+  /* streaming a large dataset */
+  if( !write_big( BIG_DATASET ) || !nzDatasetOpen( &ds, BIG_DATASET ) ) return EXIT_FAILURE;
+  nzDatasetSetShuffle( &ds, false, 0, 0 );
+  if( !read_big( &ds, "sequential" ) ) ok = false;
+  nzDatasetSetShuffle( &ds, true, 0, 0 );
+  if( !read_big( &ds, "shuffled" ) ) ok = false;
+  nzDatasetSetShuffle( &ds, true, 1, 65536 );
+  if( !read_big( &ds, "fully shuffled" ) ) ok = false;
+  nzDatasetClose( &ds );
+
+  remove( SIN_CSV );
+  remove( SIN_DATASET );
+  remove( BIG_DATASET );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
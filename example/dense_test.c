@@ -0,0 +1,81 @@
+#include <neuz/neuz.h>
+
+#define N0  16
+#define N1 512
+#define N2 512
+#define N3   4
+
+#define N_TEST 1000
+
+/* tolerance of squared errors, which arise from the order of summation */
+#define TOL_DOUBLE 1.0e-20
+#define TOL_FLOAT  1.0e-6
+
+int main(int argc, char *argv[])
+{
+  nzNet nn;
+  nzDenseNet dn;
+  zVec input, output, output_dense;
+  zMat input_batch, output_batch;
+  double err = 0, tol;
+  double t0, t1, t2;
+  bool ok = true;
+  int i;
+
+  zRandInit();
+  nzNetInit( &nn );
+  nzNetAddGroupSetActivator( &nn, N0, NULL );
+  nzNetAddGroupSetActivator( &nn, N1, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &nn, N2, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &nn, N3, &nz_activator_ident );
+  nzNetConnectGroup( &nn, 0, 1 );
+  nzNetConnectGroup( &nn, 1, 2 );
+  nzNetConnectGroup( &nn, 2, 3 );
+  if( !nzDenseNetCompile( &dn, &nn ) ) return EXIT_FAILURE;
+  input  = zVecAlloc( nzNetInputSize(&nn) );
+  output = zVecAlloc( nzNetOutputSize(&nn) );
+  output_dense = zVecAlloc( nzDenseNetOutputSize(&dn) );
+
+  input_batch  = zMatAlloc( N_TEST, nzNetInputSize(&nn) );
+  output_batch = zMatAlloc( N_TEST, nzNetOutputSize(&nn) );
+  for( i=0; i<N_TEST*nzNetInputSize(&nn); i++ )
+    zMatBufNC(input_batch)[i] = zRandF( -1, 1 );
+
+  tol = sizeof(nzReal) == sizeof(float) ? TOL_FLOAT : TOL_DOUBLE;
+  t1 = t2 = 0;
+  for( i=0; i<N_TEST; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(input_batch,i), sizeof(double)*zVecSizeNC(input) );
+    t0 = nzStatsClock();
+    nzNetPropagate( &nn, input );
+    t1 += nzStatsClock() - t0;
+    t0 = nzStatsClock();
+    nzDenseNetPropagate( &dn, input );
+    t2 += nzStatsClock() - t0;
+    nzNetGetOutput( &nn, output );
+    nzDenseNetGetOutput( &dn, output_dense );
+    err = zMax( err, zVecSqrDist( output, output_dense ) );
+  }
+  printf( "max. squared error = %g\n", err );
+  printf( "linked network: %g sec., dense network: %g sec.\n", t1, t2 );
+  if( err > tol ) ok = false;
+
+  t0 = nzStatsClock();
+  nzDenseNetPropagateBatch( &dn, input_batch, output_batch );
+  t1 = nzStatsClock() - t0;
+  for( err=0, i=0; i<N_TEST; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(input_batch,i), sizeof(double)*zVecSizeNC(input) );
+    nzDenseNetPropagate( &dn, input );
+    nzDenseNetGetOutput( &dn, output_dense );
+    memcpy( zVecBufNC(output), zMatRowBufNC(output_batch,i), sizeof(double)*zVecSizeNC(output) );
+    err = zMax( err, zVecSqrDist( output, output_dense ) );
+  }
+  printf( "max. squared error of batch = %g\n", err );
+  printf( "dense network for a batch: %g sec.\n", t1 );
+  if( err > tol ) ok = false;
+
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &nn );
+  zVecFreeAtOnce( 3, input, output, output_dense );
+  zMatFreeAtOnce( 2, input_batch, output_batch );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <iostream>
+#include <neuz/neuz.h>
+#include <neuz/neuz_fixed.h>
+
+#define N0 2
+#define N1 5
+#define N2 4
+
+#define N_TRAIN  2000
+#define RATE     0.1
+#define N_REPEAT 1000000
+
+#define FIXED_ZTK "fixed_cpp_test.ztk"
+
+typedef nzFixedNet<double, N0, nzFixedLayer<N1,nzFixedSigmoid>, nzFixedLayer<N2,nzFixedSigmoid>> xor_net;
+typedef nzFixedNet<float, N0, nzFixedLayer<N1,nzFixedSigmoid>, nzFixedLayer<N2,nzFixedSigmoid>> xor_net_float;
+
+const double table[][6] = {
+  { 0, 0, 0, 0, 1, 0 }, { 1, 0, 1, 0, 1, 1 }, { 0, 1, 1, 0, 1, 1 }, { 1, 1, 1, 1, 0, 0 } };
+
+void train(nzNet &net)
+{
+  zVec input, des;
+  int i, j;
+
+  input = zVecAlloc( N0 );
+  des = zVecAlloc( N2 );
+  for( i=0; i<N_TRAIN; i++ ){
+    net.initGrad();
+    for( j=0; j<4; j++ ){
+      zVecSetElemList( input, table[j][0], table[j][1] );
+      zVecSetElemList( des, table[j][2], table[j][3], table[j][4], table[j][5] );
+      net.backpropagate( input, des, nzLossGradSquareSum );
+    }
+    net.trainSDM( RATE );
+  }
+  zVecFreeAtOnce( 2, input, des );
+}
+
+template<typename Func> double measure(Func func)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  for( int i=0; i<N_REPEAT; i++ ) func( i );
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count() / N_REPEAT;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet nn;
+  xor_net fixed, fixed_read;
+  xor_net_float fixed_float;
+  zVec input, output, output_fixed;
+  double t_net, t_fixed, t_float, d, dmax = 0, sink = 0;
+  int i;
+  bool ok = true;
+
+  zRandInit();
+  nn.init();
+  nn.addGroup( N0, NULL );
+  nn.addGroup( N1, &nz_activator_sigmoid );
+  nn.addGroup( N2, &nz_activator_sigmoid );
+  nn.connectGroup( 0, 1 );
+  nn.connectGroup( 1, 2 );
+  train( nn );
+  if( !fixed.fromNet( &nn ) || !fixed_float.fromNet( &nn ) ) return EXIT_FAILURE;
+
+  input  = zVecAlloc( N0 );
+  output = zVecAlloc( N2 );
+  output_fixed = zVecAlloc( N2 );
+  for( i=0; i<4; i++ ){
+    zVecSetElemList( input, table[i][0], table[i][1] );
+    nn.propagate( input );
+    nn.getOutput( output );
+    fixed.propagate( input, output_fixed );
+    printf( "I1=%g, I2=%g -> OR: %g, AND: %g, NAND: %g, XOR: %g\n", table[i][0], table[i][1], zVecElemNC(output_fixed,0), zVecElemNC(output_fixed,1), zVecElemNC(output_fixed,2), zVecElemNC(output_fixed,3) );
+    for( int j=0; j<N2; j++ )
+      if( ( d = fabs( zVecElemNC(output,j) - zVecElemNC(output_fixed,j) ) ) > dmax ) dmax = d;
+  }
+  std::cout << "max. difference from nzNet = " << dmax << std::endl;
+  if( dmax > 1.0e-12 ) ok = false;
+
+  t_net = measure( [&](int i){ zVecSetElemList( input, (double)( i & 1 ), (double)( ( i >> 1 ) & 1 ) ); sink += nn.propagate( input ); } );
+  t_fixed = measure( [&](int i){ xor_net::input_type in = { (double)( i & 1 ), (double)( ( i >> 1 ) & 1 ) }; sink += fixed.propagate( in )[3]; } );
+  t_float = measure( [&](int i){ xor_net_float::input_type in = { (float)( i & 1 ), (float)( ( i >> 1 ) & 1 ) }; sink += fixed_float.propagate( in )[3]; } );
+  std::cout << "propagation: nzNet " << 1.0e9*t_net << " nsec, nzFixedNet<double> " << 1.0e9*t_fixed << " nsec, nzFixedNet<float> " << 1.0e9*t_float << " nsec (sink=" << sink << ")" << std::endl;
+
+  /* round trip through a ZTK file */
+  fixed.writeZTK( FIXED_ZTK );
+  if( !fixed_read.readZTK( FIXED_ZTK ) ) ok = false;
+  for( dmax=0, i=0; i<4; i++ ){
+    xor_net::input_type in = { table[i][0], table[i][1] };
+    auto out = fixed.propagate( in );
+    auto out_read = fixed_read.propagate( in );
+    for( int j=0; j<N2; j++ )
+      if( ( d = fabs( out[j] - out_read[j] ) ) > dmax ) dmax = d;
+  }
+  std::cout << "max. difference after ZTK round trip = " << dmax << std::endl;
+  if( dmax > 1.0e-6 ) ok = false;
+  remove( FIXED_ZTK );
+
+  nn.destroy();
+  zVecFreeAtOnce( 3, input, output, output_fixed );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+#include <neuz/neuz.h>
+
+#define N_INPUT    64
+#define N_HIDDEN  512
+#define N_OUTPUT   16
+#define N_SAMPLE 1000
+
+/* tolerance of outputs in single precision, rounded from the linked network */
+#define TOL_FLOAT 1.0e-4
+
+/* memory held by a neural network in bytes */
+size_t net_memsize(nzNet *net)
+{
+  nzArenaBlock *block;
+  nzNetCell *nc;
+  size_t size;
+
+  size = sizeof(nzNet) + sizeof(nzNeuronGroup *) * net->capacity;
+  for( block=net->arena.block; block; block=block->next ) size += block->size;
+  zListForEach( net, nc ) size += sizeof(nzNeuron *) * nc->data.capacity;
+  return size;
+}
+
+/* each worker propagates a part of samples through the shared frozen network. */
+typedef struct{
+  nzFrozenNet *fn;
+  zMat input;
+  zMat output;
+} task_t;
+
+void propagate_task(void *arg, int id)
+{
+  task_t *task = (task_t *)arg;
+  nzReal *work;
+  zVec input, output;
+  int i;
+
+  work = zAlloc( nzReal, nzFrozenNetWorkSize(task->fn) );
+  input = zVecAlloc( zMatColSizeNC(task->input) );
+  output = zVecAlloc( zMatColSizeNC(task->output) );
+  for( i=id; i<zMatRowSizeNC(task->input); i+=2 ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(task->input,i), sizeof(double)*zVecSizeNC(input) );
+    nzFrozenNetPropagate( task->fn, input, output, work );
+    memcpy( zMatRowBufNC(task->output,i), zVecBufNC(output), sizeof(double)*zVecSizeNC(output) );
+  }
+  zVecFreeAtOnce( 2, input, output );
+  free( work );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzFrozenNet fn;
+  nzThreadPool pool;
+  task_t task;
+  zVec input, output;
+  double err = 0, tol;
+  int i, j;
+
+  zRandInit();
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, N_INPUT, NULL );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &net, N_OUTPUT, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  nzNetConnect( &net, 0, 0, 3, 0, 0.5 ); /* skip connection */
+  if( !nzFrozenNetFreeze( &fn, &net ) ) return EXIT_FAILURE;
+
+  printf( "connections: %d\n", fn.nconn );
+  printf( "nzNet:       %10lu bytes (%.1f bytes per connection)\n", (unsigned long)net_memsize( &net ), (double)net_memsize( &net ) / fn.nconn );
+  printf( "nzFrozenNet: %10lu bytes (%.1f bytes per connection)\n", (unsigned long)nzFrozenNetMemSize( &fn ), (double)nzFrozenNetMemSize( &fn ) / fn.nconn );
+
+  /* outputs of two threads sharing the frozen network */
+  task.fn = &fn;
+  task.input = zMatAlloc( N_SAMPLE, N_INPUT );
+  task.output = zMatAlloc( N_SAMPLE, N_OUTPUT );
+  for( i=0; i<N_SAMPLE*N_INPUT; i++ ) zMatBufNC(task.input)[i] = zRandF( -1, 1 );
+  nzThreadPoolCreate( &pool, 2 );
+  nzThreadPoolRun( &pool, propagate_task, &task );
+  nzThreadPoolDestroy( &pool );
+
+  input = zVecAlloc( N_INPUT );
+  output = zVecAlloc( N_OUTPUT );
+  for( i=0; i<N_SAMPLE; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(task.input,i), sizeof(double)*N_INPUT );
+    nzNetPropagate( &net, input );
+    nzNetGetOutput( &net, output );
+    for( j=0; j<N_OUTPUT; j++ )
+      err = zMax( err, fabs( zVecElemNC(output,j) - zMatElemNC(task.output,i,j) ) );
+  }
+  printf( "maximum difference of outputs: %g\n", err );
+  /* a frozen network computes the same in double precision */
+  tol = sizeof(nzReal) == sizeof(float) ? TOL_FLOAT : 0;
+
+  zVecFreeAtOnce( 2, input, output );
+  zMatFreeAtOnce( 2, task.input, task.output );
+  nzFrozenNetDestroy( &fn );
+  nzNetDestroy( &net );
+  return err <= tol ? EXIT_SUCCESS : EXIT_FAILURE;
+}
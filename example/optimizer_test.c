@@ -0,0 +1,172 @@
+#include <neuz/neuz.h>
+
+#define N_SAMPLE   20
+#define N_EPOCH 100000
+#define TARGET  1.0e-3
+
+/* training problem */
+typedef struct{
+  const char *name;
+  int n;       /* number of samples */
+  zMat input;
+  zMat des;
+  double rate[NZ_OPTIMIZER_ADAM+1];
+} problem_t;
+
+const char *optimizer_name[] = { "SDM", "momentum", "Nesterov", "RMSProp", "Adam" };
+
+/* learning rates of optimizers tuned for each problem. momentum and Nesterov's
+ * method need a smaller rate than SDM, since they accumulate gradients. */
+void problem_set_rate(problem_t *p, double sdm, double momentum, double nesterov, double rmsprop, double adam)
+{
+  p->rate[NZ_OPTIMIZER_SDM] = sdm;
+  p->rate[NZ_OPTIMIZER_MOMENTUM] = momentum;
+  p->rate[NZ_OPTIMIZER_NESTEROV] = nesterov;
+  p->rate[NZ_OPTIMIZER_RMSPROP] = rmsprop;
+  p->rate[NZ_OPTIMIZER_ADAM] = adam;
+}
+
+void problem_xor(problem_t *p, nzNet *net)
+{
+  double table[][6] = {
+    { 0, 0, 0, 0, 1, 0 }, { 1, 0, 1, 0, 1, 1 }, { 0, 1, 1, 0, 1, 1 }, { 1, 1, 1, 1, 0, 0 } };
+  int i;
+
+  p->name = "xor";
+  p->n = 4;
+  problem_set_rate( p, 0.5, 0.02, 0.02, 0.01, 0.02 );
+  p->input = zMatAlloc( p->n, 2 );
+  p->des = zMatAlloc( p->n, 4 );
+  for( i=0; i<p->n; i++ ){
+    memcpy( zMatRowBufNC(p->input,i), table[i], sizeof(double)*2 );
+    memcpy( zMatRowBufNC(p->des,i), table[i]+2, sizeof(double)*4 );
+  }
+  nzNetInit( net );
+  nzNetAddGroupSetActivator( net, 2, NULL );
+  nzNetAddGroupSetActivator( net, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, 4, &nz_activator_sigmoid );
+  nzNetConnectGroup( net, 0, 1 );
+  nzNetConnectGroup( net, 1, 2 );
+}
+
+void problem_sin(problem_t *p, nzNet *net)
+{
+  double theta;
+  int i;
+
+  p->name = "sin";
+  p->n = N_SAMPLE;
+  problem_set_rate( p, 0.05, 0.005, 0.005, 0.005, 0.02 );
+  p->input = zMatAlloc( p->n, 1 );
+  p->des = zMatAlloc( p->n, 2 );
+  for( i=0; i<p->n; i++ ){
+    theta = zPI * ( 2.0 * i / ( p->n - 1 ) - 1 );
+    zMatElemNC(p->input,i,0) = theta;
+    zMatElemNC(p->des,i,0) = 0.25 * ( sin(theta) + 1 );
+    zMatElemNC(p->des,i,1) = 0.25 * ( cos(theta) + 1 );
+  }
+  nzNetInit( net );
+  nzNetAddGroupSetActivator( net, 1, NULL );
+  nzNetAddGroupSetActivator( net, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, 2, &nz_activator_sigmoid );
+  nzNetConnectGroup( net, 0, 1 );
+  nzNetConnectGroup( net, 1, 2 );
+}
+
+void problem_autoencoder(problem_t *p, nzNet *net)
+{
+  double theta;
+  int i;
+
+  p->name = "autoencoder";
+  p->n = N_SAMPLE;
+  problem_set_rate( p, 0.02, 0.005, 0.005, 0.01, 0.02 );
+  p->input = zMatAlloc( p->n, 2 );
+  p->des = zMatAlloc( p->n, 2 );
+  for( i=0; i<p->n; i++ ){
+    theta = zPI * ( 2.0 * i / p->n - 1 );
+    zMatElemNC(p->input,i,0) = zMatElemNC(p->des,i,0) = 0.25 * ( sin(theta) + 1 );
+    zMatElemNC(p->input,i,1) = zMatElemNC(p->des,i,1) = 0.25 * ( cos(theta) + 1 );
+  }
+  nzNetInit( net );
+  nzNetAddGroupSetActivator( net, 2, NULL );
+  nzNetAddGroupSetActivator( net, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, 3, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, 2, &nz_activator_sigmoid );
+  nzNetConnectGroup( net, 0, 1 );
+  nzNetConnectGroup( net, 1, 2 );
+  nzNetConnectGroup( net, 2, 3 );
+  nzNetConnectGroup( net, 3, 4 );
+}
+
+/* train a network until the mean loss reaches the target, and return the number of epochs. */
+int train(nzNet *net, problem_t *p, int type)
+{
+  nzOptimizer opt;
+  nzNetWorkspace ws;
+  zVec input, des;
+  double l;
+  int i, j;
+
+  if( !nzOptimizerCreateNet( &opt, type, net, p->rate[type] ) ) return -1;
+  if( !nzNetWorkspaceAlloc( &ws, net ) ) return -1;
+  input = zVecAlloc( nzNetInputSize(net) );
+  des = zVecAlloc( nzNetOutputSize(net) );
+  for( i=0; i<N_EPOCH; i++ ){
+    nzNetInitGrad( net );
+    for( l=0, j=0; j<p->n; j++ ){
+      memcpy( zVecBufNC(input), zMatRowBufNC(p->input,j), sizeof(double)*zVecSizeNC(input) );
+      memcpy( zVecBufNC(des), zMatRowBufNC(p->des,j), sizeof(double)*zVecSizeNC(des) );
+      nzNetPropagate( net, input );
+      nzNetBackPropagateWorkspace( net, &ws, des, nzLossGradSquareSum );
+      l += nzLossSquareSum( ws.output, des );
+    }
+    if( l / p->n < TARGET ) break;
+    nzOptimizerUpdateNet( &opt, net );
+  }
+  zVecFreeAtOnce( 2, input, des );
+  nzNetWorkspaceDestroy( &ws );
+  nzOptimizerDestroy( &opt );
+  return i;
+}
+
+void compare(problem_t *p, nzNet *net)
+{
+  nzDenseNet initial;
+  double t0, t;
+  int type, n;
+
+  /* every optimizer starts from the same weights and biases */
+  if( !nzDenseNetCompile( &initial, net ) ) return;
+  printf( "%s\n", p->name );
+  for( type=NZ_OPTIMIZER_SDM; type<=NZ_OPTIMIZER_ADAM; type++ ){
+    nzDenseNetCopyToNet( &initial, net );
+    t0 = nzStatsClock();
+    n = train( net, p, type );
+    t = nzStatsClock() - t0;
+    if( n < N_EPOCH )
+      printf( "  %-9s (rate=%g): %6d epochs, %8.4f sec.\n", optimizer_name[type], p->rate[type], n, t );
+    else
+      printf( "  %-9s (rate=%g): not converged in %d epochs, %8.4f sec.\n", optimizer_name[type], p->rate[type], N_EPOCH, t );
+  }
+  nzDenseNetDestroy( &initial );
+  zMatFreeAtOnce( 2, p->input, p->des );
+  nzNetDestroy( net );
+}
+
+int main(int argc, char *argv[])
+{
+  problem_t p;
+  nzNet net;
+
+  zRandInit();
+  printf( "epochs to reach mean loss %g\n", TARGET );
+  problem_xor( &p, &net );
+  compare( &p, &net );
+  problem_sin( &p, &net );
+  compare( &p, &net );
+  problem_autoencoder( &p, &net );
+  compare( &p, &net );
+  return 0;
+}
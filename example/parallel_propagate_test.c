@@ -0,0 +1,83 @@
+#include <neuz/neuz.h>
+
+#define N0  16
+#define N1 512
+#define N2 512
+#define N3   4
+
+#define N_TEST   200
+#define N_THREAD   4
+
+void create_net(nzNet *net)
+{
+  nzNetInit( net );
+  nzNetAddGroupSetActivator( net, N0, NULL );
+  nzNetAddGroupSetActivator( net, N1, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( net, N2, &nz_activator_relu );
+  nzNetAddGroupSetActivator( net, N3, &nz_activator_ident );
+  nzNetConnectGroup( net, 0, 1 );
+  nzNetConnectGroup( net, 1, 2 );
+  nzNetConnectGroup( net, 2, 3 );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net, net_ref;
+  nzDenseNet dn;
+  nzThreadPool pool;
+  zVec input, des, output, output_ref, grad, grad_ref;
+  double err = 0, err_grad, t0, t_serial = 0, t_parallel = 0;
+  int i;
+  bool ok = true;
+
+  zRandInit();
+  create_net( &net );
+  /* the reference network has the same weights and biases, which are also
+   * copied back to the original to be rounded in the same way */
+  create_net( &net_ref );
+  if( !nzDenseNetCompile( &dn, &net ) ||
+      !nzDenseNetCopyToNet( &dn, &net ) || !nzDenseNetCopyToNet( &dn, &net_ref ) ) return EXIT_FAILURE;
+  nzDenseNetDestroy( &dn );
+  if( !nzThreadPoolCreate( &pool, argc > 1 ? atoi( argv[1] ) : N_THREAD ) ) return EXIT_FAILURE;
+  nzNetSetThreadPool( &net, &pool );
+  printf( "number of threads = %d\n", pool.size );
+
+  input = zVecAlloc( N0 );
+  des = zVecAlloc( N3 );
+  output = zVecAlloc( N3 );
+  output_ref = zVecAlloc( N3 );
+  nzNetInitGrad( &net );
+  nzNetInitGrad( &net_ref );
+  for( i=0; i<N_TEST; i++ ){
+    zVecRandUniform( input, -1, 1 );
+    zVecRandUniform( des, -1, 1 );
+    t0 = nzStatsClock();
+    nzNetPropagate( &net_ref, input );
+    t_serial += nzStatsClock() - t0;
+    t0 = nzStatsClock();
+    nzNetPropagate( &net, input );
+    t_parallel += nzStatsClock() - t0;
+    nzNetGetOutput( &net_ref, output_ref );
+    nzNetGetOutput( &net, output );
+    err = zMax( err, zVecDist( output, output_ref ) );
+    nzNetBackPropagate( &net_ref, input, des, nzLossGradSquareSum );
+    nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  }
+  printf( "max. error of outputs = %g\n", err );
+  if( err > 0 ) ok = false;
+  grad = zVecAlloc( nzNetNumParam(&net) );
+  grad_ref = zVecAlloc( nzNetNumParam(&net_ref) );
+  nzNetGetGrad( &net, grad );
+  nzNetGetGrad( &net_ref, grad_ref );
+  /* loss gradients are summed up in the order of workers, which differs from the serial one */
+  err_grad = zVecDist( grad, grad_ref ) / zVecNorm( grad_ref );
+  printf( "relative error of gradients = %g\n", err_grad );
+  if( err_grad > ( pool.size == 1 ? 0 : 1.0e-12 ) ) ok = false;
+  printf( "latency: serial %g usec., parallel %g usec.\n", 1.0e6*t_serial/N_TEST, 1.0e6*t_parallel/N_TEST );
+
+  zVecFreeAtOnce( 6, input, des, output, output_ref, grad, grad_ref );
+  nzNetDestroy( &net );
+  nzNetDestroy( &net_ref );
+  nzThreadPoolDestroy( &pool );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+#include <neuz/neuz.h>
+
+#define N0  16
+#define N1 256
+#define N2 256
+#define N3   4
+
+#define N_BATCH 512
+#define N_THREAD  4
+#define N_TRAIN  20
+#define RATE      1.0e-5
+
+double grad_dist(nzDenseNet *dn1, nzDenseNet *dn2)
+{
+  double e = 0;
+  int i;
+
+  for( i=0; i<dn1->nparam; i++ )
+    e = zMax( e, fabs( dn1->_grad[i] - dn2->_grad[i] ) );
+  return e;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet nn;
+  nzDenseNet dn, dn_ref;
+  nzDenseTrainer tr;
+  zMat input, des;
+  nzReal *grad;
+  double t0, t_serial, t_parallel;
+  int i, nthread;
+
+  zRandInit();
+  nthread = argc > 1 ? atoi( argv[1] ) : N_THREAD;
+
+  nzNetInit( &nn );
+  nzNetAddGroupSetActivator( &nn, N0, NULL );
+  nzNetAddGroupSetActivator( &nn, N1, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &nn, N2, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &nn, N3, &nz_activator_ident );
+  nzNetConnectGroup( &nn, 0, 1 );
+  nzNetConnectGroup( &nn, 1, 2 );
+  nzNetConnectGroup( &nn, 2, 3 );
+  if( !nzDenseNetCompile( &dn, &nn ) || !nzDenseNetCompile( &dn_ref, &nn ) ) return EXIT_FAILURE;
+  if( !nzDenseTrainerCreate( &tr, &dn, nthread ) ) return EXIT_FAILURE;
+  printf( "number of threads = %d\n", nzDenseTrainerNumThreads(&tr) );
+
+  input = zMatAlloc( N_BATCH, N0 );
+  des = zMatAlloc( N_BATCH, N3 );
+  for( i=0; i<N_BATCH*N0; i++ ) zMatBufNC(input)[i] = zRandF( -1, 1 );
+  for( i=0; i<N_BATCH*N3; i++ ) zMatBufNC(des)[i] = zRandF( -1, 1 );
+
+  /* compare gradients with the serial version */
+  nzDenseNetInitGrad( &dn_ref );
+  nzDenseNetBackPropagateBatch( &dn_ref, input, des, nzLossGradSquareSum );
+  nzDenseNetInitGrad( &dn );
+  nzDenseTrainerBackPropagateBatch( &tr, input, des, nzLossGradSquareSum );
+  printf( "max. error of gradients from serial version = %g\n", grad_dist( &dn, &dn_ref ) );
+
+  /* check reproducibility */
+  grad = zAlloc( nzReal, dn.nparam );
+  memcpy( grad, dn._grad, sizeof(nzReal)*dn.nparam );
+  nzDenseNetInitGrad( &dn );
+  nzDenseTrainerBackPropagateBatch( &tr, input, des, nzLossGradSquareSum );
+  printf( "reproduced: %s\n", memcmp( grad, dn._grad, sizeof(nzReal)*dn.nparam ) == 0 ? "yes" : "no" );
+  free( grad );
+
+  /* compare throughputs of training */
+  t0 = nzStatsClock();
+  for( i=0; i<N_TRAIN; i++ ){
+    nzDenseNetInitGrad( &dn_ref );
+    nzDenseNetBackPropagateBatch( &dn_ref, input, des, nzLossGradSquareSum );
+    nzDenseNetTrainSDM( &dn_ref, RATE );
+  }
+  t_serial = nzStatsClock() - t0;
+  t0 = nzStatsClock();
+  for( i=0; i<N_TRAIN; i++ ){
+    nzDenseNetInitGrad( &dn );
+    nzDenseTrainerBackPropagateBatch( &tr, input, des, nzLossGradSquareSum );
+    nzDenseNetTrainSDM( &dn, RATE );
+  }
+  t_parallel = nzStatsClock() - t0;
+  printf( "serial: %g samples/sec., parallel: %g samples/sec. (x%g)\n",
+    N_TRAIN*N_BATCH/t_serial, N_TRAIN*N_BATCH/t_parallel, t_serial/t_parallel );
+
+  nzDenseTrainerDestroy( &tr );
+  nzDenseNetDestroy( &dn );
+  nzDenseNetDestroy( &dn_ref );
+  nzNetDestroy( &nn );
+  zMatFreeAtOnce( 2, input, des );
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <neuz/neuz.h>
+
+#define SIN_DATASET "pipeline_test.dat"
+#define SIN_ZTK     "pipeline_test.ztk"
+
+#define N_SAMPLE  20000
+#define N_EPOCH       5
+#define N_BATCH      10
+#define RATE       0.05
+#define N_PRODUCER    2
+
+/* iterations of a dummy computation to emulate costly decoding */
+#define DECODE_COST 1000
+
+/* write samples of sine and cosine functions, inputs of which are in degrees. */
+bool write_dataset(const char filename[])
+{
+  nzDatasetWriter writer;
+  double input[1], des[2];
+  int i;
+
+  if( !nzDatasetWriterOpen( &writer, filename, 1, 2, sizeof(float) ) ) return false;
+  for( i=0; i<N_SAMPLE; i++ ){
+    input[0] = zRandF( -180, 180 );
+    des[0] = 0.25 * ( sin( zDeg2Rad(input[0]) ) + 1 );
+    des[1] = 0.25 * ( cos( zDeg2Rad(input[0]) ) + 1 );
+    nzDatasetWriterAdd( &writer, input, des );
+  }
+  return nzDatasetWriterClose( &writer );
+}
+
+/* decode and normalize a sample, which is called by producers at once. */
+void transform(void *util, double input[], double des[])
+{
+  double x;
+  int i;
+
+  for( x=input[0], i=0; i<DECODE_COST; i++ ) x = cos( x );
+  input[0] = zDeg2Rad( input[0] ) + 0 * x; /* the dummy result is dropped */
+}
+
+bool report(void *util, int epoch, double loss)
+{
+  eprintf( "%03d %.10g\n", epoch, loss );
+  return !zIsTiny( loss );
+}
+
+/* train a network in a naive loop, which prepares and consumes batches alternately. */
+double train_naive(nzNet *net, nzDataset *ds)
+{
+  zMat input_batch, des_batch;
+  zVec input, des, output;
+  double l, t0;
+  int i, j, k, n;
+
+  input_batch = zMatAlloc( N_BATCH, 1 );
+  des_batch = zMatAlloc( N_BATCH, 2 );
+  input = zVecAlloc( 1 );
+  des = zVecAlloc( 2 );
+  output = zVecAlloc( 2 );
+  t0 = nzStatsClock();
+  nzDatasetRewind( ds );
+  for( i=0; i<N_EPOCH; i++ ){
+    for( l=0; ( n = nzDatasetNextBatch( ds, input_batch, des_batch ) ) > 0; ){
+      for( j=0; j<n; j++ )
+        transform( NULL, zMatRowBufNC(input_batch,j), zMatRowBufNC(des_batch,j) );
+      nzNetInitGrad( net );
+      for( j=0; j<n; j++ ){
+        zVecSetElem( input, 0, zMatElemNC(input_batch,j,0) );
+        for( k=0; k<2; k++ ) zVecSetElem( des, k, zMatElemNC(des_batch,j,k) );
+        nzNetBackPropagate( net, input, des, nzLossGradSquareSum );
+        nzNetGetOutput( net, output );
+        l += nzLossSquareSum( output, des );
+      }
+      nzNetTrainSDM( net, RATE );
+    }
+    if( !report( NULL, i, l ) ) break;
+    nzDatasetRewind( ds );
+  }
+  t0 = nzStatsClock() - t0;
+  zMatFreeAtOnce( 2, input_batch, des_batch );
+  zVecFreeAtOnce( 3, input, des, output );
+  return t0;
+}
+
+/* train a network with batches prefetched by a pipeline. */
+double train_pipeline(nzNet *net, nzDataset *ds, int nthread)
+{
+  nzPipeline pl;
+  double t0;
+
+  t0 = nzStatsClock();
+  if( !nzPipelineCreate( &pl, ds, N_BATCH, NZ_PIPELINE_DEFAULT_CAPACITY, nthread, transform, NULL ) ) return -1;
+  nzPipelineTrainNet( &pl, net, nzLossSquareSum, nzLossGradSquareSum, RATE, N_EPOCH, report, NULL );
+  nzPipelineDestroy( &pl );
+  return nzStatsClock() - t0;
+}
+
+/* maximum difference of outputs of two networks. */
+double compare(nzNet *net1, nzNet *net2)
+{
+  zVec input, output1, output2;
+  double d, dmax = 0;
+  int i;
+
+  input = zVecAlloc( 1 );
+  output1 = zVecAlloc( 2 );
+  output2 = zVecAlloc( 2 );
+  for( i=0; i<100; i++ ){
+    zVecSetElem( input, 0, zRandF(-zPI,zPI) );
+    nzNetPropagate( net1, input );
+    nzNetGetOutput( net1, output1 );
+    nzNetPropagate( net2, input );
+    nzNetGetOutput( net2, output2 );
+    if( ( d = zVecDist( output1, output2 ) ) > dmax ) dmax = d;
+  }
+  zVecFreeAtOnce( 3, input, output1, output2 );
+  return dmax;
+}
+
+int main(int argc, char *argv[])
+{
+  nzDataset ds;
+  nzNet nn, nn_naive, nn_pipe1, nn_pipe;
+  double t_naive, t_pipe1, t_pipe;
+  int nthread;
+  bool ok;
+
+  zRandInit();
+  nthread = argc > 1 ? atoi( argv[1] ) : N_PRODUCER;
+
+  nzNetInit( &nn );
+  nzNetAddGroupSetActivator( &nn, 1, NULL );
+  nzNetAddGroupSetActivator( &nn, 5, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &nn, 2, &nz_activator_sigmoid );
+  nzNetConnectGroup( &nn, 0, 1 );
+  nzNetConnectGroup( &nn, 1, 2 );
+  if( !nzNetWriteZTK( &nn, SIN_ZTK ) ||
+      !nzNetReadZTK( &nn_naive, SIN_ZTK ) ||
+      !nzNetReadZTK( &nn_pipe1, SIN_ZTK ) ||
+      !nzNetReadZTK( &nn_pipe, SIN_ZTK ) ) return EXIT_FAILURE;
+  if( !write_dataset( SIN_DATASET ) || !nzDatasetOpen( &ds, SIN_DATASET ) ) return EXIT_FAILURE;
+  /* samples are visited in the order of the file to compare the results */
+  nzDatasetSetShuffle( &ds, false, 0, 0 );
+
+  eprintf( "naive loop\n" );
+  t_naive = train_naive( &nn_naive, &ds );
+  eprintf( "pipeline with 1 producer\n" );
+  t_pipe1 = train_pipeline( &nn_pipe1, &ds, 1 );
+  eprintf( "pipeline with %d producers\n", nthread );
+  t_pipe = train_pipeline( &nn_pipe, &ds, nthread );
+
+  printf( "naive loop: %.3f sec, pipeline: %.3f sec with 1 producer (x%.2f), %.3f sec with %d producers (x%.2f)\n",
+    t_naive, t_pipe1, t_naive / t_pipe1, t_pipe, nthread, t_naive / t_pipe );
+  printf( "max. difference of outputs from the naive loop = %g, %g\n",
+    compare( &nn_naive, &nn_pipe1 ), compare( &nn_naive, &nn_pipe ) );
+  ok = compare( &nn_naive, &nn_pipe1 ) == 0 && compare( &nn_naive, &nn_pipe ) == 0;
+
+  nzDatasetClose( &ds );
+  nzNetDestroy( &nn );
+  nzNetDestroy( &nn_naive );
+  nzNetDestroy( &nn_pipe1 );
+  nzNetDestroy( &nn_pipe );
+  remove( SIN_DATASET );
+  remove( SIN_ZTK );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
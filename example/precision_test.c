@@ -0,0 +1,83 @@
+#include <neuz/neuz.h>
+
+#define N_TEST 1000
+
+bool check(const char *filename)
+{
+  nzNet net, net_ref;
+  nzDenseNet dn;
+  zVec input, output, output_ref, des, grad, grad_ref;
+  zMat input_batch, des_batch;
+  double e, e_max = 0, e_rms = 0;
+  int i, j;
+
+  if( !nzNetReadZTK( &net, filename ) ) return false;
+  if( !nzNetReadZTK( &net_ref, filename ) ) return false;
+  if( !nzDenseNetCompile( &dn, &net ) ) return false;
+  input = zVecAlloc( nzNetInputSize(&net) );
+  output = zVecAlloc( nzNetOutputSize(&net) );
+  output_ref = zVecAlloc( nzNetOutputSize(&net) );
+  des = zVecAlloc( nzNetOutputSize(&net) );
+  input_batch = zMatAlloc( N_TEST, nzNetInputSize(&net) );
+  des_batch = zMatAlloc( N_TEST, nzNetOutputSize(&net) );
+  for( i=0; i<N_TEST*nzNetInputSize(&net); i++ )
+    zMatBufNC(input_batch)[i] = zRandF( -1, 1 );
+  for( i=0; i<N_TEST*nzNetOutputSize(&net); i++ )
+    zMatBufNC(des_batch)[i] = zRandF( 0, 1 );
+
+  /* drift of outputs */
+  for( i=0; i<N_TEST; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(input_batch,i), sizeof(double)*zVecSizeNC(input) );
+    nzNetPropagate( &net_ref, input );
+    nzNetGetOutput( &net_ref, output_ref );
+    nzDenseNetPropagate( &dn, input );
+    nzDenseNetGetOutput( &dn, output );
+    for( j=0; j<zVecSizeNC(output); j++ ){
+      e = fabs( zVecElemNC(output,j) - zVecElemNC(output_ref,j) );
+      e_max = zMax( e_max, e );
+      e_rms += e * e;
+    }
+  }
+  e_rms = sqrt( e_rms / ( N_TEST * zVecSizeNC(output) ) );
+
+  /* drift of gradients */
+  nzNetInitGrad( &net_ref );
+  for( i=0; i<N_TEST; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(input_batch,i), sizeof(double)*zVecSizeNC(input) );
+    memcpy( zVecBufNC(des), zMatRowBufNC(des_batch,i), sizeof(double)*zVecSizeNC(des) );
+    nzNetBackPropagate( &net_ref, input, des, nzLossGradSquareSum );
+  }
+  nzNetInitGrad( &net );
+  nzDenseNetInitGrad( &dn );
+  nzDenseNetBackPropagateBatch( &dn, input_batch, des_batch, nzLossGradSquareSum );
+  nzDenseNetAddGradToNet( &dn, &net );
+  grad = zVecAlloc( nzNetNumParam(&net) );
+  grad_ref = zVecAlloc( nzNetNumParam(&net_ref) );
+  nzNetGetGrad( &net, grad );
+  nzNetGetGrad( &net_ref, grad_ref );
+  printf( "%s: output max. error = %g, RMS error = %g, gradient relative error = %g\n", filename, e_max, e_rms, zVecDist( grad, grad_ref ) / zVecNorm( grad_ref ) );
+
+  zVecFreeAtOnce( 6, input, output, output_ref, des, grad, grad_ref );
+  zMatFreeAtOnce( 2, input_batch, des_batch );
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &net );
+  nzNetDestroy( &net_ref );
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *filename[] = { "xor.ztk", "sin.ztk", "sin_ae.ztk", NULL };
+  int i;
+
+  zRandInit();
+  printf( "compiled networks in %s precision\n", sizeof(nzReal) == sizeof(float) ? "single" : "double" );
+  if( argc > 1 ){
+    for( i=1; i<argc; i++ )
+      if( !check( argv[i] ) ) return EXIT_FAILURE;
+  } else{
+    for( i=0; filename[i]; i++ )
+      if( !check( filename[i] ) ) return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include <neuz/neuz.h>
+
+#define N_INPUT   64
+#define N_HIDDEN 512
+#define N_OUTPUT   8
+#define N_KEEP    32
+#define N_REPEAT 200
+#define ZTK_FILE "prune_test.ztk"
+
+#define TOL ( sizeof(nzReal) == sizeof(float) ? 1.0e-4 : 1.0e-6 )
+
+void random_vec(zVec v)
+{
+  int i;
+
+  for( i=0; i<zVecSizeNC(v); i++ ) zVecElemNC(v,i) = zRandF( -1, 1 );
+}
+
+double max_diff(zVec v1, zVec v2)
+{
+  double d, dmax = 0;
+  int i;
+
+  for( i=0; i<zVecSizeNC(v1); i++ )
+    if( ( d = fabs( zVecElemNC(v1,i) - zVecElemNC(v2,i) ) ) > dmax ) dmax = d;
+  return dmax;
+}
+
+/* maximum difference of gradients of weights between a network and a compiled sparse network. */
+double max_diff_grad(nzNet *net, nzSparseNet *sn)
+{
+  nzNeuronGroup *ng;
+  nzAxon *ap;
+  double d, dmax = 0;
+  int gid, nid, i, c;
+
+  for( i=0, c=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++, i++ ){
+      for( ap=ng->index[nid]->data.axon; ap; ap=ap->next, c++ )
+        if( ( d = fabs( ap->_dw - sn->_dw[c] ) ) > dmax ) dmax = d;
+      if( ( d = fabs( ng->index[nid]->data._db - sn->_db[i] ) ) > dmax ) dmax = d;
+    }
+  }
+  return dmax;
+}
+
+double measure_net(nzNet *net, zVec input)
+{
+  double t0;
+  int i;
+
+  t0 = nzStatsClock();
+  for( i=0; i<N_REPEAT; i++ ) nzNetPropagate( net, input );
+  return ( nzStatsClock() - t0 ) / N_REPEAT;
+}
+
+double measure_sparse(nzSparseNet *sn, zVec input)
+{
+  double t0;
+  int i;
+
+  t0 = nzStatsClock();
+  for( i=0; i<N_REPEAT; i++ ) nzSparseNetPropagate( sn, input );
+  return ( nzStatsClock() - t0 ) / N_REPEAT;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net, net_read;
+  nzSparseNet sn;
+  zVec input, des, output, output_sparse, output_read;
+  double t_dense, t_pruned, t_sparse;
+  int nconn, n;
+  bool ok = true;
+
+  zRandInit();
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, N_INPUT, NULL );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, N_OUTPUT, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  input = zVecAlloc( N_INPUT );
+  des = zVecAlloc( N_OUTPUT );
+  output = zVecAlloc( N_OUTPUT );
+  output_sparse = zVecAlloc( N_OUTPUT );
+  output_read = zVecAlloc( N_OUTPUT );
+  random_vec( input );
+  random_vec( des );
+
+  nconn = nzNetNumConnection( &net );
+  t_dense = measure_net( &net, input );
+  n = nzNetPruneTopK( &net, N_KEEP );
+  printf( "pruned %d of %d connections, %d kept (%.1f%%).\n", n, nconn, nzNetNumConnection(&net), 100.0 * nzNetNumConnection(&net) / nconn );
+  n = nzNetPrune( &net, 0.5 );
+  printf( "pruned %d more connections with weights less than 0.5, %d kept.\n", n, nzNetNumConnection(&net) );
+  t_pruned = measure_net( &net, input );
+
+  if( !nzSparseNetCompile( &sn, &net ) ) return EXIT_FAILURE;
+  t_sparse = measure_sparse( &sn, input );
+  printf( "propagation: dense %.2f usec, pruned %.2f usec, sparse %.2f usec (x%.1f).\n",
+    1.0e6 * t_dense, 1.0e6 * t_pruned, 1.0e6 * t_sparse, t_dense / t_sparse );
+
+  /* consistency of propagation and back-propagation */
+  nzNetInitGrad( &net );
+  nzNetBackPropagate( &net, input, des, nzLossGradSquareSum );
+  nzNetGetOutput( &net, output );
+  nzSparseNetInitGrad( &sn );
+  nzSparseNetBackPropagate( &sn, input, des, nzLossGradSquareSum );
+  nzSparseNetGetOutput( &sn, output_sparse );
+  printf( "max. difference of outputs = %g, gradients = %g\n", max_diff( output, output_sparse ), max_diff_grad( &net, &sn ) );
+  if( max_diff( output, output_sparse ) > TOL || max_diff_grad( &net, &sn ) > TOL ) ok = false;
+
+  /* training of the sparse network and write-back */
+  nzSparseNetTrainSDM( &sn, 0.01 );
+  nzSparseNetCopyToNet( &sn, &net );
+  nzNetPropagate( &net, input );
+  nzNetGetOutput( &net, output );
+  nzSparseNetPropagate( &sn, input );
+  nzSparseNetGetOutput( &sn, output_sparse );
+  printf( "max. difference of outputs after training = %g\n", max_diff( output, output_sparse ) );
+  if( max_diff( output, output_sparse ) > TOL ) ok = false;
+
+  /* round trip of a pruned network through a ZTK file */
+  nzNetWriteZTK( &net, ZTK_FILE );
+  if( !nzNetReadZTK( &net_read, ZTK_FILE ) ) return EXIT_FAILURE;
+  nzNetPropagate( &net_read, input );
+  nzNetGetOutput( &net_read, output_read );
+  printf( "read %d connections, max. difference of outputs = %g\n", nzNetNumConnection(&net_read), max_diff( output, output_read ) );
+  if( nzNetNumConnection(&net_read) != nzNetNumConnection(&net) || max_diff( output, output_read ) > TOL ) ok = false;
+  remove( ZTK_FILE );
+
+  nzNetDestroy( &net_read );
+  nzSparseNetDestroy( &sn );
+  nzNetDestroy( &net );
+  zVecFreeAtOnce( 5, input, des, output, output_sparse, output_read );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
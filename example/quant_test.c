@@ -0,0 +1,115 @@
+#include <neuz/neuz.h>
+
+#define N_INPUT    16
+#define N_HIDDEN  256
+#define N_OUTPUT    4
+#define N_SAMPLE 1000
+
+/* microseconds per sample of propagation */
+double measure_dense(nzDenseNet *dn, zMat sample, zVec input)
+{
+  double t0;
+  int i;
+
+  t0 = nzStatsClock();
+  for( i=0; i<zMatRowSizeNC(sample); i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(sample,i), sizeof(double)*zVecSizeNC(input) );
+    nzDenseNetPropagate( dn, input );
+  }
+  return 1.0e6 * ( nzStatsClock() - t0 ) / zMatRowSizeNC(sample);
+}
+
+double measure_quant(nzQuantNet *qn, zMat sample, zVec input, zVec output)
+{
+  double t0;
+  int i;
+
+  t0 = nzStatsClock();
+  for( i=0; i<zMatRowSizeNC(sample); i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(sample,i), sizeof(double)*zVecSizeNC(input) );
+    nzQuantNetPropagate( qn, input, output );
+  }
+  return 1.0e6 * ( nzStatsClock() - t0 ) / zMatRowSizeNC(sample);
+}
+
+/* root mean square of outputs of a network as the reference of deltas */
+double output_rms(nzNet *net, zMat sample, zVec input, zVec output)
+{
+  double s = 0;
+  int i, j;
+
+  for( i=0; i<zMatRowSizeNC(sample); i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(sample,i), sizeof(double)*zVecSizeNC(input) );
+    nzNetPropagate( net, input );
+    nzNetGetOutput( net, output );
+    for( j=0; j<zVecSizeNC(output); j++ ) s += zSqr( zVecElemNC(output,j) );
+  }
+  return sqrt( s / ( zMatRowSizeNC(sample) * zVecSizeNC(output) ) );
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzDenseNet dn;
+  nzQuantNet qn;
+  zMat calib, test;
+  zVec input, output;
+  zVecList list;
+  const char *name[] = { "per-layer", "per-neuron" };
+  double maxerr, rmserr;
+  int i, granularity, level;
+
+  zRandInit();
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, N_INPUT, NULL );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, N_HIDDEN, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &net, N_OUTPUT, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  if( !nzDenseNetCompile( &dn, &net ) ) return EXIT_FAILURE;
+
+  calib = zMatAlloc( N_SAMPLE, N_INPUT );
+  test = zMatAlloc( N_SAMPLE, N_INPUT );
+  for( i=0; i<N_SAMPLE*N_INPUT; i++ ){
+    zMatBufNC(calib)[i] = zRandF( -1, 1 );
+    zMatBufNC(test)[i] = zRandF( -1, 1 );
+  }
+  input = zVecAlloc( N_INPUT );
+  output = zVecAlloc( N_OUTPUT );
+
+  printf( "weights: %d bytes as nzReal, RMS of outputs %g\n", (int)( sizeof(nzReal) * ( dn.nparam ) ), output_rms( &net, test, input, output ) );
+  for( granularity=NZ_QUANT_PER_LAYER; granularity<=NZ_QUANT_PER_NEURON; granularity++ ){
+    if( !nzQuantNetCreate( &qn, &dn, granularity ) ||
+        !nzQuantNetCalibrate( &qn, &dn, calib ) ||
+        !nzQuantNetDelta( &qn, &net, test, &maxerr, &rmserr ) ) return EXIT_FAILURE;
+    printf( "%-10s: %d bytes, max. delta %g, RMS delta %g\n", name[granularity], (int)qn._size, maxerr, rmserr );
+    nzQuantNetDestroy( &qn );
+  }
+
+  /* calibration with a list of samples */
+  zListInit( &list );
+  for( i=0; i<N_SAMPLE; i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(calib,i), sizeof(double)*N_INPUT );
+    zVecListInsertHead( &list, input );
+  }
+  if( !nzQuantNetCreate( &qn, &dn, NZ_QUANT_PER_NEURON ) ||
+      !nzQuantNetCalibrateList( &qn, &dn, &list ) ||
+      !nzQuantNetDelta( &qn, &net, test, &maxerr, &rmserr ) ) return EXIT_FAILURE;
+  printf( "calibrated with a list: max. delta %g, RMS delta %g\n", maxerr, rmserr );
+  zVecListDestroy( &list );
+
+  for( level=nzSIMDLevel(); level>=NZ_SIMD_NONE; level-- ){
+    nzSIMDSetLevel( level );
+    printf( "SIMD level %d: dense %.3f usec/sample, quantized %.3f usec/sample\n", level,
+      measure_dense( &dn, test, input ), measure_quant( &qn, test, input, output ) );
+  }
+
+  nzQuantNetDestroy( &qn );
+  zVecFreeAtOnce( 2, input, output );
+  zMatFreeAtOnce( 2, calib, test );
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &net );
+  return EXIT_SUCCESS;
+}
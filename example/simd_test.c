@@ -0,0 +1,56 @@
+#include <neuz/neuz.h>
+
+#define N      10001 /* odd, so that remainders of SIMD kernels are also checked */
+#define RANGE     40
+#define TOL   1.0e-12
+
+nzActivator *activator[] = {
+  &nz_activator_ident, &nz_activator_step, &nz_activator_sigmoid,
+  &nz_activator_relu, &nz_activator_blunt_relu, &nz_activator_softplus,
+  &nz_activator_sigmoid_fast, &nz_activator_sigmoid_table, &nz_activator_softplus_fast,
+  NULL };
+
+const char *level_name[] = { "none", "SSE2", "AVX2" };
+
+/* maximum absolute difference of an array operation from a scalar function. */
+double array_error(double (* f)(double), void (* f_array)(const nzReal[],nzReal[],int), nzReal *x, nzReal *y)
+{
+  double e = 0;
+  int i;
+
+  f_array( x, y, N );
+  for( i=0; i<N; i++ )
+    e = zMax( e, fabs( y[i] - (nzReal)f( x[i] ) ) );
+  return e;
+}
+
+int main(int argc, char *argv[])
+{
+  nzReal *x, *y;
+  double err_f, err_df, tol;
+  int i, level, level_max;
+  bool ok = true;
+
+  x = zAlloc( nzReal, N );
+  y = zAlloc( nzReal, N );
+  for( i=0; i<N; i++ )
+    x[i] = RANGE * ( 2.0 * i / ( N - 1 ) - 1 );
+  /* in single precision, only rounding errors of conversions are allowed */
+  tol = sizeof(nzReal) == sizeof(float) ? 1.0e-6 : TOL;
+  level_max = nzSIMDLevel();
+  printf( "max. errors of array operations from scalar functions (supported up to %s)\n", level_name[level_max] );
+  for( level=NZ_SIMD_NONE; level<=level_max; level++ ){
+    nzSIMDSetLevel( level );
+    printf( "%s\n", level_name[level] );
+    for( i=0; activator[i]; i++ ){
+      err_f = array_error( activator[i]->f, activator[i]->f_array, x, y );
+      err_df = array_error( activator[i]->df, activator[i]->df_array, x, y );
+      printf( "  %-13s: f %g, df %g\n", activator[i]->typestr, err_f, err_df );
+      if( err_f > tol || err_df > tol ) ok = false;
+    }
+  }
+  nzSIMDSetLevel( level_max );
+  free( x );
+  free( y );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+#include <neuz/neuz.h>
+
+void train_ref(zMat input, zMat outref)
+{
+  double theta, s, c;
+  int i;
+
+  for( i=0; i<zMatRowSizeNC(input); i++ ){
+    theta = zRandF(-zPI,zPI);
+    zSinCos( theta, &s, &c );
+    zMatElemNC(input,i,0) = theta;
+    zMatElemNC(outref,i,0) = 0.25*(s+1);
+    zMatElemNC(outref,i,1) = 0.25*(c+1);
+  }
+}
+
+double train(nzDenseNet *dn, zMat input, zMat outref)
+{
+  nzDenseLayer *layer;
+  double l = 0;
+  int i;
+
+  train_ref( input, outref );
+  nzDenseNetBackPropagateBatch( dn, input, outref, nzLossGradSquareSum );
+  layer = nzDenseNetOutputLayer(dn);
+  for( i=0; i<zMatRowSizeNC(outref)*zMatColSizeNC(outref); i++ )
+    l += 0.5 * zSqr( layer->batch_output[i] - zMatBufNC(outref)[i] );
+  return l;
+}
+
+void test(nzNet *net, zVec input, zVec output, zVec outref, double theta)
+{
+  double s, c;
+
+  zSinCos( theta, &s, &c );
+  zVecSetElem( input, 0, theta );
+  zVecSetElemList( outref, 0.25*(s+1), 0.25*(c+1) );
+  nzNetPropagate( net, input );
+  nzNetGetOutput( net, output );
+  printf( "%g %g %g %g %g\n", theta, zVecElemNC(outref,0), zVecElemNC(outref,1), zVecElemNC(output,0), zVecElemNC(output,1) );
+}
+
+#define N0 1
+#define N1 5
+#define N2 2
+
+#define N_TRAIN 10000
+#define N_BATCH    10
+#define RATE        0.05
+
+int main(int argc, char *argv[])
+{
+  nzNet nn;
+  nzDenseNet dn;
+  zVec input, output, outref;
+  zMat input_batch, outref_batch;
+  double l;
+  int i, j, n_train, n_batch;
+
+  zRandInit();
+
+  n_train = argc > 1 ? atoi( argv[1] ) : N_TRAIN;
+  n_batch = argc > 2 ? atoi( argv[2] ) : N_BATCH;
+
+  /* create and compile network */
+  nzNetInit( &nn );
+  nzNetAddGroupSetActivator( &nn, N0, NULL );
+  nzNetAddGroupSetActivator( &nn, N1, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &nn, N2, &nz_activator_sigmoid );
+  nzNetConnectGroup( &nn, 0, 1 );
+  nzNetConnectGroup( &nn, 1, 2 );
+  if( !nzDenseNetCompile( &dn, &nn ) ) return EXIT_FAILURE;
+  input_batch  = zMatAlloc( n_batch, nzDenseNetInputSize(&dn) );
+  outref_batch = zMatAlloc( n_batch, nzDenseNetOutputSize(&dn) );
+
+  /* train */
+  for( i=0; i<n_train; i++ ){
+    nzDenseNetInitGrad( &dn );
+    l = train( &dn, input_batch, outref_batch );
+    eprintf( "%03d %.10g\n", i, l );
+    if( zIsTiny( l ) ) break;
+    nzDenseNetTrainSDM( &dn, RATE );
+  }
+  nzDenseNetCopyToNet( &dn, &nn );
+
+  /* check */
+  input  = zVecAlloc( nzNetInputSize(&nn) );
+  output = zVecAlloc( nzNetOutputSize(&nn) );
+  outref = zVecAlloc( nzNetOutputSize(&nn) );
+  for( j=0; j<100; j++ )
+    test( &nn, input, output, outref, zRandF(-zPI,zPI) );
+
+  nzDenseNetDestroy( &dn );
+  nzNetDestroy( &nn );
+  zVecFreeAtOnce( 3, input, output, outref );
+  zMatFreeAtOnce( 2, input_batch, outref_batch );
+  return 0;
+}
@@ -0,0 +1,54 @@
+#include <neuz/neuz.h>
+
+#define N_STEP 2000
+#define RATE   0.01
+
+double train(nzNet *net, zVec input, zVec des)
+{
+  double t0;
+  int i, j;
+
+  t0 = nzStatsClock();
+  for( i=0; i<N_STEP; i++ ){
+    for( j=0; j<zVecSizeNC(input); j++ ) zVecElemNC(input,j) = zRandF( -1, 1 );
+    for( j=0; j<zVecSizeNC(des); j++ ) zVecElemNC(des,j) = sin( zVecElemNC(input,j%zVecSizeNC(input)) );
+    nzNetInitGrad( net );
+    nzNetBackPropagate( net, input, des, nzLossGradSquareSum );
+    nzNetTrainSDM( net, RATE );
+  }
+  return nzStatsClock() - t0;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net;
+  nzNetStats stats;
+  zVec input, des;
+  double t_off, t_on;
+
+  zRandInit();
+  nzNetInit( &net );
+  nzNetAddGroupSetActivator( &net, 8, NULL );
+  nzNetAddGroupSetActivator( &net, 64, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net, 32, &nz_activator_relu );
+  nzNetAddGroupSetActivator( &net, 2, &nz_activator_ident );
+  nzNetConnectGroup( &net, 0, 1 );
+  nzNetConnectGroup( &net, 1, 2 );
+  nzNetConnectGroup( &net, 2, 3 );
+  input = zVecAlloc( nzNetInputSize(&net) );
+  des = zVecAlloc( nzNetOutputSize(&net) );
+
+  t_off = train( &net, input, des );
+  nzNetStatsInit( &stats );
+  if( !nzNetSetStats( &net, &stats ) ) return EXIT_FAILURE;
+  t_on = train( &net, input, des );
+  nzNetSetStats( &net, NULL );
+
+  nzNetStatsFPrint( stdout, &stats );
+  printf( "%d steps: %g sec. without statistics, %g sec. with statistics\n", N_STEP, t_off, t_on );
+
+  nzNetStatsDestroy( &stats );
+  zVecFreeAtOnce( 2, input, des );
+  nzNetDestroy( &net );
+  return EXIT_SUCCESS;
+}
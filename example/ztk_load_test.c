@@ -0,0 +1,67 @@
+#include <neuz/neuz.h>
+
+#define FILENAME "large.ztk"
+
+/* number of axons of a neural network. */
+int count_axon(nzNet *net)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  int n = 0;
+
+  zListForEach( net, nc )
+    zListForEach( &nc->data.list, np )
+      for( ap=np->data.axon; ap; ap=ap->next ) n++;
+  return n;
+}
+
+/* maximum difference between outputs of two neural networks for a random input. */
+double output_dist(nzNet *net1, nzNet *net2)
+{
+  zVec input, output1, output2;
+  double e;
+  int i;
+
+  input = zVecAlloc( nzNetInputSize(net1) );
+  output1 = zVecAlloc( nzNetOutputSize(net1) );
+  output2 = zVecAlloc( nzNetOutputSize(net2) );
+  for( i=0; i<zVecSizeNC(input); i++ ) zVecElemNC(input,i) = zRandF( -1, 1 );
+  nzNetPropagate( net1, input );
+  nzNetGetOutput( net1, output1 );
+  nzNetPropagate( net2, input );
+  nzNetGetOutput( net2, output2 );
+  e = zVecDist( output1, output2 );
+  zVecFreeAtOnce( 3, input, output1, output2 );
+  return e;
+}
+
+int main(int argc, char *argv[])
+{
+  nzNet net1, net2;
+  int n;
+  double t0;
+
+  zRandInit();
+  n = argc > 1 ? atoi( argv[1] ) : 1000;
+  nzNetInit( &net1 );
+  nzNetAddGroupSetActivator( &net1, n, NULL );
+  nzNetAddGroupSetActivator( &net1, n, &nz_activator_sigmoid );
+  nzNetAddGroupSetActivator( &net1, n, &nz_activator_ident );
+  nzNetConnectGroup( &net1, 0, 1 );
+  nzNetConnectGroup( &net1, 1, 2 );
+  printf( "%d neurons, %d connections\n", 3*n, count_axon( &net1 ) );
+
+  t0 = nzStatsClock();
+  if( !nzNetWriteZTK( &net1, FILENAME ) ) return EXIT_FAILURE;
+  printf( "write: %g sec.\n", nzStatsClock() - t0 );
+  t0 = nzStatsClock();
+  if( !nzNetReadZTK( &net2, FILENAME ) ) return EXIT_FAILURE;
+  printf( "read: %g sec.\n", nzStatsClock() - t0 );
+  printf( "%d connections read, error of outputs = %g\n", count_axon( &net2 ), output_dist( &net1, &net2 ) );
+
+  remove( FILENAME );
+  nzNetDestroy( &net1 );
+  nzNetDestroy( &net2 );
+  return EXIT_SUCCESS;
+}
@@ -12,6 +12,15 @@
 #define __NEUZ_H__
 
 #include <neuz/neuz_neuron.h>
+#include <neuz/neuz_dense.h>
+#include <neuz/neuz_frozen.h>
+#include <neuz/neuz_quant.h>
+#include <neuz/neuz_sparse.h>
+#include <neuz/neuz_dataset.h>
+#include <neuz/neuz_trainer.h>
+#include <neuz/neuz_pipeline.h>
+#include <neuz/neuz_serve.h>
+#include <neuz/neuz_optimizer.h>
 #include <neuz/neuz_loss.h>
 
 #endif /* __NEUZ_H__ */
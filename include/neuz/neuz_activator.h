@@ -9,15 +9,26 @@
 #ifndef __NEUZ_ACTIVATOR_H__
 #define __NEUZ_ACTIVATOR_H__
 
-#include <neuz/neuz_misc.h>
+#include <neuz/neuz_simd.h>
 
 __BEGIN_DECLS
 
-/*! \brief activator function class */
+/*! \brief activator function class
+ *
+ * f_array and df_array apply f and df to each of n values of an array
+ * x, and store the results in an array y, which can be identical with
+ * x. They run SIMD kernels of the instruction set selected by
+ * nzSIMDSetLevel() if available. They are optional, and can be the
+ * null pointers for a user-defined activator, in which case
+ * nzActivatorFArray() and nzActivatorDFArray() fall back to f and df
+ * over each element.
+ */
 ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzActivator ){
   const char *typestr;   /* a string to represent type */
   double (* f)(double);  /* function */
   double (* df)(double); /* derivative function */
+  void (* f_array)(const nzReal x[], nzReal y[], int n);  /* function over an array */
+  void (* df_array)(const nzReal x[], nzReal y[], int n); /* derivative function over an array */
 };
 
 /*! \brief identity function */
@@ -38,6 +49,38 @@ __NEUZ_EXPORT nzActivator nz_activator_blunt_relu;
 /*! \brief softplus */
 __NEUZ_EXPORT nzActivator nz_activator_softplus;
 
+/*! \brief fast approximate activator functions
+ *
+ * the following activators approximate the sigmoid function and
+ * softplus with bounded errors for lower latency, and are assigned by
+ * type strings "sigmoid_fast", "sigmoid_table" and "softplus_fast".
+ *  - sigmoid_fast: the exponential function is approximated by a
+ *    polynomial of degree 5. The maximum absolute errors of the
+ *    function and the derivative are 8.0e-7 and 1.2e-6, respectively.
+ *  - sigmoid_table: values are interpolated from a table of 162 nodes
+ *    in an interval of 1/8 by cubic Hermite polynomials. The maximum
+ *    absolute errors of the function and the derivative are 1.0e-7 and
+ *    2.0e-7, respectively. It is the fastest without SIMD instructions,
+ *    while sigmoid_fast is faster with AVX2.
+ *  - softplus_fast: the exponential function is approximated as above,
+ *    and the logarithm by a series up to the 11th order. The maximum
+ *    absolute errors of the function and the derivative are 1.4e-6 and
+ *    8.0e-7, respectively.
+ */
+__NEUZ_EXPORT nzActivator nz_activator_sigmoid_fast;
+__NEUZ_EXPORT nzActivator nz_activator_sigmoid_table;
+__NEUZ_EXPORT nzActivator nz_activator_softplus_fast;
+
+/*! \brief apply an activator function and its derivative to an array.
+ *
+ * nzActivatorFArray() and nzActivatorDFArray() apply f and df of
+ * \a activator to each of \a n values of \a x, and store the results
+ * in \a y, which can be identical with \a x. f_array and df_array of
+ * \a activator are used if available.
+ */
+__NEUZ_EXPORT void nzActivatorFArray(nzActivator *activator, const nzReal x[], nzReal y[], int n);
+__NEUZ_EXPORT void nzActivatorDFArray(nzActivator *activator, const nzReal x[], nzReal y[], int n);
+
 /*! \brief assign an activator function by a string. */
 __NEUZ_EXPORT nzActivator *nzActivatorAssignByStr(const char *str);
 
@@ -0,0 +1,71 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_arena.h
+ * \brief arena allocator.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_ARENA_H__
+#define __NEUZ_ARENA_H__
+
+#include <neuz/neuz_misc.h>
+
+__BEGIN_DECLS
+
+/*! \brief memory block of an arena */
+ZDECL_STRUCT( nzArenaBlock );
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzArenaBlock ){
+  nzArenaBlock *next; /* previously allocated block */
+  size_t size;        /* size of the block */
+  size_t used;        /* size of the used part of the block */
+};
+
+/*! \brief arena allocator class
+ *
+ * an arena allocates small objects from large memory blocks in order,
+ * and releases all of them at once. Objects allocated successively
+ * are placed next to each other in memory. An object cannot be freed
+ * individually.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzArena ){
+  nzArenaBlock *block; /* the latest block */
+  size_t blocksize;    /* size of the next block */
+#ifdef __cplusplus
+  nzArena() : block{NULL}, blocksize{0} {}
+  void init();
+  void *alloc(size_t size);
+  void destroy();
+#endif /* __cplusplus */
+};
+
+/*! \brief initialize an arena. */
+__NEUZ_EXPORT void nzArenaInit(nzArena *arena);
+
+/*! \brief allocate a zero-cleared memory from an arena.
+ *
+ * nzArenaAlloc() allocates \a size bytes from \a arena. The returned
+ * memory is aligned to the size of double and is zero-cleared.
+ * When the current block of \a arena runs short, a new block twice as
+ * large as the last one is allocated up to a limit.
+ * \return
+ * a pointer to the allocated memory is returned. If it fails to
+ * allocate a new block, the null pointer is returned.
+ */
+__NEUZ_EXPORT void *nzArenaAlloc(nzArena *arena, size_t size);
+
+/*! \brief allocate a zero-cleared array from an arena. */
+#define nzArenaAllocType(arena,type,n) ( (type *)nzArenaAlloc( arena, sizeof(type)*(n) ) )
+
+/*! \brief destroy an arena to release all allocated objects at once. */
+__NEUZ_EXPORT void nzArenaDestroy(nzArena *arena);
+
+#ifdef __cplusplus
+inline void nzArena::init(){ nzArenaInit( this ); }
+inline void *nzArena::alloc(size_t size){ return nzArenaAlloc( this, size ); }
+inline void nzArena::destroy(){ nzArenaDestroy( this ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_ARENA_H__ */
@@ -0,0 +1,249 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_dataset.h
+ * \brief binary dataset of training samples.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_DATASET_H__
+#define __NEUZ_DATASET_H__
+
+#include <neuz/neuz_misc.h>
+
+__BEGIN_DECLS
+
+/*! \brief version of the binary file format of datasets */
+#define NZ_DATASET_VERSION 1
+
+/*! \brief alignment of samples in a binary dataset file in bytes */
+#define NZ_DATASET_ALIGN 64
+
+/*! \brief default number of successive samples of a block to be shuffled */
+#define NZ_DATASET_DEFAULT_BLOCKSIZE 256
+/*! \brief default number of blocks of a window to be shuffled */
+#define NZ_DATASET_DEFAULT_WINDOW     64
+
+/*! \brief binary dataset file
+ *
+ * a binary dataset file consists of a header, which contains a magic
+ * string, the version NZ_DATASET_VERSION, a byte-order mark, the size
+ * of an element in bytes (4 for float and 8 for double), the numbers
+ * of inputs and desired outputs of a sample, the number of samples and
+ * the offset of samples from the head, and samples aligned at
+ * NZ_DATASET_ALIGN bytes. A sample is a row of inputs followed by
+ * desired outputs. Elements are stored in the native byte order.
+ */
+
+/*! \brief writer of a binary dataset file
+ *
+ * samples are appended to a file one by one, and the number of samples
+ * in the header is fixed when the file is closed, so that a dataset
+ * larger than memory can be written.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzDatasetWriter ){
+  int ninput;       /* number of inputs of a sample */
+  int noutput;      /* number of desired outputs of a sample */
+  int realsize;     /* size of an element in bytes */
+  size_t nsample;   /* number of samples written */
+  FILE *_fp;
+  void *_row;       /* buffer of a row */
+  bool _ok;         /* false if it failed to write */
+#ifdef __cplusplus
+  nzDatasetWriter() : ninput{0}, noutput{0}, realsize{0}, nsample{0}, _fp{NULL}, _row{NULL}, _ok{false} {}
+  nzDatasetWriter *open(const char filename[], int ninput, int noutput, int realsize);
+  bool add(const double input[], const double des[]);
+  bool close();
+#endif /* __cplusplus */
+};
+
+/*! \brief open a binary dataset file to write.
+ *
+ * nzDatasetWriterOpen() creates a file \a filename for samples with
+ * \a ninput inputs and \a noutput desired outputs, the elements of
+ * which are stored in \a realsize bytes, namely, sizeof(float) or
+ * sizeof(double).
+ * \return
+ * a pointer \a writer is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzDatasetWriter *nzDatasetWriterOpen(nzDatasetWriter *writer, const char filename[], int ninput, int noutput, int realsize);
+
+/*! \brief append a sample to a binary dataset file.
+ *
+ * nzDatasetWriterAdd() appends a sample of inputs \a input and desired
+ * outputs \a des to the file of \a writer.
+ * \return
+ * false is returned if it fails to write. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDatasetWriterAdd(nzDatasetWriter *writer, const double input[], const double des[]);
+
+/*! \brief close a binary dataset file.
+ *
+ * nzDatasetWriterClose() writes the number of samples to the header
+ * and closes the file of \a writer.
+ * \return
+ * false is returned if it failed to write any of samples or the
+ * header. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDatasetWriterClose(nzDatasetWriter *writer);
+
+/*! \brief convert a text file of samples to a binary dataset file.
+ *
+ * nzDatasetConvertText() reads samples from a text file \a textfile,
+ * and writes them to a binary dataset file \a binfile by a writer
+ * opened with \a ninput, \a noutput and \a realsize. Each line of the
+ * text file is a sample of \a ninput inputs followed by \a noutput
+ * desired outputs separated by commas, semicolons, tabs or spaces, as
+ * in CSV files. Empty lines and lines beginning with '#' are skipped,
+ * and so is the first line if it does not begin with a number, which
+ * is a header of columns in CSV files.
+ * \return
+ * the number of samples is returned. If a line has a wrong number of
+ * values or it fails to write the binary file, -1 is returned.
+ */
+__NEUZ_EXPORT long nzDatasetConvertText(const char textfile[], const char binfile[], int ninput, int noutput, int realsize);
+
+/*! \brief reader of a binary dataset file
+ *
+ * a dataset file is mapped to memory, so that pages of samples are
+ * loaded on demand without reading the whole file, and are shared with
+ * other processes which map the same file.
+ * Samples of an epoch are visited in a shuffled order in two levels.
+ * The file is divided into blocks of successive blocksize samples, and
+ * the order of blocks is shuffled. Then, samples in a window of
+ * successive window blocks in the shuffled order are shuffled. Only an
+ * index of blocks and that of samples in a window are held in memory,
+ * while samples are read at random from a window of a bounded size.
+ * Pages of the next window are read ahead by the operating system, and
+ * those of the previous window are released from the process.
+ * On systems without mmap(), samples are read from the file one by one.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzDataset ){
+  int ninput;         /* number of inputs of a sample */
+  int noutput;        /* number of desired outputs of a sample */
+  int realsize;       /* size of an element in bytes */
+  size_t nsample;     /* number of samples */
+  size_t rowsize;     /* size of a sample in bytes */
+  int blocksize;      /* number of successive samples of a block */
+  int window;         /* number of blocks of a window */
+  bool shuffle;       /* visit samples in a shuffled order */
+  /* order of samples of the current epoch */
+  size_t nblock;      /* number of blocks */
+  size_t *_block;     /* order of blocks */
+  size_t *_order;     /* order of samples in the current window */
+  size_t _wblock;     /* the first block of the current window in _block */
+  int _wsize;         /* number of samples in the current window */
+  int _wpos;          /* position of the next sample in the current window */
+  /* file */
+  const char *_data;  /* head of samples in the mapped region */
+  void *_map;         /* mapped region */
+  size_t _mapsize;    /* size of the mapped region */
+  FILE *_fp;          /* file read without mmap() */
+  size_t _offset;     /* offset of samples from the head of the file */
+  void *_row;         /* buffer of a row read without mmap() */
+#ifdef __cplusplus
+  nzDataset() : ninput{0}, noutput{0}, realsize{0}, nsample{0}, rowsize{0}, blocksize{0}, window{0}, shuffle{false}, nblock{0}, _block{NULL}, _order{NULL}, _wblock{0}, _wsize{0}, _wpos{0}, _data{NULL}, _map{NULL}, _mapsize{0}, _fp{NULL}, _offset{0}, _row{NULL} {}
+  nzDataset *open(const char filename[]);
+  void close();
+  size_t size() const;
+  bool setShuffle(bool shuffle, int blocksize, int window);
+  void rewind();
+  bool getSample(size_t i, double input[], double des[]);
+  int nextIndex(size_t index[], int n);
+  int nextBatch(zMat input, zMat des);
+#endif /* __cplusplus */
+};
+
+#define nzDatasetSize(ds)       (ds)->nsample
+#define nzDatasetInputSize(ds)  (ds)->ninput
+#define nzDatasetOutputSize(ds) (ds)->noutput
+
+/*! \brief open a binary dataset file to read.
+ *
+ * nzDatasetOpen() opens a file \a filename written by a dataset writer,
+ * and maps it to memory. Samples are visited in a shuffled order with
+ * NZ_DATASET_DEFAULT_BLOCKSIZE and NZ_DATASET_DEFAULT_WINDOW by
+ * default, and the first epoch is prepared.
+ * \return
+ * a pointer \a ds is returned if it succeeds. If it fails to open the
+ * file, or the file is broken, of another version or in another byte
+ * order, the null pointer is returned.
+ */
+__NEUZ_EXPORT nzDataset *nzDatasetOpen(nzDataset *ds, const char filename[]);
+
+/*! \brief close a binary dataset file. */
+__NEUZ_EXPORT void nzDatasetClose(nzDataset *ds);
+
+/*! \brief set the order of samples of a dataset.
+ *
+ * nzDatasetSetShuffle() lets \a ds visit samples in a shuffled order
+ * with blocks of \a blocksize samples and windows of \a window blocks
+ * if \a shuffle is true, or in the order of the file otherwise. A new
+ * epoch begins.
+ * \return
+ * false is returned if it fails to allocate internal workspace.
+ * Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDatasetSetShuffle(nzDataset *ds, bool shuffle, int blocksize, int window);
+
+/*! \brief begin a new epoch of a dataset.
+ *
+ * nzDatasetRewind() begins a new epoch of \a ds. If samples are
+ * shuffled, a new order is drawn by zRandI().
+ */
+__NEUZ_EXPORT void nzDatasetRewind(nzDataset *ds);
+
+/*! \brief get a sample of a dataset.
+ *
+ * nzDatasetGetSample() copies inputs and desired outputs of the \a i-th
+ * sample of \a ds in the file to \a input and \a des, respectively.
+ * Either of them can be the null pointer. It is safe to call it from
+ * threads at once for a mapped file.
+ * \return
+ * false is returned if \a i is out of range or it fails to read the
+ * file. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDatasetGetSample(nzDataset *ds, size_t i, double input[], double des[]);
+
+/*! \brief indices of the next samples of a dataset.
+ *
+ * nzDatasetNextIndex() stores indices of the next \a n samples of the
+ * current epoch of \a ds to \a index without reading them, so that
+ * they can be read by nzDatasetGetSample() in other threads.
+ * \return
+ * the number of stored indices is returned, which is less than \a n at
+ * the end of an epoch, and is 0 after the end.
+ */
+__NEUZ_EXPORT int nzDatasetNextIndex(nzDataset *ds, size_t index[], int n);
+
+/*! \brief get the next mini-batch of a dataset.
+ *
+ * nzDatasetNextBatch() copies the next samples of the current epoch of
+ * \a ds to rows of \a input and \a des, which have to have as many rows
+ * and ninput and noutput columns, respectively.
+ * \return
+ * the number of copied samples is returned, which is less than the
+ * number of rows of \a input at the end of an epoch, and is 0 after
+ * the end. nzDatasetRewind() has to be called to begin the next epoch.
+ * If sizes of \a input and \a des mismatch, -1 is returned.
+ */
+__NEUZ_EXPORT int nzDatasetNextBatch(nzDataset *ds, zMat input, zMat des);
+
+#ifdef __cplusplus
+inline nzDatasetWriter *nzDatasetWriter::open(const char filename[], int ninput, int noutput, int realsize){ return nzDatasetWriterOpen( this, filename, ninput, noutput, realsize ); }
+inline bool nzDatasetWriter::add(const double input[], const double des[]){ return nzDatasetWriterAdd( this, input, des ); }
+inline bool nzDatasetWriter::close(){ return nzDatasetWriterClose( this ); }
+inline nzDataset *nzDataset::open(const char filename[]){ return nzDatasetOpen( this, filename ); }
+inline void nzDataset::close(){ nzDatasetClose( this ); }
+inline size_t nzDataset::size() const { return nzDatasetSize( this ); }
+inline bool nzDataset::setShuffle(bool shuffle, int blocksize, int window){ return nzDatasetSetShuffle( this, shuffle, blocksize, window ); }
+inline void nzDataset::rewind(){ nzDatasetRewind( this ); }
+inline bool nzDataset::getSample(size_t i, double input[], double des[]){ return nzDatasetGetSample( this, i, input, des ); }
+inline int nzDataset::nextIndex(size_t index[], int n){ return nzDatasetNextIndex( this, index, n ); }
+inline int nzDataset::nextBatch(zMat input, zMat des){ return nzDatasetNextBatch( this, input, des ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_DATASET_H__ */
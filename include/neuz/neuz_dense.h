@@ -0,0 +1,300 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_dense.h
+ * \brief compiled dense-layer network.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_DENSE_H__
+#define __NEUZ_DENSE_H__
+
+#include <neuz/neuz_neuron.h>
+
+__BEGIN_DECLS
+
+/*! \brief dense layer class
+ *
+ * weights of a layer are stored in a row-major nout x nin matrix,
+ * namely, the i-th row is the set of weights of the i-th neuron.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzDenseLayer ){
+  int nin;                /* size of input */
+  int nout;               /* size of output */
+  nzReal *weight;         /* weight matrix */
+  nzReal *bias;           /* bias vector */
+  nzActivator *activator; /* activator function */
+  nzReal *input;          /* weighted sums of upstream outputs */
+  nzReal *output;         /* output values */
+  nzReal *batch_input;    /* weighted sums for a batch of samples */
+  nzReal *batch_output;   /* output values for a batch of samples */
+  nzReal *_dw;            /* gradient of weights */
+  nzReal *_db;            /* gradient of biases */
+  nzReal *_batch_p;       /* back-propagated loss gradients for a batch */
+  nzReal *_batch_v;       /* derivatives of the activator for a batch */
+};
+
+/*! \brief compiled dense-layer network class
+ *
+ * weights, biases and values of a compiled network are stored as
+ * nzReal, which is float if neuZ is built with __NEUZ_FLOAT32__
+ * defined, and double otherwise. Values are converted at the
+ * interfaces with zVec and zMat.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzDenseNet ){
+  int size;             /* number of layers except the input layer */
+  nzDenseLayer *layer;  /* array of layers */
+  nzReal *input;        /* input values */
+  int nparam;           /* number of weights and biases */
+  nzReal *_param;       /* buffer of weights and biases */
+  nzReal *_grad;        /* buffer of gradients of weights and biases */
+  nzReal *_work;        /* buffer of inputs and outputs of layers */
+  int batchsize;        /* number of samples the batch buffer can hold */
+  nzReal *batch_input;  /* input values for a batch of samples */
+  nzReal *_batch;       /* buffer of inputs and outputs of layers for a batch */
+  zVec _output;         /* output values of a sample passed to a loss gradient function */
+  zVec _des;            /* desired output values of a sample passed to a loss gradient function */
+  void *_map;           /* memory-mapped binary file that holds _param */
+  size_t _mapsize;      /* size of the memory-mapped binary file */
+#ifdef __cplusplus
+  nzDenseNet() : size{0}, layer{NULL}, input{NULL}, nparam{0}, _param{NULL}, _grad{NULL}, _work{NULL}, batchsize{0}, batch_input{NULL}, _batch{NULL}, _output{NULL}, _des{NULL}, _map{NULL}, _mapsize{0} {}
+  void init();
+  void destroy();
+  int inputSize() const;
+  int outputSize() const;
+  nzDenseNet *compile(nzNet *net);
+  nzDenseNet *share(nzDenseNet *src);
+  bool copyToNet(nzNet *net);
+  bool addGradToNet(nzNet *net);
+  bool setInput(zVec input);
+  bool getOutput(zVec output);
+  bool propagate(zVec input);
+  bool propagateBatch(zMat input, zMat output);
+  void initGrad();
+  bool backpropagateBatch(zMat input, zMat des, double (* lossgrad)(zVec,zVec,int));
+  void trainSDM(double rate);
+  bool writeBinary(const char filename[]);
+  nzDenseNet *readBinary(const char filename[]);
+  nzDenseNet *mapBinary(const char filename[]);
+#endif /* __cplusplus */
+};
+
+#define nzDenseNetInputLayer(dn)  ( &(dn)->layer[0] )
+#define nzDenseNetOutputLayer(dn) ( &(dn)->layer[(dn)->size-1] )
+
+#define nzDenseNetInputSize(dn)  nzDenseNetInputLayer(dn)->nin
+#define nzDenseNetOutputSize(dn) nzDenseNetOutputLayer(dn)->nout
+
+/*! \brief initialize a compiled dense-layer network. */
+__NEUZ_EXPORT void nzDenseNetInit(nzDenseNet *dn);
+
+/*! \brief destroy a compiled dense-layer network. */
+__NEUZ_EXPORT void nzDenseNetDestroy(nzDenseNet *dn);
+
+/*! \brief compile a layered neural network into a dense-layer network.
+ *
+ * nzDenseNetCompile() converts a neural network \a net to a set of
+ * contiguous weight matrices and bias vectors, and stores them in
+ * \a dn. Every neuron group of \a net except the input layer has to
+ * take inputs only from the preceding group, and neurons in a group
+ * have to share the same activator function. Missing connections
+ * between adjacent groups are compiled as zero weights.
+ * \return
+ * a pointer \a dn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzDenseNet *nzDenseNetCompile(nzDenseNet *dn, nzNet *net);
+
+/*! \brief create a compiled dense-layer network that shares weights and biases with another.
+ *
+ * nzDenseNetShare() creates \a dn that refers to weights and biases
+ * of \a src, and has its own buffers of gradients and values of
+ * layers. It enables multiple threads to propagate or back-propagate
+ * different samples through the same network at the same time.
+ * \a dn has to be destroyed before \a src, and cannot be trained by
+ * itself.
+ * \return
+ * a pointer \a dn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzDenseNet *nzDenseNetShare(nzDenseNet *dn, nzDenseNet *src);
+
+/*! \brief copy weights and biases of a compiled dense-layer network back to a neural network.
+ *
+ * nzDenseNetCopyToNet() writes weights and biases of \a dn to the
+ * corresponding axons and neurons of \a net, from which \a dn was
+ * compiled. If two neurons are connected by more than one axon, the
+ * whole weight is assigned to one of them and the others are zeroed.
+ * \return
+ * false is returned if the topology of \a net does not match with
+ * \a dn. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDenseNetCopyToNet(nzDenseNet *dn, nzNet *net);
+
+/*! \brief add gradients of a compiled dense-layer network to a neural network.
+ *
+ * nzDenseNetAddGradToNet() adds gradients of weights and biases
+ * accumulated in \a dn to _dw of axons and _db of neurons of \a net,
+ * from which \a dn was compiled, so that nzNetTrainSDM() can apply
+ * them.
+ * \return
+ * false is returned if the topology of \a net does not match with
+ * \a dn. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzDenseNetAddGradToNet(nzDenseNet *dn, nzNet *net);
+
+/*! \brief set input values to a compiled dense-layer network. */
+__NEUZ_EXPORT bool nzDenseNetSetInput(nzDenseNet *dn, zVec input);
+
+/*! \brief get output values from a compiled dense-layer network. */
+__NEUZ_EXPORT bool nzDenseNetGetOutput(nzDenseNet *dn, zVec output);
+
+/*! \brief propagate input values to a compiled dense-layer network to the output.
+ *
+ * nzDenseNetPropagate() computes the output of \a dn for the given
+ * \a input, which is identical with nzNetPropagate() applied to the
+ * original network up to rounding errors. If \a input is the null
+ * pointer, the values previously set by nzDenseNetSetInput() are used.
+ */
+__NEUZ_EXPORT bool nzDenseNetPropagate(nzDenseNet *dn, zVec input);
+
+/*! \brief propagate a batch of input values to a compiled dense-layer network.
+ *
+ * nzDenseNetPropagateBatch() computes outputs of \a dn for a batch of
+ * samples at once. Each row of \a input is an input vector of a sample,
+ * and the corresponding output vector is stored in the same row of
+ * \a output. Namely, \a input and \a output have to be N x (input size)
+ * and N x (output size) matrices, respectively, where N is the number
+ * of samples. Layers are evaluated by matrix-matrix products, so that
+ * each weight matrix is loaded once per a batch instead of once per a
+ * sample. Weighted sums and outputs of each layer for the batch are
+ * kept in batch_input and batch_output of the layer.
+ * To evaluate a batch of samples with a linked network, compile it once
+ * by nzDenseNetCompile() and apply nzDenseNetPropagateBatch() to the
+ * result as long as weights and topology of the network are unchanged.
+ * \return
+ * false is returned if sizes of \a input and \a output mismatch with
+ * \a dn or it fails to allocate internal workspace. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzDenseNetPropagateBatch(nzDenseNet *dn, zMat input, zMat output);
+
+/*! \brief initialize gradients of weights and biases of a compiled dense-layer network. */
+__NEUZ_EXPORT void nzDenseNetInitGrad(nzDenseNet *dn);
+
+/*! \brief back-propagate loss of a batch of samples in a compiled dense-layer network.
+ *
+ * nzDenseNetBackPropagateBatch() propagates a batch of samples \a input
+ * through \a dn, and back-propagates the loss with respect to the
+ * desired outputs \a des to accumulate gradients of weights and biases.
+ * Each row of \a input and \a des is a pair of input and desired output
+ * vectors of a sample. \a lossgrad is a function to compute the i-th
+ * component of the gradient of the loss function, e.g.
+ * nzLossGradSquareSum().
+ * Gradients of layers are computed by matrix-matrix products over the
+ * batch, and are added to those already accumulated. The result is
+ * identical with the sum of gradients computed by nzNetBackPropagate()
+ * for each sample up to rounding errors.
+ * Workspace for the batch is kept in \a dn and is reallocated only
+ * when a larger batch is given, so that no memory is allocated in
+ * training steps with a fixed batch size.
+ * \return
+ * false is returned if sizes of \a input and \a des mismatch with \a dn
+ * or it fails to allocate internal workspace. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzDenseNetBackPropagateBatch(nzDenseNet *dn, zMat input, zMat des, double (* lossgrad)(zVec,zVec,int));
+
+/*! \brief back-propagate loss of a batch of samples stored in arrays in a compiled dense-layer network.
+ *
+ * nzDenseNetBackPropagateBatchNC() is the same with
+ * nzDenseNetBackPropagateBatch() except that a batch of \a n samples
+ * is given by row-major arrays \a input and \a des, and their sizes
+ * are not checked.
+ */
+__NEUZ_EXPORT bool nzDenseNetBackPropagateBatchNC(nzDenseNet *dn, const double *input, const double *des, int n, double (* lossgrad)(zVec,zVec,int));
+
+/*! \brief train a compiled dense-layer network based on the steepest descent method. */
+__NEUZ_EXPORT void nzDenseNetTrainSDM(nzDenseNet *dn, double rate);
+
+/* binary file */
+
+/*! \brief version of the binary file format of compiled dense-layer networks */
+#define NZ_DENSE_BINARY_VERSION 1
+
+/*! \brief alignment of weights and biases in a binary file in bytes */
+#define NZ_DENSE_BINARY_ALIGN 64
+
+/*! \brief write a compiled dense-layer network to a binary file.
+ *
+ * nzDenseNetWriteBinary() writes the topology, activator functions,
+ * weights and biases of \a dn to a file \a filename in the binary
+ * format of version NZ_DENSE_BINARY_VERSION. The file consists of
+ *  - a header, which contains a magic string, the version, a byte-order
+ *    mark, the size of nzReal in bytes, the number of layers, the number
+ *    of weights and biases, and the offset of them from the head,
+ *  - sizes and the name of the activator function of each layer, and
+ *  - weights and biases of layers in the same layout with _param of
+ *    \a dn, aligned at NZ_DENSE_BINARY_ALIGN bytes.
+ * Weights and biases are stored as nzReal in the native byte order, so
+ * that a file has to be read by neuZ built in the same precision on a
+ * processor with the same byte order.
+ * \return
+ * false is returned if it fails to write the file. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzDenseNetWriteBinary(nzDenseNet *dn, const char filename[]);
+
+/*! \brief read a compiled dense-layer network from a binary file.
+ *
+ * nzDenseNetReadBinary() reads a file \a filename written by
+ * nzDenseNetWriteBinary() to \a dn. Weights and biases are copied to
+ * a buffer allocated in the heap.
+ * \return
+ * a pointer \a dn is returned if it succeeds. If it fails to read the
+ * file, or the file is broken, of another version or in another
+ * precision, the null pointer is returned.
+ */
+__NEUZ_EXPORT nzDenseNet *nzDenseNetReadBinary(nzDenseNet *dn, const char filename[]);
+
+/*! \brief map a binary file of a compiled dense-layer network to memory.
+ *
+ * nzDenseNetMapBinary() maps a file \a filename written by
+ * nzDenseNetWriteBinary() to memory, and lets \a dn refer to weights
+ * and biases in the mapped region without parsing or copying them.
+ * Pages of the file are loaded on demand and are shared with other
+ * processes that map the same file. The mapping is private, so that
+ * the file is not modified even if \a dn is trained; modified pages
+ * are copied on write.
+ * The mapping is released by nzDenseNetDestroy(). On systems without
+ * mmap(), it is the same with nzDenseNetReadBinary().
+ * \return
+ * a pointer \a dn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzDenseNet *nzDenseNetMapBinary(nzDenseNet *dn, const char filename[]);
+
+#ifdef __cplusplus
+inline void nzDenseNet::init(){ nzDenseNetInit( this ); }
+inline void nzDenseNet::destroy(){ nzDenseNetDestroy( this ); }
+inline int nzDenseNet::inputSize() const { return nzDenseNetInputSize( this ); }
+inline int nzDenseNet::outputSize() const { return nzDenseNetOutputSize( this ); }
+inline nzDenseNet *nzDenseNet::compile(nzNet *net){ return nzDenseNetCompile( this, net ); }
+inline nzDenseNet *nzDenseNet::share(nzDenseNet *src){ return nzDenseNetShare( this, src ); }
+inline bool nzDenseNet::copyToNet(nzNet *net){ return nzDenseNetCopyToNet( this, net ); }
+inline bool nzDenseNet::addGradToNet(nzNet *net){ return nzDenseNetAddGradToNet( this, net ); }
+inline bool nzDenseNet::setInput(zVec input){ return nzDenseNetSetInput( this, input ); }
+inline bool nzDenseNet::getOutput(zVec output){ return nzDenseNetGetOutput( this, output ); }
+inline bool nzDenseNet::propagate(zVec input){ return nzDenseNetPropagate( this, input ); }
+inline bool nzDenseNet::propagateBatch(zMat input, zMat output){ return nzDenseNetPropagateBatch( this, input, output ); }
+inline void nzDenseNet::initGrad(){ nzDenseNetInitGrad( this ); }
+inline bool nzDenseNet::backpropagateBatch(zMat input, zMat des, double (* lossgrad)(zVec,zVec,int)){ return nzDenseNetBackPropagateBatch( this, input, des, lossgrad ); }
+inline void nzDenseNet::trainSDM(double rate){ nzDenseNetTrainSDM( this, rate ); }
+inline bool nzDenseNet::writeBinary(const char filename[]){ return nzDenseNetWriteBinary( this, filename ); }
+inline nzDenseNet *nzDenseNet::readBinary(const char filename[]){ return nzDenseNetReadBinary( this, filename ); }
+inline nzDenseNet *nzDenseNet::mapBinary(const char filename[]){ return nzDenseNetMapBinary( this, filename ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_DENSE_H__ */
@@ -21,12 +21,63 @@ __BEGIN_DECLS
 
 #define NEUZ_ERR_NEURON_NOT_FOUND "neuron %d:%d not found"
 
+#define NEUZ_ERR_NET_CYCLIC "cyclic connection through neuron %d:%d"
+#define NEUZ_ERR_NET_CSR_INVALID_GROUP "neuron group %d cannot be compiled into compressed sparse rows"
+#define NEUZ_ERR_NET_CSR_INVALID_AXON "axon from neuron group %d to %d cannot be compiled into compressed sparse rows"
+
+#define NEUZ_ERR_DENSE_TOOFEWLAYER "cannot compile a one-or-less-layered network."
+#define NEUZ_ERR_DENSE_INVALID_GROUP "neuron group %d cannot be compiled into a dense layer"
+#define NEUZ_ERR_DENSE_MISMATCH "topology mismatch between a network and a compiled network"
+
+#define NEUZ_ERR_BINARY_INVALID "%s: not a binary file of a compiled network, or broken"
+#define NEUZ_ERR_BINARY_VERSION "%s: unsupported version %d of a binary file"
+#define NEUZ_ERR_BINARY_PRECISION "%s: precision or byte order mismatch of a binary file"
+#define NEUZ_ERR_BINARY_WRITE "%s: cannot write a binary file"
+
+#define NEUZ_ERR_FROZEN_TOOFEWLAYER "cannot freeze a one-or-less-layered network."
+#define NEUZ_ERR_FROZEN_TOOMANYACTIVATOR "too many activator functions to freeze (more than %d)"
+
+#define NEUZ_ERR_QUANT_GRANULARITY "unknown granularity of quantization: %d"
+#define NEUZ_ERR_QUANT_MISMATCH "topology mismatch between a quantized network and a network"
+
+#define NEUZ_ERR_SPARSE_TOOFEWLAYER "cannot compile a one-or-less-layered network into a sparse network."
+#define NEUZ_ERR_SPARSE_MISMATCH "topology mismatch between a sparse network and a network"
+
+#define NEUZ_ERR_FIXED_MISMATCH "topology mismatch between a fixed-topology network and a network"
+
+#define NEUZ_ERR_OPTIMIZER_UNKNOWN "unknown optimizer type: %d"
+#define NEUZ_ERR_OPTIMIZER_MISMATCH "size mismatch between parameters (%d) and an optimizer (%d)"
+
+#define NEUZ_ERR_THREAD_CREATE "cannot create a thread"
+
+#define NEUZ_ERR_DATASET_INVALID_SIZE "invalid sizes of a dataset: %d inputs, %d outputs, %d bytes per element"
+#define NEUZ_ERR_DATASET_WRITE "%s: cannot write a dataset file"
+#define NEUZ_ERR_DATASET_TEXT "%s:%ld: not %d values in a line"
+#define NEUZ_ERR_DATASET_INVALID "%s: not a dataset file, or broken"
+#define NEUZ_ERR_DATASET_VERSION "%s: unsupported version %d of a dataset file"
+#define NEUZ_ERR_DATASET_BYTEORDER "%s: byte order mismatch of a dataset file"
+
+#define NEUZ_ERR_PIPELINE_INVALID_SIZE "invalid sizes of a pipeline: %d samples per batch, %d batches, %d threads"
+
+#define NEUZ_ERR_SERVE_PATH "%s: too long path of a socket"
+#define NEUZ_ERR_SERVE_CONNECT "%s: cannot connect to the inference server"
+#define NEUZ_ERR_SERVE_DISCONNECT "disconnected from the inference server"
+#define NEUZ_ERR_SERVE_FAILED "the inference server failed: %s"
+#define NEUZ_ERR_SERVE_PROTOCOL "unexpected response from the inference server"
+#define NEUZ_ERR_SERVE_TOOLONG "too long message (%lu bytes) of the inference server"
+
 /* warning messages */
 
 #define NEUZ_WARN_GROUP_MISMATCH_SIZ "size mismatch between a neuron group (%d) and a vector (%d)"
+#define NEUZ_WARN_NET_MISMATCH_GRAD "size mismatch between parameters of a network (%d) and a vector of gradients (%d)"
+
+#define NEUZ_WARN_BATCH_MISMATCH_SIZ "size mismatch between a network (%d) and a batch (%d x %d)"
 
 #define NEUZ_WARN_NET_TOOFEWLAYER "cannot apply backpropagation to a two-or-less-layered network."
 
+#define NEUZ_WARN_DATASET_OUTOFRANGE "sample %lu out of range of a dataset (%lu samples)"
+#define NEUZ_WARN_DATASET_MISMATCH "size mismatch between a dataset and a batch"
+
 __END_DECLS
 
 #endif /* __NEUZ_ERRMSG_H__ */
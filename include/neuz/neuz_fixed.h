@@ -0,0 +1,298 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_fixed.h
+ * \brief fixed-topology neural network for C++.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_FIXED_H__
+#define __NEUZ_FIXED_H__
+
+#ifndef __cplusplus
+#error neuz_fixed.h is only for C++.
+#endif /* __cplusplus */
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <neuz/neuz_neuron.h>
+#include <neuz/neuz_errmsg.h>
+
+/*! \brief inlined activator functions of fixed-topology networks
+ *
+ * each class provides a function f, which is identical with that of
+ * the corresponding activator of the library, and activator() that
+ * returns the activator to be assigned to a network.
+ */
+struct nzFixedIdent{
+  static nzActivator *activator(){ return &nz_activator_ident; }
+  template<typename T> static T f(T x){ return x; }
+};
+struct nzFixedStep{
+  static nzActivator *activator(){ return &nz_activator_step; }
+  template<typename T> static T f(T x){ return x >= 0 ? 1 : 0; }
+};
+struct nzFixedSigmoid{
+  static nzActivator *activator(){ return &nz_activator_sigmoid; }
+  template<typename T> static T f(T x){ return 1 / ( 1 + std::exp( -4*x ) ); }
+};
+struct nzFixedReLU{
+  static nzActivator *activator(){ return &nz_activator_relu; }
+  template<typename T> static T f(T x){ return x > 0 ? x : 0; }
+};
+struct nzFixedBluntReLU{
+  static nzActivator *activator(){ return &nz_activator_blunt_relu; }
+  template<typename T> static T f(T x){ return 0.5 * ( x + std::sqrt( x*x + 1 ) ); }
+};
+struct nzFixedSoftplus{
+  static nzActivator *activator(){ return &nz_activator_softplus; }
+  template<typename T> static T f(T x){ return std::log( 1 + std::exp( x ) ); }
+};
+
+/*! \brief descriptor of a layer of a fixed-topology network
+ *
+ * \a N is the number of neurons of the layer, and \a Activator is one
+ * of the activator classes above.
+ */
+template<std::size_t N, class Activator = nzFixedIdent>
+struct nzFixedLayer{
+  static constexpr std::size_t size = N;
+  typedef Activator activator;
+};
+
+/*! \brief the maximum number of inputs of a layer, the loop over which is unrolled. */
+#ifndef NZ_FIXED_UNROLL_MAX
+#define NZ_FIXED_UNROLL_MAX 64
+#endif /* NZ_FIXED_UNROLL_MAX */
+
+/*! \brief weights and biases of a layer of a fixed-topology network
+ *
+ * weight[i*nout+o] is the weight of the connection from the i-th
+ * input to the o-th neuron. The layout lets the innermost loop run
+ * over neurons without a reduction, so that it is vectorized without
+ * changing the order of additions. The outer loop over inputs is fully
+ * unrolled if the number of inputs is not more than
+ * NZ_FIXED_UNROLL_MAX.
+ */
+template<typename Real, std::size_t NIn, class Layer>
+struct nzFixedLayerParam{
+  static constexpr std::size_t nin = NIn;
+  static constexpr std::size_t nout = Layer::size;
+  typedef typename Layer::activator activator;
+  alignas(32) std::array<Real,nin*nout> weight;
+  alignas(32) std::array<Real,nout> bias;
+
+  nzFixedLayerParam(){ weight.fill( 0 ); bias.fill( 0 ); }
+  Real &w(std::size_t o, std::size_t i){ return weight[i*nout+o]; }
+  const Real &w(std::size_t o, std::size_t i) const { return weight[i*nout+o]; }
+
+  template<std::size_t I> void _accumulate(Real x[], const Real input[]) const {
+    const Real u = input[I];
+    for( std::size_t o=0; o<nout; o++ ) x[o] += weight[I*nout+o] * u;
+  }
+  template<std::size_t... I> void _accumulate(Real x[], const Real input[], std::index_sequence<I...>) const {
+    ( _accumulate<I>( x, input ), ... );
+  }
+  void propagate(const Real input[], Real output[]) const {
+    alignas(32) std::array<Real,nout> x = bias;
+    if constexpr( nin <= NZ_FIXED_UNROLL_MAX ){
+      _accumulate( x.data(), input, std::make_index_sequence<nin>() );
+    } else{
+      for( std::size_t i=0; i<nin; i++ ){
+        const Real u = input[i];
+        for( std::size_t o=0; o<nout; o++ ) x[o] += weight[i*nout+o] * u;
+      }
+    }
+    for( std::size_t o=0; o<nout; o++ ) output[o] = activator::f( x[o] );
+  }
+};
+
+template<typename Real, std::size_t NIn, class... Layers>
+struct _nzFixedLayerTuple{
+  typedef std::tuple<> type;
+};
+template<typename Real, std::size_t NIn, class Layer, class... Layers>
+struct _nzFixedLayerTuple<Real,NIn,Layer,Layers...>{
+  typedef decltype( std::tuple_cat( std::declval<std::tuple<nzFixedLayerParam<Real,NIn,Layer>>>(), std::declval<typename _nzFixedLayerTuple<Real,Layer::size,Layers...>::type>() ) ) type;
+};
+
+/*! \brief fixed-topology neural network class
+ *
+ * nzFixedNet is a fully-connected layered network, the precision, the
+ * size of the input layer and the layers of which are given as
+ * template parameters, e.g.
+ *   nzFixedNet<double, 2, nzFixedLayer<5,nzFixedSigmoid>, nzFixedLayer<4,nzFixedSigmoid>>
+ * for a 2-5-4 network of sigmoid neurons. Weights, biases and outputs
+ * of layers are stored in std::array, sizes of all loops are known at
+ * compile time and activator functions are inlined, so that no memory
+ * is allocated and no function is called via pointers in propagation.
+ * It is for inference of small networks in real-time loops. Weights
+ * and biases are imported from and exported to an nzNet or a ZTK file,
+ * and a network is trained as an nzNet.
+ */
+template<typename Real, std::size_t NInput, class... Layers>
+class nzFixedNet{
+  static_assert( sizeof...(Layers) > 0, "nzFixedNet requires at least one layer except the input layer" );
+ public:
+  typedef typename _nzFixedLayerTuple<Real,NInput,Layers...>::type layer_type;
+  static constexpr std::size_t layerNum = sizeof...(Layers);
+  typedef typename std::tuple_element<layerNum-1,layer_type>::type output_layer_type;
+  typedef std::array<Real,NInput> input_type;
+  typedef std::array<Real,output_layer_type::nout> output_type;
+
+  layer_type layer;
+  std::tuple<std::array<Real,Layers::size>...> value; /* outputs of layers */
+
+  static constexpr std::size_t inputSize(){ return NInput; }
+  static constexpr std::size_t outputSize(){ return output_layer_type::nout; }
+
+  /*! \brief weights and biases of the K-th layer except the input layer. */
+  template<std::size_t K> auto &param(){ return std::get<K>( layer ); }
+  template<std::size_t K> const auto &param() const { return std::get<K>( layer ); }
+
+  /*! \brief output values of the network. */
+  const output_type &output() const { return std::get<layerNum-1>( value ); }
+
+  /*! \brief propagate input values to the output.
+   * the output values are returned, and are kept until the next call. */
+  const output_type &propagate(const Real input[]){
+    _propagate( input, std::make_index_sequence<layerNum>() );
+    return output();
+  }
+  const output_type &propagate(const input_type &input){ return propagate( input.data() ); }
+  bool propagate(zVec input, zVec output){
+    std::size_t i;
+    input_type in;
+
+    if( zVecSizeNC(input) != (int)NInput ){
+      ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, (int)NInput, zVecSizeNC(input) );
+      return false;
+    }
+    if( zVecSizeNC(output) != (int)outputSize() ){
+      ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, (int)outputSize(), zVecSizeNC(output) );
+      return false;
+    }
+    for( i=0; i<NInput; i++ ) in[i] = zVecElemNC(input,i);
+    propagate( in );
+    for( i=0; i<outputSize(); i++ ) zVecElemNC(output,i) = this->output()[i];
+    return true;
+  }
+
+  /*! \brief import weights and biases from a neural network.
+   *
+   * the network \a net has to consist of the same number of groups with
+   * the same sizes and activators, and every axon has to come from the
+   * preceding group. Missing axons are regarded as zero weights.
+   * \return
+   * false is returned if the topology of \a net does not match.
+   * Otherwise, true is returned.
+   */
+  bool fromNet(nzNet *net){
+    if( zListSize(net) != (int)layerNum + 1 || nzNetInputSize(net) != (int)NInput ){
+      ZRUNERROR( NEUZ_ERR_FIXED_MISMATCH );
+      return false;
+    }
+    return _fromNet( net, std::make_index_sequence<layerNum>() );
+  }
+
+  /*! \brief export weights and biases to a neural network.
+   *
+   * a fully-connected network is newly created in \a net.
+   * \return
+   * false is returned if it fails to allocate memory. Otherwise, true
+   * is returned.
+   */
+  bool toNet(nzNet *net) const {
+    nzNetInit( net );
+    if( !nzNetAddGroupSetActivator( net, NInput, NULL ) ||
+        !_toNet( net, std::make_index_sequence<layerNum>() ) ){
+      nzNetDestroy( net );
+      return false;
+    }
+    return true;
+  }
+
+  /*! \brief read weights and biases from a ZTK file. */
+  bool readZTK(const char filename[]){
+    nzNet net;
+    bool ret;
+
+    if( !nzNetReadZTK( &net, filename ) ) return false;
+    ret = fromNet( &net );
+    nzNetDestroy( &net );
+    return ret;
+  }
+
+  /*! \brief write weights and biases to a ZTK file. */
+  bool writeZTK(const char filename[]) const {
+    nzNet net;
+    bool ret;
+
+    if( !toNet( &net ) ) return false;
+    ret = nzNetWriteZTK( &net, filename );
+    nzNetDestroy( &net );
+    return ret;
+  }
+
+ private:
+  template<std::size_t K> const Real *_input(const Real input[]) const {
+    if constexpr( K == 0 ) return input;
+    else return std::get<K-1>( value ).data();
+  }
+  template<std::size_t... K> void _propagate(const Real input[], std::index_sequence<K...>){
+    ( std::get<K>( layer ).propagate( _input<K>( input ), std::get<K>( value ).data() ), ... );
+  }
+
+  template<std::size_t K> bool _fromNetLayer(nzNet *net){
+    auto &lp = std::get<K>( layer );
+    nzNeuronGroup *ng;
+    nzNeuron *np, *up;
+    nzAxon *ap;
+    std::size_t o;
+
+    ng = nzNetFindGroup( net, K+1 );
+    if( zListSize(&ng->list) != (int)lp.nout ) goto FAILURE;
+    lp.weight.fill( 0 );
+    for( o=0; o<lp.nout; o++ ){
+      np = ng->index[o];
+      if( np->data.activator != std::remove_reference<decltype(lp)>::type::activator::activator() ) goto FAILURE;
+      for( ap=np->data.axon; ap; ap=ap->next ){
+        up = (nzNeuron *)ap->upstream;
+        if( up->data.gid != (int)K ) goto FAILURE;
+        lp.w( o, up->data.nid ) += ap->weight;
+      }
+      lp.bias[o] = np->data.bias;
+    }
+    return true;
+   FAILURE:
+    ZRUNERROR( NEUZ_ERR_FIXED_MISMATCH );
+    return false;
+  }
+  template<std::size_t... K> bool _fromNet(nzNet *net, std::index_sequence<K...>){
+    return ( _fromNetLayer<K>( net ) && ... );
+  }
+
+  template<std::size_t K> bool _toNetLayer(nzNet *net) const {
+    const auto &lp = std::get<K>( layer );
+    nzNeuronGroup *ng;
+    std::size_t o, i;
+
+    if( !nzNetAddGroupSetActivator( net, lp.nout, std::remove_reference<decltype(lp)>::type::activator::activator() ) ) return false;
+    ng = nzNetFindGroup( net, K+1 );
+    for( o=0; o<lp.nout; o++ ){
+      for( i=0; i<lp.nin; i++ )
+        if( !nzNetConnect( net, K, i, K+1, o, lp.w( o, i ) ) ) return false;
+      ng->index[o]->data.bias = lp.bias[o];
+    }
+    return true;
+  }
+  template<std::size_t... K> bool _toNet(nzNet *net, std::index_sequence<K...>) const {
+    return ( _toNetLayer<K>( net ) && ... );
+  }
+};
+
+#endif /* __NEUZ_FIXED_H__ */
@@ -0,0 +1,116 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_frozen.h
+ * \brief frozen inference-only network.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_FROZEN_H__
+#define __NEUZ_FROZEN_H__
+
+#include <neuz/neuz_neuron.h>
+
+__BEGIN_DECLS
+
+/*! \brief maximum number of distinct activator functions of a frozen network */
+#define NZ_FROZEN_ACTIVATOR_MAX 256
+
+/*! \brief frozen inference-only network class
+ *
+ * a frozen network keeps only weights, biases, activator functions and
+ * the topology of a trained network in a compressed sparse row form.
+ * Neurons are numbered serially from the input layer to the output
+ * layer, and upstream neurons of each neuron are referred by the
+ * serial numbers. All arrays are held in a single buffer, so that a
+ * connection costs a weight and an index instead of an axon with a
+ * gradient and pointers.
+ * A frozen network is never modified after nzFrozenNetFreeze(), so
+ * that it can be shared by multiple threads each of which has its own
+ * workspace.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzFrozenNet ){
+  int ninput;                   /* number of input neurons */
+  int noutput;                  /* number of output neurons */
+  int nneuron;                  /* number of neurons except the input layer */
+  int nconn;                    /* number of connections */
+  int nactivator;               /* number of distinct activator functions */
+  nzReal *weight;               /* weights of connections */
+  nzReal *bias;                 /* biases of neurons */
+  nzActivator **activator;      /* table of activator functions */
+  int *offset;                  /* the first connection of each neuron */
+  int *upstream;                /* serial numbers of upstream neurons of connections */
+  unsigned char *activator_id;  /* activator function of each neuron in the table */
+  size_t _size;                 /* size of the buffer in bytes */
+  void *_buf;                   /* buffer of the above arrays */
+#ifdef __cplusplus
+  nzFrozenNet() : ninput{0}, noutput{0}, nneuron{0}, nconn{0}, nactivator{0}, weight{NULL}, bias{NULL}, activator{NULL}, offset{NULL}, upstream{NULL}, activator_id{NULL}, _size{0}, _buf{NULL} {}
+  void init();
+  void destroy();
+  nzFrozenNet *freeze(nzNet *net);
+  int inputSize() const;
+  int outputSize() const;
+  int workSize() const;
+  bool propagate(zVec input, zVec output, nzReal *work) const;
+#endif /* __cplusplus */
+};
+
+#define nzFrozenNetInputSize(fn)  (fn)->ninput
+#define nzFrozenNetOutputSize(fn) (fn)->noutput
+
+/*! \brief number of values a workspace of a frozen network has to hold. */
+#define nzFrozenNetWorkSize(fn) ( (fn)->ninput + (fn)->nneuron )
+
+/*! \brief size of memory held by a frozen network in bytes. */
+#define nzFrozenNetMemSize(fn) ( sizeof(nzFrozenNet) + (fn)->_size )
+
+/*! \brief initialize a frozen network. */
+__NEUZ_EXPORT void nzFrozenNetInit(nzFrozenNet *fn);
+
+/*! \brief destroy a frozen network. */
+__NEUZ_EXPORT void nzFrozenNetDestroy(nzFrozenNet *fn);
+
+/*! \brief freeze a neural network into an inference-only network.
+ *
+ * nzFrozenNetFreeze() copies weights, biases, activator functions and
+ * the topology of \a net to \a fn. \a net is not modified, and can be
+ * destroyed after it. Every axon has to come from a preceding group,
+ * neurons of the input layer must not have activators while the others
+ * must, and at most NZ_FROZEN_ACTIVATOR_MAX distinct activators can be
+ * used.
+ * \return
+ * a pointer \a fn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzFrozenNet *nzFrozenNetFreeze(nzFrozenNet *fn, nzNet *net);
+
+/*! \brief propagate input values to a frozen network to the output.
+ *
+ * nzFrozenNetPropagate() computes the output of \a fn for \a input,
+ * and stores it in \a output. The result is identical with
+ * nzNetPropagate() applied to the original network up to rounding
+ * errors. \a work is a workspace that holds nzFrozenNetWorkSize()
+ * values, which has to be distinct for each thread. If \a work is the
+ * null pointer, a workspace is allocated temporarily.
+ * \a fn is not modified, so that multiple threads can propagate
+ * different samples through the same frozen network at the same time.
+ * \return
+ * false is returned if sizes of \a input and \a output mismatch with
+ * \a fn or it fails to allocate a workspace. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzFrozenNetPropagate(const nzFrozenNet *fn, zVec input, zVec output, nzReal *work);
+
+#ifdef __cplusplus
+inline void nzFrozenNet::init(){ nzFrozenNetInit( this ); }
+inline void nzFrozenNet::destroy(){ nzFrozenNetDestroy( this ); }
+inline nzFrozenNet *nzFrozenNet::freeze(nzNet *net){ return nzFrozenNetFreeze( this, net ); }
+inline int nzFrozenNet::inputSize() const { return nzFrozenNetInputSize( this ); }
+inline int nzFrozenNet::outputSize() const { return nzFrozenNetOutputSize( this ); }
+inline int nzFrozenNet::workSize() const { return nzFrozenNetWorkSize( this ); }
+inline bool nzFrozenNet::propagate(zVec input, zVec output, nzReal *work) const { return nzFrozenNetPropagate( this, input, output, work ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_FROZEN_H__ */
@@ -13,4 +13,15 @@
 #include <neuz/neuz_export.h>
 #include <neuz/neuz_errmsg.h>
 
+/* uncomment the following line to store weights, biases and values of
+ * compiled networks in single-precision floating-point numbers. */
+/* #define __NEUZ_FLOAT32__ */
+
+/*! \brief real number type of compiled networks */
+#ifdef __NEUZ_FLOAT32__
+typedef float nzReal;
+#else
+typedef double nzReal;
+#endif /* __NEUZ_FLOAT32__ */
+
 #endif /* __NEUZ_MISC_H__ */
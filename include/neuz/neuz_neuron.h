@@ -10,6 +10,9 @@
 #define __NEUZ_NEURON_H__
 
 #include <neuz/neuz_activator.h>
+#include <neuz/neuz_arena.h>
+#include <neuz/neuz_thread.h>
+#include <neuz/neuz_stats.h>
 
 __BEGIN_DECLS
 
@@ -34,6 +37,7 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNeuronData ){
   double _v;
   nzActivator *activator;
   nzAxon *axon;
+  nzArena *arena; /* allocator of axons (the heap if null) */
 };
 
 /*! \brief neuron list class */
@@ -57,7 +61,12 @@ __NEUZ_EXPORT nzNeuron *nzNeuronInit(nzNeuron *neuron, int gid, int nid);
 /*! \brief destroy a neuron unit. */
 __NEUZ_EXPORT void nzNeuronDestroy(nzNeuron *neuron);
 
-/*! \brief connect two neuron units. */
+/*! \brief connect two neuron units.
+ *
+ * nzNeuronConnect() makes an axon from \a nu to \a nd with a weight
+ * \a weight. The axon is allocated from the arena of \a nd if it is
+ * assigned, or from the heap otherwise.
+ */
 __NEUZ_EXPORT bool nzNeuronConnect(nzNeuron *nu, nzNeuron *nd, double weight);
 
 /*! \brief propagate output values of upstream units to downstream. */
@@ -87,6 +96,9 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNeuronList ){
 ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNeuronGroup ){
   int id; /* identifier */
   nzNeuronList list;
+  nzArena *arena; /* allocator of neurons and axons (the heap if null) */
+  int capacity;   /* number of neurons the index can hold */
+  nzNeuron **index; /* neurons indexed by identifiers */
 #ifdef __cplusplus
   nzNeuronGroup *init(int id);
   bool add();
@@ -104,16 +116,35 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNeuronGroup ){
 /*! \brief initialize a neuron group. */
 __NEUZ_EXPORT nzNeuronGroup *nzNeuronGroupInit(nzNeuronGroup *ng, int id);
 
-/*! \brief add a neuron into a group. */
+/*! \brief add a neuron into a group.
+ *
+ * nzNeuronGroupAddOne() allocates a new neuron from the arena of \a ng
+ * if it is assigned, or from the heap otherwise. Axons to the neuron
+ * are allocated from the same arena.
+ * The identifier of the new neuron is the number of neurons in \a ng
+ * before addition, and the neuron is registered in the index of \a ng.
+ */
 __NEUZ_EXPORT bool nzNeuronGroupAddOne(nzNeuronGroup *ng);
 
-/*! \brief add multiple neurons into a group. */
+/*! \brief add multiple neurons into a group.
+ *
+ * nzNeuronGroupAdd() reserves the index of \a ng for \a num neurons
+ * at once before adding them.
+ */
 __NEUZ_EXPORT bool nzNeuronGroupAdd(nzNeuronGroup *ng, int num);
 
 /*! \brief destroy a neuron group. */
 __NEUZ_EXPORT void nzNeuronGroupDestroy(nzNeuronGroup *ng);
 
-/*! \brief find a neuron in a neuron group. */
+/*! \brief find a neuron in a neuron group.
+ *
+ * nzNeuronGroupFindNeuron() looks up the index of \a ng, so that it
+ * takes a constant time regardless of the size of \a ng.
+ * \return
+ * the neuron with the identifiers \a gid and \a nid is returned. If
+ * \a gid is not the identifier of \a ng or \a nid is out of range,
+ * the null pointer is returned.
+ */
 __NEUZ_EXPORT nzNeuron *nzNeuronGroupFindNeuron(nzNeuronGroup *ng, int gid, int nid);
 
 /*! \brief set activator functions of units in a neuron group. */
@@ -144,7 +175,7 @@ inline void nzNeuronGroup::propagate(){ nzNeuronGroupPropagate( this ); }
 inline void nzNeuronGroup::fprint(FILE *fp){ nzNeuronGroupFPrint( fp, this ); }
 #endif /* __cplusplus */
 
-/*! \brief neural network class */
+/*! \brief neuron group list class */
 ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetCell ){
   nzNetCell *prev, *next;
   nzNeuronGroup data;
@@ -153,13 +184,61 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetCell ){
 #endif /* __cplusplus */
 };
 
+/*! \brief workspace of a neural network for parallel computation */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetParallel ){
+  nzThreadPool *pool; /* thread pool (not owned by the network) */
+  int threshold;      /* minimum number of neurons of a group to be processed in parallel */
+  int nworker;        /* number of workers the following buffers can hold */
+  int ngroup;         /* number of groups the following buffers can hold */
+  int nneuron;        /* number of neurons the following buffers can hold */
+  int *offset;        /* serial number of the first neuron of each group */
+  nzNeuron **neuron;  /* neurons in serial order */
+  double *p;          /* loss gradients of upstream neurons accumulated by each worker */
+  int *range;         /* range of serial numbers of neurons touched by each worker */
+};
+
+/*! \brief topological schedule of neurons of a neural network
+ *
+ * neurons are sorted in the order of dependency levels, which are
+ * the lengths of the longest paths from neurons without upstream
+ * neurons. Neurons of a level do not depend on each other, and those
+ * of a level are sorted in the order of groups and identifiers.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetSchedule ){
+  bool valid;         /* whether the schedule is up to date with the topology */
+  bool grouped;       /* whether levels coincide with groups in order */
+  int nneuron;        /* number of neurons */
+  int nlevel;         /* number of dependency levels */
+  nzNeuron **neuron;  /* neurons in topological order */
+  int *level;         /* index of the first neuron of each level, followed by nneuron */
+};
+
+/*! \brief neural network class
+ *
+ * neuron groups, neurons and axons of a neural network are allocated
+ * from its own arena, and are released at once by nzNetDestroy().
+ * Identifiers of groups and neurons are serial numbers from zero, and
+ * groups and neurons are indexed by them in arrays, which are looked
+ * up by nzNetFindGroup() and nzNetFindNeuron().
+ * Neurons are propagated in the topological order derived from axons,
+ * so that any neuron can be connected to any other, e.g. across groups
+ * to skip layers, unless the connections make a cycle.
+ */
 ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNet ){
   int size;
   nzNetCell root;
+  nzArena arena;
+  int capacity;          /* number of groups the index can hold */
+  nzNeuronGroup **index; /* neuron groups indexed by identifiers */
+  nzNetParallel parallel;
+  nzNetSchedule schedule;
+  nzNetStats *stats;     /* statistics of computation (not owned by the network) */
 #ifdef __cplusplus
-  nzNet() : size{0} {}
+  nzNet();
   void init();
   void destroy();
+  void setThreadPool(nzThreadPool *pool);
+  bool setStats(nzNetStats *stats);
   nzNeuronGroup *inputLayer();
   nzNeuronGroup *outputLayer();
   int inputSize() const;
@@ -177,6 +256,9 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNet ){
   void initGrad();
   bool backpropagate(zVec input, zVec des, double (* lossgrad)(zVec,zVec,int));
   bool trainSDM(double rate);
+  int numParam();
+  bool getGrad(zVec grad);
+  bool topoSort();
   void fprint(FILE *fp);
 
   nzNet *fromZTK(ZTK *ztk);
@@ -193,7 +275,49 @@ ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNet ){
 #define nzNetOutputSize(net) zListSize( &nzNetOutputLayer(net)->list )
 
 /*! \brief initialize a neural network. */
-#define nzNetInit(net) zListInit( net )
+__NEUZ_EXPORT void nzNetInit(nzNet *net);
+
+/*! \brief default minimum number of neurons of a group to be processed in parallel. */
+#define NZ_NET_PARALLEL_THRESHOLD 128
+
+/*! \brief attach a thread pool to a neural network.
+ *
+ * nzNetSetThreadPool() lets \a net use \a pool in nzNetPropagate()
+ * and nzNetBackPropagate(). Neurons of each dependency level (see
+ * nzNetTopoSort()) are split into chunks, which are processed by
+ * workers of \a pool in parallel, and the next level is processed
+ * after all chunks are finished. Levels with less neurons than
+ * parallel.threshold of \a net, which is set for
+ * NZ_NET_PARALLEL_THRESHOLD by default, are processed serially.
+ * In back-propagation, loss gradients of upstream neurons are
+ * accumulated in a buffer of each worker, and are summed up in the
+ * order of workers.
+ * \a pool is not destroyed with \a net. If \a pool is the null
+ * pointer, the parallel computation is disabled.
+ */
+__NEUZ_EXPORT void nzNetSetThreadPool(nzNet *net, nzThreadPool *pool);
+
+/*! \brief attach statistics to a neural network.
+ *
+ * nzNetSetStats() allocates \a stats for groups of \a net, and lets
+ * \a net record wall time, the number of calls and the number of
+ * multiply-add operations of each group in nzNetPropagate(),
+ * nzNetBackPropagate(), nzNetBackPropagateWorkspace() and
+ * nzNetTrainSDM(). The sizes and the activator of each group are
+ * stored when attached, so that \a stats has to be attached again
+ * if the structure of \a net is modified. Propagation and
+ * back-propagation are recorded only if dependency levels of neurons
+ * coincide with groups (see nzNetTopoSort()).
+ * \a stats has to be initialized by nzNetStatsInit() before the first
+ * attachment, and is not destroyed with \a net. If \a stats is the null
+ * pointer, the recording is disabled, which costs only a branch per
+ * group. The recording is removed at compile time if __NEUZ_NO_STATS__
+ * is defined.
+ * \return
+ * false is returned if it fails to allocate \a stats. Otherwise, true
+ * is returned.
+ */
+__NEUZ_EXPORT bool nzNetSetStats(nzNet *net, nzNetStats *stats);
 
 /*! \brief add a neuron group to a neural network. */
 __NEUZ_EXPORT bool nzNetAddGroup(nzNet *net, int num);
@@ -204,13 +328,28 @@ __NEUZ_EXPORT bool nzNetAddGroupSetActivator(nzNet *net, int num, nzActivator *a
 /*! \brief destroy a neural network. */
 __NEUZ_EXPORT void nzNetDestroy(nzNet *net);
 
-/*! \brief find a neuron group in a neural network. */
+/*! \brief find a neuron group in a neural network.
+ *
+ * nzNetFindGroup() looks up the index of \a net in a constant time.
+ * \return
+ * the group with the identifier \a id is returned. If \a id is out
+ * of range, the null pointer is returned.
+ */
 __NEUZ_EXPORT nzNeuronGroup *nzNetFindGroup(nzNet *net, int id);
 
-/*! \brief add a neuron to a neural network. */
+/*! \brief add a neuron to a neural network.
+ *
+ * nzNetAddNeuron() sets the activator and the bias of the neuron with
+ * the identifiers \a gid and \a nid. If the group or the neuron does
+ * not exist, groups and neurons are added up to them.
+ */
 __NEUZ_EXPORT bool nzNetAddNeuron(nzNet *net, int gid, int nid, nzActivator *activator, double bias);
 
-/*! \brief find a neuron in a neural network. */
+/*! \brief find a neuron in a neural network.
+ *
+ * nzNetFindNeuron() looks up indices of \a net and the group in a
+ * constant time.
+ */
 __NEUZ_EXPORT nzNeuron *nzNetFindNeuron(nzNet *net, int gid, int nid);
 
 /*! \brief connect two neuron groups in a neural network. */
@@ -219,6 +358,29 @@ __NEUZ_EXPORT bool nzNetConnectGroup(nzNet *net, int iu, int id);
 /*! \brief connects two neurons in a neural network. */
 __NEUZ_EXPORT bool nzNetConnect(nzNet *net, int ugid, int unid, int dgid, int dnid, double weight);
 
+/*! \brief sort neurons of a neural network topologically.
+ *
+ * nzNetTopoSort() sorts neurons of \a net in the order of dependency
+ * levels derived from axons, and stores the result in schedule of
+ * \a net. Neurons without upstream neurons, e.g. those of the input
+ * layer, are at level zero, and a neuron is at the level next to the
+ * highest one of its upstream neurons. nzNetPropagate() processes
+ * levels in the ascending order, and nzNetBackPropagate() does in the
+ * descending order, so that the result does not depend on the order of
+ * groups. Independent neurons of a level, which may belong to different
+ * groups, e.g. parallel branches, are processed in parallel if a thread
+ * pool is attached.
+ * It is called by nzNetPropagate() and nzNetContextAlloc() if the
+ * topology was modified by functions of \a net, e.g. nzNetConnect(), so
+ * that it has to be called explicitly only if neurons are connected by
+ * nzNeuronConnect() directly.
+ * \return
+ * false is returned if connections of \a net make a cycle, which is
+ * reported with a neuron on it, or it fails to allocate memory.
+ * Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzNetTopoSort(nzNet *net);
+
 /*! \brief set input values to the input layer of a neural network. */
 __NEUZ_EXPORT bool nzNetSetInput(nzNet *net, zVec input);
 
@@ -231,12 +393,206 @@ __NEUZ_EXPORT double nzNetPropagate(nzNet *net, zVec input);
 /*! \brief initialize gradients of weights and bias of a neural network. */
 __NEUZ_EXPORT void nzNetInitGrad(nzNet *net);
 
-/*! \brief back-propagate loss and train a neural network. */
+/*! \brief back-propagate loss and train a neural network.
+ *
+ * nzNetBackPropagate() propagates \a input through \a net, and
+ * back-propagates the loss with respect to the desired output \a des
+ * to accumulate gradients of weights and biases. It allocates a
+ * temporary vector at every call. nzNetBackPropagateWorkspace() is
+ * recommended for online learning loops.
+ */
 __NEUZ_EXPORT bool nzNetBackPropagate(nzNet *net, zVec input, zVec des, double (* lossgrad)(zVec,zVec,int));
 
+/*! \brief workspace of a neural network for back-propagation */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetWorkspace ){
+  zVec output; /* output values of the network */
+#ifdef __cplusplus
+  nzNetWorkspace() : output{NULL} {}
+  nzNetWorkspace *alloc(nzNet *net);
+  void destroy();
+#endif /* __cplusplus */
+};
+
+/*! \brief allocate a workspace of a neural network for back-propagation.
+ *
+ * nzNetWorkspaceAlloc() allocates \a ws for \a net. If a thread pool
+ * is attached to \a net, buffers for parallel back-propagation are
+ * also allocated here.
+ * \return
+ * a pointer \a ws is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzNetWorkspace *nzNetWorkspaceAlloc(nzNetWorkspace *ws, nzNet *net);
+
+/*! \brief destroy a workspace of a neural network. */
+__NEUZ_EXPORT void nzNetWorkspaceDestroy(nzNetWorkspace *ws);
+
+/*! \brief back-propagate loss of the last propagation in a neural network.
+ *
+ * nzNetBackPropagateWorkspace() back-propagates the loss of the output
+ * of \a net with respect to the desired output \a des, and accumulates
+ * gradients of weights and biases. Unlike nzNetBackPropagate(), it
+ * does not propagate an input again, but uses states of neurons left
+ * by the last call of nzNetPropagate(). \a ws has to be allocated for
+ * \a net by nzNetWorkspaceAlloc() in advance, so that a training step
+ * composed of nzNetPropagate(), nzNetBackPropagateWorkspace() and
+ * nzNetTrainSDM() does not allocate any memory.
+ * \return
+ * false is returned if \a net has two or less layers, or the size of
+ * \a des mismatches with the output of \a net. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzNetBackPropagateWorkspace(nzNet *net, nzNetWorkspace *ws, zVec des, double (* lossgrad)(zVec,zVec,int));
+
+/*! \brief activation context of a neural network
+ *
+ * a context holds transient states of neurons of a network, namely,
+ * inputs, outputs, loss gradients and derivatives of activators, and
+ * gradients of weights and biases, in arrays apart from the network.
+ * Neurons are numbered serially in the order of groups, and axons in
+ * the order of neurons. Propagation and back-propagation with a
+ * context only read weights, biases and the topology of the network,
+ * so that threads with their own contexts run them on the same
+ * network at once without any lock.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetContext ){
+  nzNet *net;          /* network (not owned by the context) */
+  int nneuron;         /* number of neurons */
+  int naxon;           /* number of axons */
+  int *offset;         /* serial number of the first neuron of each group */
+  int *axon_offset;    /* serial number of the first axon of each neuron */
+  int *upstream;       /* serial number of the upstream neuron of each axon */
+  double *input;       /* weighted sums of upstream outputs */
+  double *output;      /* output values */
+  double *_p;          /* loss gradients */
+  double *_v;          /* derivatives of activators */
+  double *_db;         /* gradients of biases */
+  double *_dw;         /* gradients of weights */
+  zVec _output;        /* output values passed to a loss gradient function */
+#ifdef __cplusplus
+  nzNetContext() : net{NULL}, nneuron{0}, naxon{0}, offset{NULL}, axon_offset{NULL}, upstream{NULL}, input{NULL}, output{NULL}, _p{NULL}, _v{NULL}, _db{NULL}, _dw{NULL}, _output{NULL} {}
+  nzNetContext *alloc(nzNet *net);
+  void destroy();
+  bool setInput(zVec input);
+  bool getOutput(zVec output);
+  bool propagate(zVec input);
+  void initGrad();
+  bool backpropagate(zVec des, double (* lossgrad)(zVec,zVec,int));
+  void addGradToNet();
+#endif /* __cplusplus */
+};
+
+/*! \brief allocate an activation context of a neural network.
+ *
+ * nzNetContextAlloc() allocates \a ctx for the current topology of
+ * \a net. Groups, neurons and axons must not be added to or removed
+ * from \a net until \a ctx is destroyed.
+ * \return
+ * a pointer \a ctx is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzNetContext *nzNetContextAlloc(nzNetContext *ctx, nzNet *net);
+
+/*! \brief destroy an activation context of a neural network. */
+__NEUZ_EXPORT void nzNetContextDestroy(nzNetContext *ctx);
+
+/*! \brief set input values to an activation context. */
+__NEUZ_EXPORT bool nzNetContextSetInput(nzNetContext *ctx, zVec input);
+
+/*! \brief get output values from an activation context. */
+__NEUZ_EXPORT bool nzNetContextGetOutput(nzNetContext *ctx, zVec output);
+
+/*! \brief propagate input values to the output in an activation context.
+ *
+ * nzNetContextPropagate() does the same with nzNetPropagate(), while
+ * states of neurons are stored in \a ctx instead of the network. If
+ * \a input is the null pointer, the input values already set in
+ * \a ctx are propagated. The result is identical with nzNetPropagate().
+ * It is safe to call it from threads with different contexts of the
+ * same network at once, unless the network is modified meanwhile.
+ * \return
+ * false is returned if the size of \a input mismatches with the
+ * network. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzNetContextPropagate(nzNetContext *ctx, zVec input);
+
+/*! \brief initialize gradients of weights and biases in an activation context. */
+__NEUZ_EXPORT void nzNetContextInitGrad(nzNetContext *ctx);
+
+/*! \brief back-propagate loss of the last propagation in an activation context.
+ *
+ * nzNetContextBackPropagate() back-propagates the loss of the output
+ * left in \a ctx by nzNetContextPropagate() with respect to the
+ * desired output \a des, and accumulates gradients of weights and
+ * biases in \a ctx. Threads with their own contexts can back-propagate
+ * samples on the same network at once, and then gradients of contexts
+ * are added to the network by nzNetContextAddGradToNet().
+ * \return
+ * false is returned if the network has two or less layers, or the size
+ * of \a des mismatches with the output of the network. Otherwise, true
+ * is returned.
+ */
+__NEUZ_EXPORT bool nzNetContextBackPropagate(nzNetContext *ctx, zVec des, double (* lossgrad)(zVec,zVec,int));
+
+/*! \brief add gradients of an activation context to the network.
+ *
+ * nzNetContextAddGradToNet() adds gradients of weights and biases
+ * accumulated in \a ctx to those of the network, which are used by
+ * nzNetTrainSDM(). It modifies the network, so that it must not be
+ * called from threads at once.
+ */
+__NEUZ_EXPORT void nzNetContextAddGradToNet(nzNetContext *ctx);
+
 /*! \brief train a neural network based on the steepest descent method. */
 __NEUZ_EXPORT bool nzNetTrainSDM(nzNet *net, double rate);
 
+/*! \brief number of weights and biases of a neural network to be trained.
+ *
+ * nzNetNumParam() counts weights of axons and biases of neurons in
+ * \a net except the input layer, which are updated by nzNetTrainSDM().
+ */
+__NEUZ_EXPORT int nzNetNumParam(nzNet *net);
+
+/*! \brief get gradients of weights and biases of a neural network.
+ *
+ * nzNetGetGrad() copies gradients of weights and biases accumulated in
+ * \a net to \a grad in the same order with nzNetTrainSDM(), namely,
+ * gradients of weights of axons of a neuron followed by that of its
+ * bias. The size of \a grad has to be nzNetNumParam().
+ * \return
+ * false is returned if the size of \a grad mismatches. Otherwise,
+ * true is returned.
+ */
+__NEUZ_EXPORT bool nzNetGetGrad(nzNet *net, zVec grad);
+
+/*! \brief number of axons of a neural network. */
+__NEUZ_EXPORT int nzNetNumConnection(nzNet *net);
+
+/*! \brief convert a neural network to compressed sparse rows.
+ *
+ * nzNetCountCSR() counts neurons except the input layer and axons of
+ * \a net, and stores them to \a nneuron and \a nconn, respectively.
+ * It also checks if \a net can be converted to compressed sparse rows,
+ * namely, the input layer has no activator functions, the other
+ * neurons have activator functions, and every axon comes from a group
+ * preceding the downstream group.
+ *
+ * nzNetToCSR() converts \a net checked by nzNetCountCSR() to compressed
+ * sparse rows, where neurons except the input layer are serially
+ * numbered in the order of groups. \a bias, \a activator and \a offset
+ * are arrays of nneuron, nneuron and nneuron+1 elements, respectively,
+ * and the connections of the i-th neuron are stored from offset[i] to
+ * offset[i+1]-1 of \a upstream and \a weight of nconn elements, where
+ * upstream neurons are serially numbered including the input layer.
+ * \a activator can be the null pointer if not needed.
+ * \return
+ * nzNetCountCSR() returns false if \a net cannot be converted to
+ * compressed sparse rows. nzNetToCSR() returns false if it fails to
+ * allocate internal workspace. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzNetCountCSR(nzNet *net, int *nneuron, int *nconn);
+__NEUZ_EXPORT bool nzNetToCSR(nzNet *net, int offset[], int upstream[], nzReal weight[], nzReal bias[], nzActivator *activator[]);
+
 /*! \brief print a neural network. */
 __NEUZ_EXPORT void nzNetFPrint(FILE *fp, nzNet *net);
 
@@ -260,8 +616,11 @@ __NEUZ_EXPORT void nzNetFPrintZTK(FILE *fp, nzNet *net);
 __NEUZ_EXPORT bool nzNetWriteZTK(nzNet *net, const char filename[]);
 
 #ifdef __cplusplus
+inline nzNet::nzNet(){ nzNetInit( this ); }
 inline void nzNet::init(){ nzNetInit( this ); }
 inline void nzNet::destroy(){ nzNetDestroy( this ); }
+inline void nzNet::setThreadPool(nzThreadPool *pool){ nzNetSetThreadPool( this, pool ); }
+inline bool nzNet::setStats(nzNetStats *stats){ return nzNetSetStats( this, stats ); }
 inline nzNeuronGroup *nzNet::inputLayer(){ return nzNetInputLayer( this ); }
 inline nzNeuronGroup *nzNet::outputLayer(){ return nzNetOutputLayer( this ); }
 inline int nzNet::inputSize() const { return nzNetInputSize( this ); }
@@ -279,7 +638,20 @@ inline double nzNet::propagate(zVec input){ return nzNetPropagate( this, input )
 inline void nzNet::initGrad(){ nzNetInitGrad( this ); }
 inline bool nzNet::backpropagate(zVec input, zVec des, double (* lossgrad)(zVec,zVec,int)){ return nzNetBackPropagate( this, input, des, lossgrad ); }
 inline bool nzNet::trainSDM(double rate){ return nzNetTrainSDM( this, rate ); }
+inline int nzNet::numParam(){ return nzNetNumParam( this ); }
+inline bool nzNet::getGrad(zVec grad){ return nzNetGetGrad( this, grad ); }
+inline bool nzNet::topoSort(){ return nzNetTopoSort( this ); }
 inline void nzNet::fprint(FILE *fp){ nzNetFPrint( fp, this ); }
+inline nzNetWorkspace *nzNetWorkspace::alloc(nzNet *net){ return nzNetWorkspaceAlloc( this, net ); }
+inline void nzNetWorkspace::destroy(){ nzNetWorkspaceDestroy( this ); }
+inline nzNetContext *nzNetContext::alloc(nzNet *net){ return nzNetContextAlloc( this, net ); }
+inline void nzNetContext::destroy(){ nzNetContextDestroy( this ); }
+inline bool nzNetContext::setInput(zVec input){ return nzNetContextSetInput( this, input ); }
+inline bool nzNetContext::getOutput(zVec output){ return nzNetContextGetOutput( this, output ); }
+inline bool nzNetContext::propagate(zVec input){ return nzNetContextPropagate( this, input ); }
+inline void nzNetContext::initGrad(){ nzNetContextInitGrad( this ); }
+inline bool nzNetContext::backpropagate(zVec des, double (* lossgrad)(zVec,zVec,int)){ return nzNetContextBackPropagate( this, des, lossgrad ); }
+inline void nzNetContext::addGradToNet(){ nzNetContextAddGradToNet( this ); }
 inline nzNet *nzNet::fromZTK(ZTK *ztk){ return nzNetFromZTK( this, ztk ); }
 inline nzNet *nzNet::readZTK(const char filename[]){ return nzNetReadZTK( this, filename ); }
 inline void nzNet::fprintZTK(FILE *fp){ nzNetFPrintZTK( fp, this ); }
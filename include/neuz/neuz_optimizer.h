@@ -0,0 +1,146 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_optimizer.h
+ * \brief optimizers of weights and biases.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_OPTIMIZER_H__
+#define __NEUZ_OPTIMIZER_H__
+
+#include <neuz/neuz_dense.h>
+
+__BEGIN_DECLS
+
+/*! \brief types of optimizers */
+enum{
+  NZ_OPTIMIZER_SDM = 0,  /* steepest descent method */
+  NZ_OPTIMIZER_MOMENTUM, /* momentum method */
+  NZ_OPTIMIZER_NESTEROV, /* Nesterov's accelerated gradient method */
+  NZ_OPTIMIZER_RMSPROP,  /* RMSProp */
+  NZ_OPTIMIZER_ADAM      /* Adam */
+};
+
+/*! \brief default hyper parameters of optimizers */
+#define NZ_OPTIMIZER_DEFAULT_BETA1 0.9
+#define NZ_OPTIMIZER_DEFAULT_BETA2 0.999
+#define NZ_OPTIMIZER_DEFAULT_RMSPROP_BETA2 0.9
+#define NZ_OPTIMIZER_DEFAULT_EPS   1.0e-8
+
+/*! \brief optimizer class
+ *
+ * an optimizer updates an array of parameters p with the gradient g of
+ * the loss function as follows, where i is the index of a parameter
+ * and t is the number of updates.
+ *  - steepest descent method: p_i -= rate g_i
+ *  - momentum method: m_i = beta1 m_i + g_i, p_i -= rate m_i
+ *  - Nesterov's method: m_i = beta1 m_i + g_i, p_i -= rate ( g_i + beta1 m_i )
+ *  - RMSProp: v_i = beta2 v_i + (1-beta2) g_i^2, p_i -= rate g_i / ( sqrt(v_i) + eps )
+ *  - Adam: m_i = beta1 m_i + (1-beta1) g_i, v_i = beta2 v_i + (1-beta2) g_i^2,
+ *    p_i -= rate sqrt(1-beta2^t)/(1-beta1^t) m_i / ( sqrt(v_i) + eps )
+ * Internal states m and v are stored in contiguous arrays, and each
+ * update is done in a single pass over parameters, gradients and
+ * states, where the loop of the update rule is chosen once per update.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzOptimizer ){
+  int type;     /* type of the optimizer */
+  double rate;  /* learning rate */
+  double beta1; /* decay rate of the first moment */
+  double beta2; /* decay rate of the second moment */
+  double eps;   /* small constant to avoid division by zero */
+  int n;        /* number of parameters */
+  int step;     /* number of updates */
+  nzReal *_m;   /* first moments of gradients */
+  nzReal *_v;   /* second moments of gradients */
+  nzNet *_net;  /* neural network bound to the optimizer */
+#ifdef __cplusplus
+  nzOptimizer() : type{NZ_OPTIMIZER_SDM}, n{0}, step{0}, _m{NULL}, _v{NULL}, _net{NULL} {}
+  nzOptimizer *create(int type, int n, double rate);
+  nzOptimizer *create(int type, nzNet *net, double rate);
+  void destroy();
+  void reset();
+  void update(nzReal *param, const nzReal *grad);
+  bool update(nzNet *net);
+  bool update(nzDenseNet *dn);
+#endif /* __cplusplus */
+};
+
+/*! \brief create an optimizer.
+ *
+ * nzOptimizerCreate() creates an optimizer \a opt of a type \a type,
+ * which is one of NZ_OPTIMIZER_SDM, NZ_OPTIMIZER_MOMENTUM,
+ * NZ_OPTIMIZER_NESTEROV, NZ_OPTIMIZER_RMSPROP and NZ_OPTIMIZER_ADAM,
+ * for \a n parameters with a learning rate \a rate. Other hyper
+ * parameters are set for the default values, and can be modified
+ * directly before the first update.
+ * \return
+ * a pointer \a opt is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzOptimizer *nzOptimizerCreate(nzOptimizer *opt, int type, int n, double rate);
+
+/*! \brief create an optimizer bound to a neural network.
+ *
+ * nzOptimizerCreateNet() creates an optimizer \a opt in the same way
+ * with nzOptimizerCreate() for weights and biases of \a net, and binds
+ * \a opt to \a net. The number of parameters is counted only at this
+ * time, so that nzOptimizerUpdateNet() for \a net skips to count them
+ * at every update. \a opt has to be re-created if the structure of
+ * \a net is modified.
+ * \return
+ * a pointer \a opt is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzOptimizer *nzOptimizerCreateNet(nzOptimizer *opt, int type, nzNet *net, double rate);
+
+/*! \brief destroy an optimizer. */
+__NEUZ_EXPORT void nzOptimizerDestroy(nzOptimizer *opt);
+
+/*! \brief reset internal states of an optimizer. */
+__NEUZ_EXPORT void nzOptimizerReset(nzOptimizer *opt);
+
+/*! \brief update an array of parameters by an optimizer.
+ *
+ * nzOptimizerUpdate() updates n parameters \a param of \a opt with
+ * the gradient \a grad.
+ */
+__NEUZ_EXPORT void nzOptimizerUpdate(nzOptimizer *opt, nzReal *param, const nzReal *grad);
+
+/*! \brief update weights and biases of a neural network by an optimizer.
+ *
+ * nzOptimizerUpdateNet() updates weights and biases of \a net with
+ * gradients accumulated in _dw of axons and _db of neurons. Parameters
+ * are visited in the same order with nzNetTrainSDM(), and are mapped
+ * to internal states of \a opt in the order. \a opt has to be created
+ * for nzNetNumParam() parameters, which are counted at every update
+ * unless \a opt is bound to \a net by nzOptimizerCreateNet().
+ * \return
+ * false is returned if the number of parameters of \a net mismatches
+ * with \a opt. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzOptimizerUpdateNet(nzOptimizer *opt, nzNet *net);
+
+/*! \brief update weights and biases of a compiled dense-layer network by an optimizer.
+ *
+ * nzOptimizerUpdateDenseNet() updates _param of \a dn with _grad.
+ * \a opt has to be created for nparam of \a dn.
+ * \return
+ * false is returned if the number of parameters of \a dn mismatches
+ * with \a opt. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzOptimizerUpdateDenseNet(nzOptimizer *opt, nzDenseNet *dn);
+
+#ifdef __cplusplus
+inline nzOptimizer *nzOptimizer::create(int type, int n, double rate){ return nzOptimizerCreate( this, type, n, rate ); }
+inline nzOptimizer *nzOptimizer::create(int type, nzNet *net, double rate){ return nzOptimizerCreateNet( this, type, net, rate ); }
+inline void nzOptimizer::destroy(){ nzOptimizerDestroy( this ); }
+inline void nzOptimizer::reset(){ nzOptimizerReset( this ); }
+inline void nzOptimizer::update(nzReal *param, const nzReal *grad){ nzOptimizerUpdate( this, param, grad ); }
+inline bool nzOptimizer::update(nzNet *net){ return nzOptimizerUpdateNet( this, net ); }
+inline bool nzOptimizer::update(nzDenseNet *dn){ return nzOptimizerUpdateDenseNet( this, dn ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_OPTIMIZER_H__ */
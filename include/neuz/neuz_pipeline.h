@@ -0,0 +1,151 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_pipeline.h
+ * \brief prefetching pipeline of mini-batches.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_PIPELINE_H__
+#define __NEUZ_PIPELINE_H__
+
+#include <neuz/neuz_neuron.h>
+#include <neuz/neuz_dataset.h>
+#include <pthread.h>
+
+__BEGIN_DECLS
+
+/*! \brief mini-batch in a ring buffer of a pipeline */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzPipelineBatch ){
+  zMat input;     /* inputs of samples */
+  zMat des;       /* desired outputs of samples */
+  int n;          /* number of samples */
+  int epoch;      /* epoch that the batch belongs to */
+  long seq;       /* sequence number of the batch */
+  size_t *index;  /* indices of samples in the dataset */
+  bool _eoe;      /* marker of the end of an epoch */
+  int _state;     /* empty, filling, ready or consumed */
+};
+
+/*! \brief prefetching pipeline class
+ *
+ * a pipeline holds a ring buffer of mini-batches, and producer threads
+ * read samples of the following batches from a dataset and transform
+ * them, e.g. normalize or augment them, while the training thread
+ * consumes the current batch.
+ * Indices of samples of a batch are drawn from the dataset in the order
+ * of sequence numbers, and batches are passed to the training thread in
+ * the same order, so that the order of samples does not depend on the
+ * number or the timing of producers. The end of every epoch is marked
+ * in the ring buffer, and producers go on to the next epoch without
+ * waiting for the training thread.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzPipeline ){
+  nzDataset *ds;          /* dataset */
+  int batchsize;          /* number of samples of a batch */
+  int capacity;           /* number of batches of the ring buffer */
+  nzPipelineBatch *batch; /* ring buffer of batches */
+  int nthread;            /* number of producer threads */
+  pthread_t *thread;      /* producer threads */
+  /* transformation of a sample by producers */
+  void (* transform)(void *, double *, double *);
+  void *util;
+  pthread_mutex_t mutex;      /* lock of the following members */
+  pthread_cond_t cond_free;   /* signal of a released batch */
+  pthread_cond_t cond_ready;  /* signal of a prepared batch */
+  long _seq_fill;         /* sequence number of the next batch to be filled */
+  long _seq_consume;      /* sequence number of the next batch to be consumed */
+  int _epoch;             /* epoch of the next batch to be filled */
+  bool _eoe;              /* the end of the current epoch is to be marked */
+  bool _quit;             /* request to quit */
+#ifdef __cplusplus
+  nzPipeline() : ds{NULL}, batchsize{0}, capacity{0}, batch{NULL}, nthread{0}, thread{NULL}, transform{NULL}, util{NULL} {}
+  nzPipeline *create(nzDataset *ds, int batchsize, int capacity, int nthread, void (* transform)(void *, double *, double *), void *util);
+  void destroy();
+  nzPipelineBatch *next();
+  void release(nzPipelineBatch *batch);
+  int trainNet(nzNet *net, double (* loss)(zVec,zVec), double (* lossgrad)(zVec,zVec,int), double rate, int nepoch, bool (* report)(void *, int, double), void *util);
+#endif /* __cplusplus */
+};
+
+/*! \brief default number of batches of a ring buffer of a pipeline */
+#define NZ_PIPELINE_DEFAULT_CAPACITY 4
+
+/*! \brief create a prefetching pipeline.
+ *
+ * nzPipelineCreate() creates a pipeline \a pl which reads batches of
+ * \a batchsize samples from a dataset \a ds by \a nthread producer
+ * threads into a ring buffer of \a capacity batches, all of which have
+ * to be positive. NZ_PIPELINE_DEFAULT_CAPACITY and
+ * nzThreadNumProcessors() are reasonable choices of \a capacity and
+ * \a nthread, respectively.
+ * If \a transform is not the null pointer, producers call it with
+ * \a util, inputs and desired outputs of each sample, which can be
+ * modified in place. Since it is called from producer threads at once,
+ * it has to be thread-safe.
+ * Producers begin a new epoch of \a ds and start to fill the ring buffer
+ * immediately. \a ds must not be used by others until \a pl is
+ * destroyed.
+ * \return
+ * the null pointer is returned if any of \a batchsize, \a capacity and
+ * \a nthread is not positive, or it fails to allocate memory or to
+ * create threads. Otherwise, a pointer \a pl is returned.
+ */
+__NEUZ_EXPORT nzPipeline *nzPipelineCreate(nzPipeline *pl, nzDataset *ds, int batchsize, int capacity, int nthread, void (* transform)(void *, double *, double *), void *util);
+
+/*! \brief destroy a prefetching pipeline to join all producer threads. */
+__NEUZ_EXPORT void nzPipelineDestroy(nzPipeline *pl);
+
+/*! \brief get the next batch of a pipeline.
+ *
+ * nzPipelineNext() waits until the next batch of \a pl is prepared and
+ * returns it. Rows of input and des of the batch are as many as the
+ * samples, which can be less than the batch size at the end of an
+ * epoch. The batch has to be returned by nzPipelineRelease() before
+ * the next call.
+ * \return
+ * a pointer to the next batch is returned. At the end of every epoch,
+ * the null pointer is returned once, and the following call returns
+ * the first batch of the next epoch.
+ */
+__NEUZ_EXPORT nzPipelineBatch *nzPipelineNext(nzPipeline *pl);
+
+/*! \brief release a batch of a pipeline.
+ *
+ * nzPipelineRelease() returns \a batch got by nzPipelineNext() to
+ * \a pl, so that producers refill it.
+ */
+__NEUZ_EXPORT void nzPipelineRelease(nzPipeline *pl, nzPipelineBatch *batch);
+
+/*! \brief train a neural network with batches of a pipeline.
+ *
+ * nzPipelineTrainNet() trains \a net for \a nepoch epochs with batches
+ * of \a pl. For each batch, gradients are initialized, loss of each
+ * sample is back-propagated with \a lossgrad, and weights and biases
+ * are updated by the steepest descent method with a learning rate
+ * \a rate. The sum of loss computed by \a loss over an epoch is passed
+ * to \a report with \a util and the number of the epoch at the end of
+ * it, which stops training if it returns false, e.g.
+ *   bool report(void *util, int epoch, double loss){
+ *     eprintf( "%03d %.10g\n", epoch, loss );
+ *     return !zIsTiny( loss );
+ *   }
+ * \a report can be the null pointer.
+ * \return
+ * the number of epochs trained is returned. If it fails to allocate
+ * internal workspace or sizes of \a net mismatch with the dataset, -1
+ * is returned.
+ */
+__NEUZ_EXPORT int nzPipelineTrainNet(nzPipeline *pl, nzNet *net, double (* loss)(zVec,zVec), double (* lossgrad)(zVec,zVec,int), double rate, int nepoch, bool (* report)(void *, int, double), void *util);
+
+#ifdef __cplusplus
+inline nzPipeline *nzPipeline::create(nzDataset *ds, int batchsize, int capacity, int nthread, void (* transform)(void *, double *, double *), void *util){ return nzPipelineCreate( this, ds, batchsize, capacity, nthread, transform, util ); }
+inline void nzPipeline::destroy(){ nzPipelineDestroy( this ); }
+inline nzPipelineBatch *nzPipeline::next(){ return nzPipelineNext( this ); }
+inline void nzPipeline::release(nzPipelineBatch *batch){ nzPipelineRelease( this, batch ); }
+inline int nzPipeline::trainNet(nzNet *net, double (* loss)(zVec,zVec), double (* lossgrad)(zVec,zVec,int), double rate, int nepoch, bool (* report)(void *, int, double), void *util){ return nzPipelineTrainNet( this, net, loss, lossgrad, rate, nepoch, report, util ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_PIPELINE_H__ */
@@ -0,0 +1,156 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_quant.h
+ * \brief int8-quantized dense-layer network.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_QUANT_H__
+#define __NEUZ_QUANT_H__
+
+#include <neuz/neuz_dense.h>
+
+__BEGIN_DECLS
+
+/*! \brief granularity of scales of quantized weights */
+enum{
+  NZ_QUANT_PER_LAYER = 0, /* a scale shared by all weights of a layer */
+  NZ_QUANT_PER_NEURON     /* a scale for weights of each neuron */
+};
+
+/*! \brief alignment of rows of quantized weight matrices in bytes */
+#define NZ_QUANT_ALIGN 32
+
+/*! \brief quantized dense layer class
+ *
+ * weights of a layer are quantized to integers in [-127,127], and are
+ * stored in a row-major nout x stride matrix, where stride is nin
+ * rounded up to a multiple of NZ_QUANT_ALIGN and the padding is zero.
+ * The i-th weight of the j-th neuron is approximated by
+ * weight[j*stride+i] * scale[j]. Inputs of the layer are quantized
+ * with input_scale in the same way.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzQuantLayer ){
+  int nin;                /* size of input */
+  int nout;               /* size of output */
+  int stride;             /* size of a row of the weight matrix */
+  signed char *weight;    /* quantized weight matrix */
+  float *scale;           /* scales of weights of neurons */
+  float input_scale;      /* scale of quantized input */
+  nzReal *bias;           /* bias vector */
+  nzActivator *activator; /* activator function */
+};
+
+/*! \brief int8-quantized dense-layer network class
+ *
+ * a quantized network is created from a compiled dense-layer network
+ * by post-training quantization. Each layer quantizes its input to
+ * int8 with a scale determined by calibration, accumulates products
+ * of int8 weights and inputs in int32 by integer SIMD instructions,
+ * and then rescales the sums to real values to add biases and apply
+ * the activator. Weights take one byte each, namely, a quarter of
+ * single-precision weights.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzQuantNet ){
+  int size;              /* number of layers except the input layer */
+  nzQuantLayer *layer;   /* array of layers */
+  int granularity;       /* granularity of scales of weights */
+  size_t _size;          /* size of the buffer of weights, scales and biases in bytes */
+  void *_buf;            /* buffer of weights, scales and biases */
+  nzReal *_work;         /* buffer of inputs and outputs of layers */
+  signed char *_q;       /* buffer of quantized inputs of a layer */
+#ifdef __cplusplus
+  nzQuantNet() : size{0}, layer{NULL}, granularity{NZ_QUANT_PER_NEURON}, _size{0}, _buf{NULL}, _work{NULL}, _q{NULL} {}
+  void init();
+  void destroy();
+  int inputSize() const;
+  int outputSize() const;
+  nzQuantNet *create(nzDenseNet *dn, int granularity);
+  bool calibrate(nzDenseNet *dn, zMat sample);
+  bool calibrate(nzDenseNet *dn, zVecList *sample);
+  bool propagate(zVec input, zVec output);
+  bool delta(nzNet *net, zMat sample, double *maxerr, double *rmserr);
+#endif /* __cplusplus */
+};
+
+#define nzQuantNetInputSize(qn)  (qn)->layer[0].nin
+#define nzQuantNetOutputSize(qn) (qn)->layer[(qn)->size-1].nout
+
+/*! \brief initialize a quantized network. */
+__NEUZ_EXPORT void nzQuantNetInit(nzQuantNet *qn);
+
+/*! \brief destroy a quantized network. */
+__NEUZ_EXPORT void nzQuantNetDestroy(nzQuantNet *qn);
+
+/*! \brief quantize weights of a compiled dense-layer network.
+ *
+ * nzQuantNetCreate() creates a quantized network \a qn from \a dn.
+ * Weights are quantized symmetrically, namely, the maximum absolute
+ * weight of each layer if \a granularity is NZ_QUANT_PER_LAYER, or of
+ * each neuron if NZ_QUANT_PER_NEURON, is mapped to 127. Biases are
+ * kept in real numbers. Scales of inputs of layers are set so that
+ * values in [-1,1] are quantized, which should be calibrated by
+ * nzQuantNetCalibrate() or nzQuantNetCalibrateList() before use.
+ * \return
+ * a pointer \a qn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzQuantNet *nzQuantNetCreate(nzQuantNet *qn, nzDenseNet *dn, int granularity);
+
+/*! \brief calibrate scales of inputs of layers of a quantized network.
+ *
+ * nzQuantNetCalibrate() propagates samples through \a dn, from which
+ * \a qn was created, and sets the scale of the input of each layer of
+ * \a qn so that the maximum absolute input over the samples is mapped
+ * to 127. Each row of \a sample is an input vector of a sample.
+ * nzQuantNetCalibrateList() does the same for a list of input vectors
+ * \a sample.
+ * \return
+ * false is returned if sizes of samples mismatch with \a qn or \a dn.
+ * Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzQuantNetCalibrate(nzQuantNet *qn, nzDenseNet *dn, zMat sample);
+__NEUZ_EXPORT bool nzQuantNetCalibrateList(nzQuantNet *qn, nzDenseNet *dn, zVecList *sample);
+
+/*! \brief propagate input values to a quantized network to the output.
+ *
+ * nzQuantNetPropagate() computes the output of \a qn for \a input, and
+ * stores it in \a output. Dot products of quantized weights and inputs
+ * run SIMD kernels of the instruction set selected by nzSIMDSetLevel()
+ * if available.
+ * \return
+ * false is returned if sizes of \a input and \a output mismatch with
+ * \a qn. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzQuantNetPropagate(nzQuantNet *qn, zVec input, zVec output);
+
+/*! \brief accuracy of a quantized network against a neural network.
+ *
+ * nzQuantNetDelta() propagates samples through both \a qn and \a net,
+ * from which \a qn was created via a compiled network, and computes
+ * the maximum absolute difference and the root mean square difference
+ * of outputs over the samples. Each row of \a sample is an input vector
+ * of a sample. The results are stored where \a maxerr and \a rmserr
+ * point, unless they are the null pointer.
+ * \return
+ * false is returned if sizes of \a sample mismatch with \a qn or \a net.
+ * Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzQuantNetDelta(nzQuantNet *qn, nzNet *net, zMat sample, double *maxerr, double *rmserr);
+
+#ifdef __cplusplus
+inline void nzQuantNet::init(){ nzQuantNetInit( this ); }
+inline void nzQuantNet::destroy(){ nzQuantNetDestroy( this ); }
+inline int nzQuantNet::inputSize() const { return nzQuantNetInputSize( this ); }
+inline int nzQuantNet::outputSize() const { return nzQuantNetOutputSize( this ); }
+inline nzQuantNet *nzQuantNet::create(nzDenseNet *dn, int granularity){ return nzQuantNetCreate( this, dn, granularity ); }
+inline bool nzQuantNet::calibrate(nzDenseNet *dn, zMat sample){ return nzQuantNetCalibrate( this, dn, sample ); }
+inline bool nzQuantNet::calibrate(nzDenseNet *dn, zVecList *sample){ return nzQuantNetCalibrateList( this, dn, sample ); }
+inline bool nzQuantNet::propagate(zVec input, zVec output){ return nzQuantNetPropagate( this, input, output ); }
+inline bool nzQuantNet::delta(nzNet *net, zMat sample, double *maxerr, double *rmserr){ return nzQuantNetDelta( this, net, sample, maxerr, rmserr ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_QUANT_H__ */
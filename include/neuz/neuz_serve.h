@@ -0,0 +1,155 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_serve.h
+ * \brief protocol and client of the inference server.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_SERVE_H__
+#define __NEUZ_SERVE_H__
+
+#include <neuz/neuz_misc.h>
+#include <stdint.h>
+
+__BEGIN_DECLS
+
+/*! \brief protocol of the inference server nz_server
+ *
+ * a client sends a request and the server returns a response through
+ * a Unix domain socket. A message consists of a header of two 32-bit
+ * unsigned integers, namely, a code and the length of the payload in
+ * bytes, followed by the payload. Since the server and clients run on
+ * the same host, integers and real numbers are in the native byte
+ * order. Codes of requests are:
+ *  - NZ_SERVE_PREDICT: the payload is an array of inputs of one or more
+ *    samples in double precision, and the response is that of outputs.
+ *  - NZ_SERVE_INFO: the response is the numbers of inputs and outputs
+ *    of the network as two 32-bit unsigned integers.
+ *  - NZ_SERVE_STATS: the response is a text of statistics of the server,
+ *    which includes throughput and percentiles of latency.
+ * The code of a response is NZ_SERVE_OK or NZ_SERVE_ERROR.
+ */
+#define NZ_SERVE_PREDICT 1
+#define NZ_SERVE_INFO    2
+#define NZ_SERVE_STATS   3
+
+#define NZ_SERVE_OK    0
+#define NZ_SERVE_ERROR 1
+
+/*! \brief default path of the socket of the inference server */
+#define NZ_SERVE_DEFAULT_PATH "/tmp/neuz.sock"
+
+/*! \brief the maximum length of the payload of a message in bytes */
+#define NZ_SERVE_MAX_PAYLOAD ( 64 * 1024 * 1024 )
+
+/*! \brief send a message to a socket.
+ *
+ * nzServeSend() sends a message with \a code and \a len bytes of
+ * \a payload to a socket \a fd.
+ * \return
+ * false is returned if it fails to send. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzServeSend(int fd, uint32_t code, const void *payload, uint32_t len);
+
+/*! \brief receive a message from a socket.
+ *
+ * nzServeRecv() receives a message from a socket \a fd. The code and
+ * the length of the payload are stored in \a code and \a len, and the
+ * payload is stored in \a buf, which is reallocated if it is shorter
+ * than the payload. \a size is the size of \a buf in bytes, which is
+ * updated when reallocated. \a buf and \a size have to be initialized
+ * by the null pointer and 0 at first, and \a buf has to be freed by
+ * the caller.
+ * \return
+ * false is returned if the connection is closed, or it fails to
+ * receive or to allocate memory. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzServeRecv(int fd, uint32_t *code, uint32_t *len, void **buf, size_t *size);
+
+/*! \brief percentiles of values.
+ *
+ * nzServePercentile() sorts \a n values of \a val in place, and stores
+ * the \a p[i]-th percentiles (0 <= p[i] <= 100) of them to \a q[i] for
+ * i = 0, ..., \a np-1, which are the nearest-rank values.
+ */
+__NEUZ_EXPORT void nzServePercentile(double val[], int n, const double p[], double q[], int np);
+
+/*! \brief client of the inference server */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzServeClient ){
+  int fd;        /* socket */
+  int ninput;    /* number of inputs of the network */
+  int noutput;   /* number of outputs of the network */
+  void *_buf;    /* buffer of a response */
+  size_t _size;  /* size of the buffer in bytes */
+#ifdef __cplusplus
+  nzServeClient() : fd{-1}, ninput{0}, noutput{0}, _buf{NULL}, _size{0} {}
+  nzServeClient *connect(const char path[]);
+  void close();
+  bool predict(zVec input, zVec output);
+  bool predictBatch(zMat input, zMat output);
+  char *stats();
+#endif /* __cplusplus */
+};
+
+/*! \brief connect to the inference server.
+ *
+ * nzServeClientConnect() connects \a client to the server listening
+ * at a socket \a path, and asks the numbers of inputs and outputs of
+ * the network. If \a path is the null pointer, NZ_SERVE_DEFAULT_PATH
+ * is used instead. A client sends a request and waits for the
+ * response, so that a thread has to have its own client to send
+ * requests concurrently. Requests from clients are coalesced into
+ * batches by the server.
+ * \return
+ * a pointer \a client is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzServeClient *nzServeClientConnect(nzServeClient *client, const char path[]);
+
+/*! \brief close a connection to the inference server. */
+__NEUZ_EXPORT void nzServeClientClose(nzServeClient *client);
+
+/*! \brief predict outputs of a sample by the inference server.
+ *
+ * nzServeClientPredict() sends inputs \a input of a sample to the
+ * server, and stores outputs of the network to \a output.
+ * \return
+ * false is returned if sizes of \a input and \a output mismatch with
+ * the network, or it fails to communicate with the server. Otherwise,
+ * true is returned.
+ */
+__NEUZ_EXPORT bool nzServeClientPredict(nzServeClient *client, zVec input, zVec output);
+
+/*! \brief predict outputs of a batch of samples by the inference server.
+ *
+ * nzServeClientPredictBatch() sends rows of \a input as inputs of
+ * samples to the server, and stores outputs of the network to the
+ * corresponding rows of \a output.
+ * \return
+ * false is returned if sizes of \a input and \a output mismatch with
+ * the network, or it fails to communicate with the server. Otherwise,
+ * true is returned.
+ */
+__NEUZ_EXPORT bool nzServeClientPredictBatch(nzServeClient *client, zMat input, zMat output);
+
+/*! \brief statistics of the inference server.
+ *
+ * nzServeClientStats() asks statistics of the server.
+ * \return
+ * a newly allocated string of the statistics is returned, which has to
+ * be freed by the caller. If it fails, the null pointer is returned.
+ */
+__NEUZ_EXPORT char *nzServeClientStats(nzServeClient *client);
+
+#ifdef __cplusplus
+inline nzServeClient *nzServeClient::connect(const char path[]){ return nzServeClientConnect( this, path ); }
+inline void nzServeClient::close(){ nzServeClientClose( this ); }
+inline bool nzServeClient::predict(zVec input, zVec output){ return nzServeClientPredict( this, input, output ); }
+inline bool nzServeClient::predictBatch(zMat input, zMat output){ return nzServeClientPredictBatch( this, input, output ); }
+inline char *nzServeClient::stats(){ return nzServeClientStats( this ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_SERVE_H__ */
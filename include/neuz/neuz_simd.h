@@ -0,0 +1,50 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_simd.h
+ * \brief selection of SIMD instruction sets.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_SIMD_H__
+#define __NEUZ_SIMD_H__
+
+#include <neuz/neuz_misc.h>
+
+/* SIMD kernels are available only for x86 processors with GCC-compatible compilers. */
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define __NEUZ_SIMD_X86
+#define __NZ_SSE2 __attribute__((target("sse2")))
+#define __NZ_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+__BEGIN_DECLS
+
+/*! \brief levels of SIMD instruction sets */
+enum{
+  NZ_SIMD_NONE = 0, /* scalar operations */
+  NZ_SIMD_SSE2,     /* SSE2 (2 doubles per instruction) */
+  NZ_SIMD_AVX2      /* AVX2 and FMA (4 doubles per instruction) */
+};
+
+/*! \brief level of SIMD instruction set currently used.
+ *
+ * nzSIMDLevel() returns the level of SIMD instruction set used by
+ * array operations of neuZ. At the first call, it is set for the
+ * highest level supported by the processor.
+ */
+__NEUZ_EXPORT int nzSIMDLevel(void);
+
+/*! \brief set the level of SIMD instruction set.
+ *
+ * nzSIMDSetLevel() restricts the SIMD instruction set used by array
+ * operations of neuZ to \a level. If \a level is not supported by the
+ * processor, the highest supported level is set instead.
+ * \return
+ * the level actually set is returned.
+ */
+__NEUZ_EXPORT int nzSIMDSetLevel(int level);
+
+__END_DECLS
+
+#endif /* __NEUZ_SIMD_H__ */
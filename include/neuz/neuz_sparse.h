@@ -0,0 +1,170 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_sparse.h
+ * \brief pruning and compiled sparse network.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_SPARSE_H__
+#define __NEUZ_SPARSE_H__
+
+#include <neuz/neuz_neuron.h>
+
+__BEGIN_DECLS
+
+/*! \brief prune axons of a neural network by magnitude of weights.
+ *
+ * nzNetPrune() removes axons of \a net the absolute weights of which
+ * are less than \a threshold.
+ * nzNetPruneTopK() keeps \a k axons with the largest absolute weights
+ * for each neuron, and removes the others. Of axons with the same
+ * absolute weight, those connected earlier are kept. The order of the
+ * remaining axons is not changed.
+ * Axons allocated from the arena of \a net are not reused until \a net
+ * is destroyed, while they are not visited any more. A pruned network
+ * is written to and read from a ZTK file with only the remaining axons
+ * by nzNetWriteZTK() and nzNetReadZTK().
+ * \return
+ * the number of removed axons is returned. nzNetPruneTopK() returns -1
+ * if it fails to allocate workspace.
+ */
+__NEUZ_EXPORT int nzNetPrune(nzNet *net, double threshold);
+__NEUZ_EXPORT int nzNetPruneTopK(nzNet *net, int k);
+
+/*! \brief compiled sparse network class
+ *
+ * a compiled sparse network stores connections of a neural network in
+ * a compressed sparse row form. Neurons are numbered serially from the
+ * input layer to the output layer, and upstream neurons of the i-th
+ * neuron except the input layer are given by serial numbers
+ * upstream[offset[i]] to upstream[offset[i+1]-1], the weights of which
+ * are the corresponding elements of weight. Propagation and
+ * back-propagation run in a time proportional to the number of
+ * connections without following pointers.
+ * Weights and biases are stored successively in _param, and their
+ * gradients in _grad in the same layout, so that an optimizer can be
+ * applied to nparam values of them at once.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzSparseNet ){
+  int ninput;               /* number of input neurons */
+  int noutput;              /* number of output neurons */
+  int nneuron;              /* number of neurons except the input layer */
+  int nconn;                /* number of connections */
+  int nparam;               /* number of weights and biases */
+  nzReal *weight;           /* weights of connections */
+  nzReal *bias;             /* biases of neurons */
+  int *offset;              /* the first connection of each neuron */
+  int *upstream;            /* serial numbers of upstream neurons of connections */
+  nzActivator **activator;  /* activator functions of neurons */
+  nzReal *value;            /* output values of neurons including the input layer */
+  nzReal *input;            /* weighted sums of neurons */
+  nzReal *_param;           /* buffer of weights and biases */
+  nzReal *_grad;            /* buffer of gradients of weights and biases */
+  nzReal *_dw;              /* gradients of weights */
+  nzReal *_db;              /* gradients of biases */
+  nzReal *_p;               /* back-propagated loss gradients of neurons */
+  zVec _output;             /* output values passed to a loss gradient function */
+#ifdef __cplusplus
+  nzSparseNet() : ninput{0}, noutput{0}, nneuron{0}, nconn{0}, nparam{0}, weight{NULL}, bias{NULL}, offset{NULL}, upstream{NULL}, activator{NULL}, value{NULL}, input{NULL}, _param{NULL}, _grad{NULL}, _dw{NULL}, _db{NULL}, _p{NULL}, _output{NULL} {}
+  void init();
+  void destroy();
+  int inputSize() const;
+  int outputSize() const;
+  nzSparseNet *compile(nzNet *net);
+  bool copyToNet(nzNet *net);
+  bool setInput(zVec input);
+  bool getOutput(zVec output);
+  bool propagate(zVec input);
+  void initGrad();
+  bool backpropagate(zVec input, zVec des, double (* lossgrad)(zVec,zVec,int));
+  void trainSDM(double rate);
+#endif /* __cplusplus */
+};
+
+#define nzSparseNetInputSize(sn)  (sn)->ninput
+#define nzSparseNetOutputSize(sn) (sn)->noutput
+
+/*! \brief initialize a compiled sparse network. */
+__NEUZ_EXPORT void nzSparseNetInit(nzSparseNet *sn);
+
+/*! \brief destroy a compiled sparse network. */
+__NEUZ_EXPORT void nzSparseNetDestroy(nzSparseNet *sn);
+
+/*! \brief compile a neural network into a sparse network.
+ *
+ * nzSparseNetCompile() converts axons of \a net to a compressed sparse
+ * row form, and stores them in \a sn. Every axon has to come from a
+ * preceding group, neurons of the input layer must not have activators
+ * while the others must.
+ * \return
+ * a pointer \a sn is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzSparseNet *nzSparseNetCompile(nzSparseNet *sn, nzNet *net);
+
+/*! \brief copy weights and biases of a compiled sparse network back to a neural network.
+ *
+ * nzSparseNetCopyToNet() writes weights and biases of \a sn to the
+ * corresponding axons and neurons of \a net, from which \a sn was
+ * compiled.
+ * \return
+ * false is returned if the topology of \a net does not match with
+ * \a sn. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzSparseNetCopyToNet(nzSparseNet *sn, nzNet *net);
+
+/*! \brief set input values to a compiled sparse network. */
+__NEUZ_EXPORT bool nzSparseNetSetInput(nzSparseNet *sn, zVec input);
+
+/*! \brief get output values from a compiled sparse network. */
+__NEUZ_EXPORT bool nzSparseNetGetOutput(nzSparseNet *sn, zVec output);
+
+/*! \brief propagate input values to a compiled sparse network to the output.
+ *
+ * nzSparseNetPropagate() computes the output of \a sn for \a input,
+ * which is identical with nzNetPropagate() applied to the original
+ * network up to rounding errors. If \a input is the null pointer, the
+ * values previously set by nzSparseNetSetInput() are used.
+ */
+__NEUZ_EXPORT bool nzSparseNetPropagate(nzSparseNet *sn, zVec input);
+
+/*! \brief initialize gradients of weights and biases of a compiled sparse network. */
+__NEUZ_EXPORT void nzSparseNetInitGrad(nzSparseNet *sn);
+
+/*! \brief back-propagate loss in a compiled sparse network.
+ *
+ * nzSparseNetBackPropagate() propagates \a input through \a sn, and
+ * back-propagates the loss with respect to the desired output \a des
+ * to add gradients of weights and biases to _dw and _db. \a lossgrad
+ * is a function to compute the i-th component of the gradient of the
+ * loss function, e.g. nzLossGradSquareSum(). The result is identical
+ * with nzNetBackPropagate() applied to the original network up to
+ * rounding errors. No memory is allocated in it.
+ * \return
+ * false is returned if sizes of \a input and \a des mismatch with
+ * \a sn. Otherwise, true is returned.
+ */
+__NEUZ_EXPORT bool nzSparseNetBackPropagate(nzSparseNet *sn, zVec input, zVec des, double (* lossgrad)(zVec,zVec,int));
+
+/*! \brief train a compiled sparse network based on the steepest descent method. */
+__NEUZ_EXPORT void nzSparseNetTrainSDM(nzSparseNet *sn, double rate);
+
+#ifdef __cplusplus
+inline void nzSparseNet::init(){ nzSparseNetInit( this ); }
+inline void nzSparseNet::destroy(){ nzSparseNetDestroy( this ); }
+inline int nzSparseNet::inputSize() const { return nzSparseNetInputSize( this ); }
+inline int nzSparseNet::outputSize() const { return nzSparseNetOutputSize( this ); }
+inline nzSparseNet *nzSparseNet::compile(nzNet *net){ return nzSparseNetCompile( this, net ); }
+inline bool nzSparseNet::copyToNet(nzNet *net){ return nzSparseNetCopyToNet( this, net ); }
+inline bool nzSparseNet::setInput(zVec input){ return nzSparseNetSetInput( this, input ); }
+inline bool nzSparseNet::getOutput(zVec output){ return nzSparseNetGetOutput( this, output ); }
+inline bool nzSparseNet::propagate(zVec input){ return nzSparseNetPropagate( this, input ); }
+inline void nzSparseNet::initGrad(){ nzSparseNetInitGrad( this ); }
+inline bool nzSparseNet::backpropagate(zVec input, zVec des, double (* lossgrad)(zVec,zVec,int)){ return nzSparseNetBackPropagate( this, input, des, lossgrad ); }
+inline void nzSparseNet::trainSDM(double rate){ nzSparseNetTrainSDM( this, rate ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_SPARSE_H__ */
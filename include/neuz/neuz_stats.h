@@ -0,0 +1,113 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_stats.h
+ * \brief statistics of computation of neural networks.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_STATS_H__
+#define __NEUZ_STATS_H__
+
+#include <neuz/neuz_misc.h>
+
+__BEGIN_DECLS
+
+/*! \brief phases of computation of neural networks */
+enum{
+  NZ_STATS_PROPAGATE = 0, /* forward propagation */
+  NZ_STATS_BACKPROPAGATE, /* back-propagation */
+  NZ_STATS_TRAIN,         /* update of weights and biases */
+  NZ_STATS_PHASE_NUM
+};
+
+/*! \brief statistics of a neuron group */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzGroupStats ){
+  int nneuron;                       /* number of neurons */
+  int nconn;                         /* number of connections to the group */
+  const char *activator;             /* type string of the activator */
+  double time[NZ_STATS_PHASE_NUM];   /* accumulated wall time in seconds */
+  long calls[NZ_STATS_PHASE_NUM];    /* number of calls */
+  double madd[NZ_STATS_PHASE_NUM];   /* number of multiply-add operations */
+};
+
+/*! \brief statistics of a neural network
+ *
+ * statistics of a neural network consist of wall time, the number of
+ * calls and the number of multiply-add operations of each neuron
+ * group in each phase, namely, forward propagation, back-propagation
+ * and update of weights and biases. They are recorded while attached
+ * to a network by nzNetSetStats().
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzNetStats ){
+  int size;            /* number of neuron groups */
+  nzGroupStats *group; /* statistics of groups */
+#ifdef __cplusplus
+  nzNetStats() : size{0}, group{NULL} {}
+  void init();
+  void destroy();
+  void reset();
+  double totalTime(int phase);
+  void fprint(FILE *fp);
+#endif /* __cplusplus */
+};
+
+/*! \brief current time of a monotonic clock in seconds. */
+__NEUZ_EXPORT double nzStatsClock(void);
+
+/*! \brief initialize statistics of a neural network. */
+__NEUZ_EXPORT void nzNetStatsInit(nzNetStats *stats);
+
+/*! \brief allocate statistics of a neural network for a given number of groups.
+ *
+ * nzNetStatsAlloc() allocates \a stats for \a size neuron groups with
+ * zero counters. It is called by nzNetSetStats().
+ * Since arrays previously allocated for \a stats are freed, \a stats
+ * has to be initialized by nzNetStatsInit() in advance.
+ * \return
+ * false is returned if it fails to allocate memory. Otherwise, true is
+ * returned.
+ */
+__NEUZ_EXPORT bool nzNetStatsAlloc(nzNetStats *stats, int size);
+
+/*! \brief destroy statistics of a neural network. */
+__NEUZ_EXPORT void nzNetStatsDestroy(nzNetStats *stats);
+
+/*! \brief reset counters of statistics of a neural network. */
+__NEUZ_EXPORT void nzNetStatsReset(nzNetStats *stats);
+
+/*! \brief record a call of a phase of a neuron group.
+ *
+ * nzNetStatsRecord() adds time elapsed from \a t0, which is a value of
+ * nzStatsClock(), and multiply-add operations of the phase \a phase of
+ * the \a gid-th group to \a stats, and counts up the number of calls.
+ * Multiply-add operations are estimated from the number of connections
+ * nconn and neurons nneuron of the group, namely, nconn for forward
+ * propagation, 2 nconn for back-propagation and nconn + nneuron for
+ * update. Groups out of range are ignored.
+ */
+__NEUZ_EXPORT void nzNetStatsRecord(nzNetStats *stats, int gid, int phase, double t0);
+
+/*! \brief total wall time of a phase over neuron groups. */
+__NEUZ_EXPORT double nzNetStatsTotalTime(nzNetStats *stats, int phase);
+
+/*! \brief print statistics of a neural network.
+ *
+ * nzNetStatsFPrint() prints a table of the statistics of each group,
+ * which contains the size, the activator, the number of calls, the
+ * total wall time, the mean time per call and the throughput of
+ * multiply-add operations of each phase.
+ */
+__NEUZ_EXPORT void nzNetStatsFPrint(FILE *fp, nzNetStats *stats);
+
+#ifdef __cplusplus
+inline void nzNetStats::init(){ nzNetStatsInit( this ); }
+inline void nzNetStats::destroy(){ nzNetStatsDestroy( this ); }
+inline void nzNetStats::reset(){ nzNetStatsReset( this ); }
+inline double nzNetStats::totalTime(int phase){ return nzNetStatsTotalTime( this, phase ); }
+inline void nzNetStats::fprint(FILE *fp){ nzNetStatsFPrint( fp, this ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_STATS_H__ */
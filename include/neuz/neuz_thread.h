@@ -0,0 +1,88 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_thread.h
+ * \brief thread pool.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_THREAD_H__
+#define __NEUZ_THREAD_H__
+
+#include <neuz/neuz_misc.h>
+#include <pthread.h>
+
+__BEGIN_DECLS
+
+ZDECL_STRUCT( nzThreadPool );
+
+/*! \brief worker thread of a thread pool */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzThreadWorker ){
+  nzThreadPool *pool; /* thread pool that the worker belongs to */
+  int id;             /* identifier of the worker */
+  pthread_t thread;   /* thread handle */
+};
+
+/*! \brief thread pool class
+ *
+ * a thread pool keeps a set of persistent threads, and lets all of
+ * them run the same task function in parallel. The thread that calls
+ * nzThreadPoolRun() works as the 0th worker, so that a pool of size 1
+ * runs the task without any other thread.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzThreadPool ){
+  int size;                      /* number of workers including the caller */
+  nzThreadWorker *worker;        /* array of workers except the caller */
+  pthread_mutex_t mutex;         /* lock of the following members */
+  pthread_cond_t cond_task;      /* signal of a new task */
+  pthread_cond_t cond_done;      /* signal of completion of a task */
+  void (* task)(void *, int);    /* task function */
+  void *arg;                     /* argument of the task function */
+  unsigned long generation;      /* number of tasks issued */
+  int nrunning;                  /* number of workers running the current task */
+  bool quit;                     /* request to quit */
+#ifdef __cplusplus
+  nzThreadPool() : size{0}, worker{NULL} {}
+  nzThreadPool *create(int size);
+  void destroy();
+  void run(void (* task)(void *, int), void *arg);
+#endif /* __cplusplus */
+};
+
+/*! \brief number of processors available. */
+__NEUZ_EXPORT int nzThreadNumProcessors(void);
+
+/*! \brief create a thread pool.
+ *
+ * nzThreadPoolCreate() creates a thread pool \a pool of \a size
+ * workers, \a size-1 of which are spawned as threads. If \a size is
+ * less than 1, the number of available processors is used instead.
+ * \return
+ * a pointer \a pool is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzThreadPool *nzThreadPoolCreate(nzThreadPool *pool, int size);
+
+/*! \brief destroy a thread pool to join all threads. */
+__NEUZ_EXPORT void nzThreadPoolDestroy(nzThreadPool *pool);
+
+/*! \brief run a task on every worker of a thread pool.
+ *
+ * nzThreadPoolRun() calls \a task with \a arg and the identifier of
+ * each worker ranging from 0 to the size of \a pool minus 1 in
+ * parallel, and returns after all of them finish.
+ */
+__NEUZ_EXPORT void nzThreadPoolRun(nzThreadPool *pool, void (* task)(void *, int), void *arg);
+
+/*! \brief the beginning of the i-th out of n partitions of a range of size. */
+#define nzThreadPartition(size,i,n) ( (int)( (long)(size) * (i) / (n) ) )
+
+#ifdef __cplusplus
+inline nzThreadPool *nzThreadPool::create(int size){ return nzThreadPoolCreate( this, size ); }
+inline void nzThreadPool::destroy(){ nzThreadPoolDestroy( this ); }
+inline void nzThreadPool::run(void (* task)(void *, int), void *arg){ nzThreadPoolRun( this, task, arg ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_THREAD_H__ */
@@ -0,0 +1,90 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ */
+/*! \file neuz_trainer.h
+ * \brief data-parallel trainer of a compiled dense-layer network.
+ * \author Zhidao
+ */
+
+#ifndef __NEUZ_TRAINER_H__
+#define __NEUZ_TRAINER_H__
+
+#include <neuz/neuz_dense.h>
+#include <neuz/neuz_thread.h>
+
+__BEGIN_DECLS
+
+/*! \brief data-parallel trainer class
+ *
+ * a trainer splits a batch of samples into chunks of successive rows,
+ * and back-propagates them in parallel. Each worker has a replica of
+ * the network created by nzDenseNetShare(), which shares weights and
+ * biases with the original and has its own gradients and values of
+ * layers. Gradients of the workers are then added to those of the
+ * original network in the order of workers, so that the result does
+ * not depend on the timing of threads.
+ */
+ZDEF_STRUCT( __NEUZ_CLASS_EXPORT, nzDenseTrainer ){
+  nzDenseNet *dn;       /* compiled network to be trained */
+  nzThreadPool pool;    /* thread pool */
+  nzDenseNet *replica;  /* replicas of the network for workers */
+  /* arguments of the current task */
+  const double *_input;
+  const double *_des;
+  int _n;
+  double (* _lossgrad)(zVec,zVec,int);
+  bool *_ret;
+#ifdef __cplusplus
+  nzDenseTrainer() : dn{NULL}, replica{NULL}, _ret{NULL} {}
+  nzDenseTrainer *create(nzDenseNet *dn, int nthread);
+  void destroy();
+  int numThreads() const;
+  bool backpropagateBatch(zMat input, zMat des, double (* lossgrad)(zVec,zVec,int));
+#endif /* __cplusplus */
+};
+
+#define nzDenseTrainerNumThreads(tr) (tr)->pool.size
+
+/*! \brief create a data-parallel trainer of a compiled dense-layer network.
+ *
+ * nzDenseTrainerCreate() creates a trainer \a tr of \a dn which runs
+ * \a nthread threads. If \a nthread is less than 1, the number of
+ * available processors is used instead.
+ * \a dn must not be recompiled or destroyed until \a tr is destroyed.
+ * \return
+ * a pointer \a tr is returned if it succeeds. Otherwise, the null
+ * pointer is returned.
+ */
+__NEUZ_EXPORT nzDenseTrainer *nzDenseTrainerCreate(nzDenseTrainer *tr, nzDenseNet *dn, int nthread);
+
+/*! \brief destroy a data-parallel trainer. */
+__NEUZ_EXPORT void nzDenseTrainerDestroy(nzDenseTrainer *tr);
+
+/*! \brief back-propagate loss of a batch of samples in parallel.
+ *
+ * nzDenseTrainerBackPropagateBatch() does the same with
+ * nzDenseNetBackPropagateBatch() applied to the network of \a tr,
+ * namely, gradients of weights and biases for a batch \a input and
+ * \a des are added to those of the network, while samples are
+ * processed in parallel. The result is identical with the serial
+ * version up to rounding errors, and is reproduced exactly for the
+ * same number of threads.
+ * Outputs of layers for the batch are left in the replicas, not in
+ * the network.
+ * \return
+ * false is returned if sizes of \a input and \a des mismatch with the
+ * network or it fails to allocate internal workspace. Otherwise, true
+ * is returned.
+ */
+__NEUZ_EXPORT bool nzDenseTrainerBackPropagateBatch(nzDenseTrainer *tr, zMat input, zMat des, double (* lossgrad)(zVec,zVec,int));
+
+#ifdef __cplusplus
+inline nzDenseTrainer *nzDenseTrainer::create(nzDenseNet *dn, int nthread){ return nzDenseTrainerCreate( this, dn, nthread ); }
+inline void nzDenseTrainer::destroy(){ nzDenseTrainerDestroy( this ); }
+inline int nzDenseTrainer::numThreads() const { return nzDenseTrainerNumThreads( this ); }
+inline bool nzDenseTrainer::backpropagateBatch(zMat input, zMat des, double (* lossgrad)(zVec,zVec,int)){ return nzDenseTrainerBackPropagateBatch( this, input, des, lossgrad ); }
+#endif /* __cplusplus */
+
+__END_DECLS
+
+#endif /* __NEUZ_TRAINER_H__ */
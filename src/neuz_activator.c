@@ -4,26 +4,189 @@
  * activator functions.
  */
 
+#include <stdint.h>
 #include <neuz/neuz_activator.h>
 
+/* constants of exponential functions */
+#define NZ_EXP_MAX    709.0
+#define NZ_EXP_MIN   -708.0
+#define NZ_LOG2E     1.4426950408889634073599
+#define NZ_LN2_HI    6.93145751953125e-1
+#define NZ_LN2_LO    1.42860682030941723212e-6
+#define NZ_ROUND_MAGIC 6755399441055744.0 /* 1.5*2^52 */
+
+#ifdef __NEUZ_SIMD_X86
+#include <immintrin.h>
+
+/* load and store packed values of arrays, which are computed in double precision. */
+#ifdef __NEUZ_FLOAT32__
+#define _nzLoad2(p)    _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( (const __m128i *)(p) ) ) )
+#define _nzStore2(p,x) _mm_storel_epi64( (__m128i *)(p), _mm_castps_si128( _mm_cvtpd_ps( x ) ) )
+#define _nzLoad4(p)    _mm256_cvtps_pd( _mm_loadu_ps( p ) )
+#define _nzStore4(p,x) _mm_storeu_ps( p, _mm256_cvtpd_ps( x ) )
+#else
+#define _nzLoad2(p)    _mm_loadu_pd( p )
+#define _nzStore2(p,x) _mm_storeu_pd( p, x )
+#define _nzLoad4(p)    _mm256_loadu_pd( p )
+#define _nzStore4(p,x) _mm256_storeu_pd( p, x )
+#endif /* __NEUZ_FLOAT32__ */
+
+/* exponential function over packed doubles (Cephes' rational approximation). */
+
+#define NZ_EXP_P0    1.26177193074810590878e-4
+#define NZ_EXP_P1    3.02994407707441961300e-2
+#define NZ_EXP_P2    9.99999999999999999910e-1
+#define NZ_EXP_Q0    3.00198505138664455042e-6
+#define NZ_EXP_Q1    2.52448340349684104192e-3
+#define NZ_EXP_Q2    2.27265548208155028766e-1
+#define NZ_EXP_Q3    2.00000000000000000009e0
+
+__NZ_SSE2 static __m128d _nzExp2(__m128d x)
+{
+  __m128d t, n, xx, px, qx;
+
+  x = _mm_min_pd( _mm_max_pd( x, _mm_set1_pd(NZ_EXP_MIN) ), _mm_set1_pd(NZ_EXP_MAX) );
+  t = _mm_add_pd( _mm_mul_pd( x, _mm_set1_pd(NZ_LOG2E) ), _mm_set1_pd(NZ_ROUND_MAGIC) );
+  n = _mm_sub_pd( t, _mm_set1_pd(NZ_ROUND_MAGIC) );
+  x = _mm_sub_pd( x, _mm_mul_pd( n, _mm_set1_pd(NZ_LN2_HI) ) );
+  x = _mm_sub_pd( x, _mm_mul_pd( n, _mm_set1_pd(NZ_LN2_LO) ) );
+  xx = _mm_mul_pd( x, x );
+  px = _mm_add_pd( _mm_mul_pd( _mm_set1_pd(NZ_EXP_P0), xx ), _mm_set1_pd(NZ_EXP_P1) );
+  px = _mm_mul_pd( x, _mm_add_pd( _mm_mul_pd( px, xx ), _mm_set1_pd(NZ_EXP_P2) ) );
+  qx = _mm_add_pd( _mm_mul_pd( _mm_set1_pd(NZ_EXP_Q0), xx ), _mm_set1_pd(NZ_EXP_Q1) );
+  qx = _mm_add_pd( _mm_mul_pd( qx, xx ), _mm_set1_pd(NZ_EXP_Q2) );
+  qx = _mm_add_pd( _mm_mul_pd( qx, xx ), _mm_set1_pd(NZ_EXP_Q3) );
+  x = _mm_div_pd( px, _mm_sub_pd( qx, px ) );
+  x = _mm_add_pd( _mm_set1_pd(1.0), _mm_add_pd( x, x ) );
+  /* multiply 2^n by composing the exponent bits */
+  return _mm_mul_pd( x, _mm_castsi128_pd( _mm_slli_epi64( _mm_add_epi64( _mm_castpd_si128( t ), _mm_set1_epi64x(1023) ), 52 ) ) );
+}
+
+__NZ_AVX2 static __m256d _nzExp4(__m256d x)
+{
+  __m256d t, n, xx, px, qx;
+
+  x = _mm256_min_pd( _mm256_max_pd( x, _mm256_set1_pd(NZ_EXP_MIN) ), _mm256_set1_pd(NZ_EXP_MAX) );
+  t = _mm256_fmadd_pd( x, _mm256_set1_pd(NZ_LOG2E), _mm256_set1_pd(NZ_ROUND_MAGIC) );
+  n = _mm256_sub_pd( t, _mm256_set1_pd(NZ_ROUND_MAGIC) );
+  x = _mm256_fnmadd_pd( n, _mm256_set1_pd(NZ_LN2_HI), x );
+  x = _mm256_fnmadd_pd( n, _mm256_set1_pd(NZ_LN2_LO), x );
+  xx = _mm256_mul_pd( x, x );
+  px = _mm256_fmadd_pd( _mm256_set1_pd(NZ_EXP_P0), xx, _mm256_set1_pd(NZ_EXP_P1) );
+  px = _mm256_mul_pd( x, _mm256_fmadd_pd( px, xx, _mm256_set1_pd(NZ_EXP_P2) ) );
+  qx = _mm256_fmadd_pd( _mm256_set1_pd(NZ_EXP_Q0), xx, _mm256_set1_pd(NZ_EXP_Q1) );
+  qx = _mm256_fmadd_pd( qx, xx, _mm256_set1_pd(NZ_EXP_Q2) );
+  qx = _mm256_fmadd_pd( qx, xx, _mm256_set1_pd(NZ_EXP_Q3) );
+  x = _mm256_div_pd( px, _mm256_sub_pd( qx, px ) );
+  x = _mm256_add_pd( _mm256_set1_pd(1.0), _mm256_add_pd( x, x ) );
+  return _mm256_mul_pd( x, _mm256_castsi256_pd( _mm256_slli_epi64( _mm256_add_epi64( _mm256_castpd_si256( t ), _mm256_set1_epi64x(1023) ), 52 ) ) );
+}
+
+/* log(1+t) for 0<=t<=1 over packed doubles by the series of 2 atanh(t/(2+t)). */
+
+#define NZ_LOG1P_ORDER 16
+
+__NZ_SSE2 static __m128d _nzLog1pUnit2(__m128d t)
+{
+  __m128d s, ss, r;
+  int k;
+
+  s = _mm_div_pd( t, _mm_add_pd( t, _mm_set1_pd(2.0) ) );
+  ss = _mm_mul_pd( s, s );
+  r = _mm_set1_pd( 1.0/(2*NZ_LOG1P_ORDER+1) );
+  for( k=NZ_LOG1P_ORDER-1; k>=0; k-- )
+    r = _mm_add_pd( _mm_mul_pd( r, ss ), _mm_set1_pd( 1.0/(2*k+1) ) );
+  return _mm_mul_pd( _mm_add_pd( s, s ), r );
+}
+
+__NZ_AVX2 static __m256d _nzLog1pUnit4(__m256d t)
+{
+  __m256d s, ss, r;
+  int k;
+
+  s = _mm256_div_pd( t, _mm256_add_pd( t, _mm256_set1_pd(2.0) ) );
+  ss = _mm256_mul_pd( s, s );
+  r = _mm256_set1_pd( 1.0/(2*NZ_LOG1P_ORDER+1) );
+  for( k=NZ_LOG1P_ORDER-1; k>=0; k-- )
+    r = _mm256_fmadd_pd( r, ss, _mm256_set1_pd( 1.0/(2*k+1) ) );
+  return _mm256_mul_pd( _mm256_add_pd( s, s ), r );
+}
+
+/* absolute values of packed doubles. */
+#define _nzAbs2(x) _mm_andnot_pd( _mm_set1_pd(-0.0), x )
+#define _nzAbs4(x) _mm256_andnot_pd( _mm256_set1_pd(-0.0), x )
+
+/* define array operations of a function for each SIMD instruction set. */
+#define _NZ_ACTIVATOR_SIMD_ARRAY(func) \
+__NZ_SSE2 static void func##SSE2(const nzReal x[], nzReal y[], int n){\
+  int i;\
+  for( i=0; i<=n-2; i+=2 ) _nzStore2( y+i, func##2( _nzLoad2( x+i ) ) );\
+  for( ; i<n; i++ ) y[i] = func( x[i] );\
+}\
+__NZ_AVX2 static void func##AVX2(const nzReal x[], nzReal y[], int n){\
+  int i;\
+  for( i=0; i<=n-4; i+=4 ) _nzStore4( y+i, func##4( _nzLoad4( x+i ) ) );\
+  for( ; i<n; i++ ) y[i] = func( x[i] );\
+}
+#define _NZ_ACTIVATOR_SIMD_DISPATCH(func,x,y,n) do{\
+  switch( nzSIMDLevel() ){\
+  case NZ_SIMD_AVX2: func##AVX2( x, y, n ); return;\
+  case NZ_SIMD_SSE2: func##SSE2( x, y, n ); return;\
+  default: ;\
+  }\
+} while(0)
+#else
+#define _NZ_ACTIVATOR_SIMD_ARRAY(func)
+#define _NZ_ACTIVATOR_SIMD_DISPATCH(func,x,y,n)
+#endif /* __NEUZ_SIMD_X86 */
+
+/* define an array operation of a function, which dispatches SIMD kernels. */
+#define _NZ_ACTIVATOR_ARRAY(func) \
+_NZ_ACTIVATOR_SIMD_ARRAY(func) \
+static void func##Array(const nzReal x[], nzReal y[], int n){\
+  int i;\
+  _NZ_ACTIVATOR_SIMD_DISPATCH( func, x, y, n );\
+  for( i=0; i<n; i++ ) y[i] = func( x[i] );\
+}
+
 /* identity function */
 static double _nzActivatorIdent(double val){ return val; }
 static double _nzActivatorIdentDif(double val){ return 1; }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorIdent2(__m128d x){ return x; }
+__NZ_SSE2 static __m128d _nzActivatorIdentDif2(__m128d x){ return _mm_set1_pd(1.0); }
+__NZ_AVX2 static __m256d _nzActivatorIdent4(__m256d x){ return x; }
+__NZ_AVX2 static __m256d _nzActivatorIdentDif4(__m256d x){ return _mm256_set1_pd(1.0); }
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorIdent )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorIdentDif )
 
 nzActivator nz_activator_ident = {
   "identity",
   _nzActivatorIdent,
-  _nzActivatorIdentDif
+  _nzActivatorIdentDif,
+  _nzActivatorIdentArray,
+  _nzActivatorIdentDifArray,
 };
 
 /* step function */
 static double _nzActivatorStep(double val){ return val >= 0 ? 1 : 0; }
 static double _nzActivatorStepDif(double val){ return 0; /* case val=0 is ignored. */ }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorStep2(__m128d x){ return _mm_and_pd( _mm_cmpge_pd( x, _mm_setzero_pd() ), _mm_set1_pd(1.0) ); }
+__NZ_SSE2 static __m128d _nzActivatorStepDif2(__m128d x){ return _mm_setzero_pd(); }
+__NZ_AVX2 static __m256d _nzActivatorStep4(__m256d x){ return _mm256_and_pd( _mm256_cmp_pd( x, _mm256_setzero_pd(), _CMP_GE_OQ ), _mm256_set1_pd(1.0) ); }
+__NZ_AVX2 static __m256d _nzActivatorStepDif4(__m256d x){ return _mm256_setzero_pd(); }
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorStep )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorStepDif )
 
 nzActivator nz_activator_step = {
   "step",
   _nzActivatorStep,
-  _nzActivatorStepDif
+  _nzActivatorStepDif,
+  _nzActivatorStepArray,
+  _nzActivatorStepDifArray,
 };
 
 /* sigmoid function */
@@ -33,43 +196,440 @@ static double _nzActivatorSigmoidDif(double val){
   u = exp( -4*val );
   return 4 * u / zSqr( 1 + u );
 }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorSigmoid2(__m128d x){
+  return _mm_div_pd( _mm_set1_pd(1.0), _mm_add_pd( _mm_set1_pd(1.0), _nzExp2( _mm_mul_pd( x, _mm_set1_pd(-4.0) ) ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorSigmoidDif2(__m128d x){
+  __m128d u, v;
+  u = _nzExp2( _mm_mul_pd( x, _mm_set1_pd(-4.0) ) );
+  v = _mm_add_pd( _mm_set1_pd(1.0), u );
+  return _mm_mul_pd( _mm_div_pd( u, v ), _mm_div_pd( _mm_set1_pd(4.0), v ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoid4(__m256d x){
+  return _mm256_div_pd( _mm256_set1_pd(1.0), _mm256_add_pd( _mm256_set1_pd(1.0), _nzExp4( _mm256_mul_pd( x, _mm256_set1_pd(-4.0) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoidDif4(__m256d x){
+  __m256d u, v;
+  u = _nzExp4( _mm256_mul_pd( x, _mm256_set1_pd(-4.0) ) );
+  v = _mm256_add_pd( _mm256_set1_pd(1.0), u );
+  return _mm256_mul_pd( _mm256_div_pd( u, v ), _mm256_div_pd( _mm256_set1_pd(4.0), v ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoid )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoidDif )
 
 nzActivator nz_activator_sigmoid = {
   "sigmoid",
   _nzActivatorSigmoid,
-  _nzActivatorSigmoidDif
+  _nzActivatorSigmoidDif,
+  _nzActivatorSigmoidArray,
+  _nzActivatorSigmoidDifArray,
 };
 
 /* rectified linear unit function */
 static double _nzActivatorReLU(double val){ return zMax( val, 0 ); }
 static double _nzActivatorReLUDif(double val){ return val >= 0 ? 1 : 0; /* case val=0 is ignored. */ }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorReLU2(__m128d x){ return _mm_max_pd( x, _mm_setzero_pd() ); }
+__NZ_SSE2 static __m128d _nzActivatorReLUDif2(__m128d x){ return _nzActivatorStep2( x ); }
+__NZ_AVX2 static __m256d _nzActivatorReLU4(__m256d x){ return _mm256_max_pd( x, _mm256_setzero_pd() ); }
+__NZ_AVX2 static __m256d _nzActivatorReLUDif4(__m256d x){ return _nzActivatorStep4( x ); }
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorReLU )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorReLUDif )
 
 nzActivator nz_activator_relu = {
   "relu",
   _nzActivatorReLU,
-  _nzActivatorReLUDif
+  _nzActivatorReLUDif,
+  _nzActivatorReLUArray,
+  _nzActivatorReLUDifArray,
 };
 
 /* blunt ReLU */
 static double _nzActivatorBluntReLU(double val){ return 0.5 * ( val + sqrt( val*val + 1 ) ); }
 static double _nzActivatorBluntReLUDif(double val){ return 0.5 + 0.5*val / sqrt( val*val + 1 ); }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorBluntReLU2(__m128d x){
+  return _mm_mul_pd( _mm_set1_pd(0.5), _mm_add_pd( x, _mm_sqrt_pd( _mm_add_pd( _mm_mul_pd( x, x ), _mm_set1_pd(1.0) ) ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorBluntReLUDif2(__m128d x){
+  return _mm_add_pd( _mm_set1_pd(0.5), _mm_div_pd( _mm_mul_pd( _mm_set1_pd(0.5), x ), _mm_sqrt_pd( _mm_add_pd( _mm_mul_pd( x, x ), _mm_set1_pd(1.0) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorBluntReLU4(__m256d x){
+  return _mm256_mul_pd( _mm256_set1_pd(0.5), _mm256_add_pd( x, _mm256_sqrt_pd( _mm256_fmadd_pd( x, x, _mm256_set1_pd(1.0) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorBluntReLUDif4(__m256d x){
+  return _mm256_add_pd( _mm256_set1_pd(0.5), _mm256_div_pd( _mm256_mul_pd( _mm256_set1_pd(0.5), x ), _mm256_sqrt_pd( _mm256_fmadd_pd( x, x, _mm256_set1_pd(1.0) ) ) ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorBluntReLU )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorBluntReLUDif )
 
 nzActivator nz_activator_blunt_relu = {
   "bluntrelu",
   _nzActivatorBluntReLU,
-  _nzActivatorBluntReLUDif
+  _nzActivatorBluntReLUDif,
+  _nzActivatorBluntReLUArray,
+  _nzActivatorBluntReLUDifArray,
 };
 
 /* softplus */
 static double _nzActivatorSoftplus(double val){ return log( 1 + exp(val) ); }
 static double _nzActivatorSoftplusDif(double val){ return 1.0 / ( 1 + exp(-val) ); }
+#ifdef __NEUZ_SIMD_X86
+/* log(1+exp(x)) = max(x,0) + log(1+exp(-|x|)) to avoid overflow */
+__NZ_SSE2 static __m128d _nzActivatorSoftplus2(__m128d x){
+  return _mm_add_pd( _mm_max_pd( x, _mm_setzero_pd() ), _nzLog1pUnit2( _nzExp2( _mm_sub_pd( _mm_setzero_pd(), _nzAbs2( x ) ) ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorSoftplusDif2(__m128d x){
+  return _mm_div_pd( _mm_set1_pd(1.0), _mm_add_pd( _mm_set1_pd(1.0), _nzExp2( _mm_sub_pd( _mm_setzero_pd(), x ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSoftplus4(__m256d x){
+  return _mm256_add_pd( _mm256_max_pd( x, _mm256_setzero_pd() ), _nzLog1pUnit4( _nzExp4( _mm256_sub_pd( _mm256_setzero_pd(), _nzAbs4( x ) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSoftplusDif4(__m256d x){
+  return _mm256_div_pd( _mm256_set1_pd(1.0), _mm256_add_pd( _mm256_set1_pd(1.0), _nzExp4( _mm256_sub_pd( _mm256_setzero_pd(), x ) ) ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSoftplus )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSoftplusDif )
 
 nzActivator nz_activator_softplus = {
   "softplus",
   _nzActivatorSoftplus,
-  _nzActivatorSoftplusDif
+  _nzActivatorSoftplusDif,
+  _nzActivatorSoftplusArray,
+  _nzActivatorSoftplusDifArray,
 };
 
+/* fast approximate functions */
+
+/* exponential function by a polynomial of degree 5 after the reduction
+ * of the argument to [-log(2)/2,log(2)/2]. The relative error is less
+ * than 3.5e-6. */
+#define _nzExpFastPoly(r) ( 1 + (r)*( 1 + (r)*( 0.5 + (r)*( 1.0/6 + (r)*( 1.0/24 + (r)*( 1.0/120 ) ) ) ) ) )
+
+static double _nzExpFast(double x)
+{
+  union{ double d; int64_t i; } e;
+  double t, n;
+
+  x = zMin( zMax( x, NZ_EXP_MIN ), NZ_EXP_MAX );
+  t = x * NZ_LOG2E + NZ_ROUND_MAGIC;
+  n = t - NZ_ROUND_MAGIC;
+  x = ( x - n * NZ_LN2_HI ) - n * NZ_LN2_LO;
+  e.i = (int64_t)( n + 1023 ) << 52;
+  return e.d * _nzExpFastPoly( x );
+}
+
+/* log(1+u) for 0<=u<=1 by the series of 2 atanh(u/(2+u)) up to the
+ * 11th order. The absolute error is less than 1.0e-7. */
+static double _nzLog1pFast(double u)
+{
+  double s, ss;
+
+  s = u / ( u + 2 );
+  ss = s * s;
+  return 2 * s * ( 1 + ss*( 1.0/3 + ss*( 1.0/5 + ss*( 1.0/7 + ss*( 1.0/9 + ss*( 1.0/11 ) ) ) ) ) );
+}
+
+/* table of the sigmoid function 1/(1+exp(-u)) for u=k/NZ_SIGMOID_TABLE_DIV
+ * (k=0,...,NZ_SIGMOID_TABLE_SIZE+1). */
+#define NZ_SIGMOID_TABLE_DIV    8
+#define NZ_SIGMOID_TABLE_SIZE 160
+
+static const double _nz_sigmoid_table[NZ_SIGMOID_TABLE_SIZE+2] = {
+  0.5, 0.53120937337375629, 0.56217650088579807, 0.59266659995406967,
+  0.62245933120185459, 0.65135486466605419, 0.67917869917539297, 0.70578502783701125,
+  0.7310585786300049, 0.75491498686762826, 0.77729986117469108, 0.79818677773962121,
+  0.81757447619364365, 0.83548353710343692, 0.85195280196831058, 0.86703575980217062,
+  0.88079707797788231, 0.89330940605434872, 0.90465053510089055, 0.91490095499297974,
+  0.92414181997875655, 0.93245330886037092, 0.93991334982599239, 0.94659667020017568,
+  0.95257412682243336, 0.95791227208438112, 0.96267311265587063, 0.9669140216112958,
+  0.97068776924864364, 0.9740426428022031, 0.97702263008997436, 0.97966764665734118,
+  0.98201379003790845, 0.98409360828818526, 0.9859363729567544, 0.98756834914681413,
+  0.98901305736940681, 0.9902915235185259, 0.99142251458628805, 0.99242275873213925,
+  0.99330714907571527, 0.99408893114375618, 0.99477987430644166, 0.99539042782062592,
+  0.99592986228410396, 0.99640639741857984, 0.99682731715751483, 0.99719907303287891,
+  0.99752737684336534, 0.99781728355465471, 0.99807326533667251, 0.99829927758856485,
+  0.99849881774326299, 0.99867497758278678, 0.99883048973494448, 0.99896776896324524,
+  0.9990889488055994, 0.9991959140643708, 0.99929032960089947, 0.99937366584189047,
+  0.9994472213630764, 0.99951214287721779, 0.99956944291867544, 0.99962001548524804,
+  0.99966464986953363, 0.99970404288648695, 0.99973880968090434, 0.99976949327800679,
+  0.9997965730219448, 0.99982047203065327, 0.9998415637808975, 0.99986017792435278,
+  0.99987660542401369, 0.99989110308997342, 0.99990389758450049, 0.99991518895827647,
+  0.99992515377248947, 0.99993394785514544, 0.99994170873433885, 0.99994855778625791,
+  0.99995460213129761, 0.99995993630777091, 0.9999646437492582, 0.99996879808860606,
+  0.99997246430888531, 0.99997569975925682, 0.99997855505157918, 0.99998107485175403,
+  0.99998329857815205, 0.99998526101802543, 0.99998699287153348, 0.99998852123187298,
+  0.99998987000901918, 0.99999106030369511, 0.99999211073741379, 0.99999303774374992,
+  0.99999385582539779, 0.99999457778103007, 0.99999521490550514, 0.9999957771665553,
+  0.99999627336071584, 0.99999671125093459, 0.99999709768801481, 0.99999743871778934,
+  0.99999773967570205, 0.99999800527027849, 0.9999982396567868, 0.99999844650224534,
+  0.99999862904279302, 0.99999879013431647, 0.99999893229712988, 0.99999905775540621,
+  0.99999916847197223, 0.99999926617901935, 0.99999935240520166, 0.99999942849955303,
+  0.99999949565259183, 0.99999955491494807, 0.99999960721379977, 0.99999965336737895,
+  0.99999969409777301, 0.99999973004222253, 0.99999976176308991, 0.99999978975665904,
+  0.99999981446089814, 0.99999983626231359, 0.99999985550199622, 0.99999987248095712,
+  0.99999988746483792, 0.99999990068806677, 0.9999999123575255, 0.99999992265578697,
+  0.99999993174397095, 0.99999993976426527, 0.99999994684215021, 0.99999995308836209,
+  0.99999995860062441, 0.99999996346517928, 0.9999999677581336, 0.99999997154665266,
+  0.99999997489000902, 0.99999997784051065, 0.99999998044431926, 0.99999998274217228,
+  0.9999999847700205, 0.99999998655959033, 0.99999998813888002, 0.99999998953259828,
+  0.99999999076255042, 0.9999999918479795, 0.99999999280586693, 0.99999999365119985,
+  0.99999999439720355, 0.9999999950555496, 0.99999999563653774, 0.99999999614925805,
+  0.99999999660173211, 0.99999999700103914, 0.99999999735342637, 0.99999999766440695,
+  0.99999999793884631, 0.99999999818103835
+};
+
+/* sigmoid function 1/(1+exp(-u)) for u>=0 by the cubic Hermite
+ * interpolation of the table. The derivative at each node is given by
+ * y(1-y). The value is saturated for u beyond the table. */
+static double _nzSigmoidTableAbs(double u)
+{
+  double t, y0, y1, d0, d1, dy;
+  int k;
+
+  u = zMin( u * NZ_SIGMOID_TABLE_DIV, NZ_SIGMOID_TABLE_SIZE );
+  k = (int)u;
+  t = u - k;
+  y0 = _nz_sigmoid_table[k];
+  y1 = _nz_sigmoid_table[k+1];
+  d0 = y0 * ( 1 - y0 ) / NZ_SIGMOID_TABLE_DIV;
+  d1 = y1 * ( 1 - y1 ) / NZ_SIGMOID_TABLE_DIV;
+  dy = y1 - y0;
+  return y0 + t*( d0 + t*( 3*dy - 2*d0 - d1 + t*( d0 + d1 - 2*dy ) ) );
+}
+
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzExpFast2(__m128d x)
+{
+  __m128d t, n, p;
+
+  x = _mm_min_pd( _mm_max_pd( x, _mm_set1_pd(NZ_EXP_MIN) ), _mm_set1_pd(NZ_EXP_MAX) );
+  t = _mm_add_pd( _mm_mul_pd( x, _mm_set1_pd(NZ_LOG2E) ), _mm_set1_pd(NZ_ROUND_MAGIC) );
+  n = _mm_sub_pd( t, _mm_set1_pd(NZ_ROUND_MAGIC) );
+  x = _mm_sub_pd( x, _mm_mul_pd( n, _mm_set1_pd(NZ_LN2_HI) ) );
+  x = _mm_sub_pd( x, _mm_mul_pd( n, _mm_set1_pd(NZ_LN2_LO) ) );
+  p = _mm_add_pd( _mm_mul_pd( x, _mm_set1_pd(1.0/120) ), _mm_set1_pd(1.0/24) );
+  p = _mm_add_pd( _mm_mul_pd( x, p ), _mm_set1_pd(1.0/6) );
+  p = _mm_add_pd( _mm_mul_pd( x, p ), _mm_set1_pd(0.5) );
+  p = _mm_add_pd( _mm_mul_pd( x, p ), _mm_set1_pd(1.0) );
+  p = _mm_add_pd( _mm_mul_pd( x, p ), _mm_set1_pd(1.0) );
+  return _mm_mul_pd( p, _mm_castsi128_pd( _mm_slli_epi64( _mm_add_epi64( _mm_castpd_si128( t ), _mm_set1_epi64x(1023) ), 52 ) ) );
+}
+
+__NZ_AVX2 static __m256d _nzExpFast4(__m256d x)
+{
+  __m256d t, n, p;
+
+  x = _mm256_min_pd( _mm256_max_pd( x, _mm256_set1_pd(NZ_EXP_MIN) ), _mm256_set1_pd(NZ_EXP_MAX) );
+  t = _mm256_fmadd_pd( x, _mm256_set1_pd(NZ_LOG2E), _mm256_set1_pd(NZ_ROUND_MAGIC) );
+  n = _mm256_sub_pd( t, _mm256_set1_pd(NZ_ROUND_MAGIC) );
+  x = _mm256_fnmadd_pd( n, _mm256_set1_pd(NZ_LN2_HI), x );
+  x = _mm256_fnmadd_pd( n, _mm256_set1_pd(NZ_LN2_LO), x );
+  p = _mm256_fmadd_pd( x, _mm256_set1_pd(1.0/120), _mm256_set1_pd(1.0/24) );
+  p = _mm256_fmadd_pd( x, p, _mm256_set1_pd(1.0/6) );
+  p = _mm256_fmadd_pd( x, p, _mm256_set1_pd(0.5) );
+  p = _mm256_fmadd_pd( x, p, _mm256_set1_pd(1.0) );
+  p = _mm256_fmadd_pd( x, p, _mm256_set1_pd(1.0) );
+  return _mm256_mul_pd( p, _mm256_castsi256_pd( _mm256_slli_epi64( _mm256_add_epi64( _mm256_castpd_si256( t ), _mm256_set1_epi64x(1023) ), 52 ) ) );
+}
+
+__NZ_SSE2 static __m128d _nzLog1pFast2(__m128d u)
+{
+  __m128d s, ss, r;
+
+  s = _mm_div_pd( u, _mm_add_pd( u, _mm_set1_pd(2.0) ) );
+  ss = _mm_mul_pd( s, s );
+  r = _mm_add_pd( _mm_mul_pd( ss, _mm_set1_pd(1.0/11) ), _mm_set1_pd(1.0/9) );
+  r = _mm_add_pd( _mm_mul_pd( ss, r ), _mm_set1_pd(1.0/7) );
+  r = _mm_add_pd( _mm_mul_pd( ss, r ), _mm_set1_pd(1.0/5) );
+  r = _mm_add_pd( _mm_mul_pd( ss, r ), _mm_set1_pd(1.0/3) );
+  r = _mm_add_pd( _mm_mul_pd( ss, r ), _mm_set1_pd(1.0) );
+  return _mm_mul_pd( _mm_add_pd( s, s ), r );
+}
+
+__NZ_AVX2 static __m256d _nzLog1pFast4(__m256d u)
+{
+  __m256d s, ss, r;
+
+  s = _mm256_div_pd( u, _mm256_add_pd( u, _mm256_set1_pd(2.0) ) );
+  ss = _mm256_mul_pd( s, s );
+  r = _mm256_fmadd_pd( ss, _mm256_set1_pd(1.0/11), _mm256_set1_pd(1.0/9) );
+  r = _mm256_fmadd_pd( ss, r, _mm256_set1_pd(1.0/7) );
+  r = _mm256_fmadd_pd( ss, r, _mm256_set1_pd(1.0/5) );
+  r = _mm256_fmadd_pd( ss, r, _mm256_set1_pd(1.0/3) );
+  r = _mm256_fmadd_pd( ss, r, _mm256_set1_pd(1.0) );
+  return _mm256_mul_pd( _mm256_add_pd( s, s ), r );
+}
+
+/* the table is looked up lane by lane with SSE2, and is gathered with AVX2. */
+__NZ_SSE2 static __m128d _nzSigmoidTableAbs2(__m128d u)
+{
+  double v[2];
+
+  _mm_storeu_pd( v, u );
+  return _mm_set_pd( _nzSigmoidTableAbs( v[1] ), _nzSigmoidTableAbs( v[0] ) );
+}
+
+__NZ_AVX2 static __m256d _nzSigmoidTableAbs4(__m256d u)
+{
+  __m256d t, y0, y1, d0, d1, dy, p;
+  __m128i k;
+
+  u = _mm256_min_pd( _mm256_mul_pd( u, _mm256_set1_pd(NZ_SIGMOID_TABLE_DIV) ), _mm256_set1_pd(NZ_SIGMOID_TABLE_SIZE) );
+  k = _mm256_cvttpd_epi32( u );
+  t = _mm256_sub_pd( u, _mm256_cvtepi32_pd( k ) );
+  y0 = _mm256_i32gather_pd( _nz_sigmoid_table, k, 8 );
+  y1 = _mm256_i32gather_pd( _nz_sigmoid_table+1, k, 8 );
+  d0 = _mm256_mul_pd( _mm256_mul_pd( y0, _mm256_sub_pd( _mm256_set1_pd(1.0), y0 ) ), _mm256_set1_pd(1.0/NZ_SIGMOID_TABLE_DIV) );
+  d1 = _mm256_mul_pd( _mm256_mul_pd( y1, _mm256_sub_pd( _mm256_set1_pd(1.0), y1 ) ), _mm256_set1_pd(1.0/NZ_SIGMOID_TABLE_DIV) );
+  dy = _mm256_sub_pd( y1, y0 );
+  p = _mm256_sub_pd( _mm256_add_pd( d0, d1 ), _mm256_add_pd( dy, dy ) );
+  p = _mm256_fmadd_pd( t, p, _mm256_sub_pd( _mm256_mul_pd( dy, _mm256_set1_pd(3.0) ), _mm256_add_pd( _mm256_add_pd( d0, d0 ), d1 ) ) );
+  p = _mm256_fmadd_pd( t, p, d0 );
+  return _mm256_fmadd_pd( t, p, y0 );
+}
+#endif /* __NEUZ_SIMD_X86 */
+
+/* sigmoid function by the fast exponential function */
+static double _nzActivatorSigmoidFast(double val){ return 1.0 / ( 1 + _nzExpFast( -4*val ) ); }
+static double _nzActivatorSigmoidFastDif(double val){
+  double u;
+  u = _nzExpFast( -4*val );
+  return 4 * u / zSqr( 1 + u );
+}
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorSigmoidFast2(__m128d x){
+  return _mm_div_pd( _mm_set1_pd(1.0), _mm_add_pd( _mm_set1_pd(1.0), _nzExpFast2( _mm_mul_pd( x, _mm_set1_pd(-4.0) ) ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorSigmoidFastDif2(__m128d x){
+  __m128d u, v;
+  u = _nzExpFast2( _mm_mul_pd( x, _mm_set1_pd(-4.0) ) );
+  v = _mm_add_pd( _mm_set1_pd(1.0), u );
+  return _mm_div_pd( _mm_mul_pd( _mm_set1_pd(4.0), u ), _mm_mul_pd( v, v ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoidFast4(__m256d x){
+  return _mm256_div_pd( _mm256_set1_pd(1.0), _mm256_add_pd( _mm256_set1_pd(1.0), _nzExpFast4( _mm256_mul_pd( x, _mm256_set1_pd(-4.0) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoidFastDif4(__m256d x){
+  __m256d u, v;
+  u = _nzExpFast4( _mm256_mul_pd( x, _mm256_set1_pd(-4.0) ) );
+  v = _mm256_add_pd( _mm256_set1_pd(1.0), u );
+  return _mm256_div_pd( _mm256_mul_pd( _mm256_set1_pd(4.0), u ), _mm256_mul_pd( v, v ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoidFast )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoidFastDif )
+
+nzActivator nz_activator_sigmoid_fast = {
+  "sigmoid_fast",
+  _nzActivatorSigmoidFast,
+  _nzActivatorSigmoidFastDif,
+  _nzActivatorSigmoidFastArray,
+  _nzActivatorSigmoidFastDifArray,
+};
+
+/* sigmoid function by the table lookup */
+static double _nzActivatorSigmoidTable(double val){
+  double y;
+  y = _nzSigmoidTableAbs( fabs( 4*val ) );
+  return val >= 0 ? y : 1 - y;
+}
+static double _nzActivatorSigmoidTableDif(double val){
+  double y;
+  y = _nzSigmoidTableAbs( fabs( 4*val ) );
+  return 4 * y * ( 1 - y );
+}
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorSigmoidTable2(__m128d x){
+  __m128d y, mask;
+  y = _nzSigmoidTableAbs2( _nzAbs2( _mm_mul_pd( x, _mm_set1_pd(4.0) ) ) );
+  mask = _mm_cmpge_pd( x, _mm_setzero_pd() );
+  return _mm_or_pd( _mm_and_pd( mask, y ), _mm_andnot_pd( mask, _mm_sub_pd( _mm_set1_pd(1.0), y ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorSigmoidTableDif2(__m128d x){
+  __m128d y;
+  y = _nzSigmoidTableAbs2( _nzAbs2( _mm_mul_pd( x, _mm_set1_pd(4.0) ) ) );
+  return _mm_mul_pd( _mm_mul_pd( _mm_set1_pd(4.0), y ), _mm_sub_pd( _mm_set1_pd(1.0), y ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoidTable4(__m256d x){
+  __m256d y;
+  y = _nzSigmoidTableAbs4( _nzAbs4( _mm256_mul_pd( x, _mm256_set1_pd(4.0) ) ) );
+  return _mm256_blendv_pd( y, _mm256_sub_pd( _mm256_set1_pd(1.0), y ), _mm256_cmp_pd( x, _mm256_setzero_pd(), _CMP_LT_OQ ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSigmoidTableDif4(__m256d x){
+  __m256d y;
+  y = _nzSigmoidTableAbs4( _nzAbs4( _mm256_mul_pd( x, _mm256_set1_pd(4.0) ) ) );
+  return _mm256_mul_pd( _mm256_mul_pd( _mm256_set1_pd(4.0), y ), _mm256_sub_pd( _mm256_set1_pd(1.0), y ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoidTable )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSigmoidTableDif )
+
+nzActivator nz_activator_sigmoid_table = {
+  "sigmoid_table",
+  _nzActivatorSigmoidTable,
+  _nzActivatorSigmoidTableDif,
+  _nzActivatorSigmoidTableArray,
+  _nzActivatorSigmoidTableDifArray,
+};
+
+/* softplus by the fast exponential and logarithm functions */
+static double _nzActivatorSoftplusFast(double val){ return zMax( val, 0 ) + _nzLog1pFast( _nzExpFast( -fabs( val ) ) ); }
+static double _nzActivatorSoftplusFastDif(double val){ return 1.0 / ( 1 + _nzExpFast( -val ) ); }
+#ifdef __NEUZ_SIMD_X86
+__NZ_SSE2 static __m128d _nzActivatorSoftplusFast2(__m128d x){
+  return _mm_add_pd( _mm_max_pd( x, _mm_setzero_pd() ), _nzLog1pFast2( _nzExpFast2( _mm_sub_pd( _mm_setzero_pd(), _nzAbs2( x ) ) ) ) );
+}
+__NZ_SSE2 static __m128d _nzActivatorSoftplusFastDif2(__m128d x){
+  return _mm_div_pd( _mm_set1_pd(1.0), _mm_add_pd( _mm_set1_pd(1.0), _nzExpFast2( _mm_sub_pd( _mm_setzero_pd(), x ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSoftplusFast4(__m256d x){
+  return _mm256_add_pd( _mm256_max_pd( x, _mm256_setzero_pd() ), _nzLog1pFast4( _nzExpFast4( _mm256_sub_pd( _mm256_setzero_pd(), _nzAbs4( x ) ) ) ) );
+}
+__NZ_AVX2 static __m256d _nzActivatorSoftplusFastDif4(__m256d x){
+  return _mm256_div_pd( _mm256_set1_pd(1.0), _mm256_add_pd( _mm256_set1_pd(1.0), _nzExpFast4( _mm256_sub_pd( _mm256_setzero_pd(), x ) ) ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSoftplusFast )
+_NZ_ACTIVATOR_ARRAY( _nzActivatorSoftplusFastDif )
+
+nzActivator nz_activator_softplus_fast = {
+  "softplus_fast",
+  _nzActivatorSoftplusFast,
+  _nzActivatorSoftplusFastDif,
+  _nzActivatorSoftplusFastArray,
+  _nzActivatorSoftplusFastDifArray,
+};
+
+/* apply an activator function to an array. */
+void nzActivatorFArray(nzActivator *activator, const nzReal x[], nzReal y[], int n)
+{
+  int i;
+
+  if( activator->f_array ){
+    activator->f_array( x, y, n );
+    return;
+  }
+  for( i=0; i<n; i++ ) y[i] = activator->f( x[i] );
+}
+
+/* apply the derivative of an activator function to an array. */
+void nzActivatorDFArray(nzActivator *activator, const nzReal x[], nzReal y[], int n)
+{
+  int i;
+
+  if( activator->df_array ){
+    activator->df_array( x, y, n );
+    return;
+  }
+  for( i=0; i<n; i++ ) y[i] = activator->df( x[i] );
+}
+
 /* add the handle to the following list when you create a new activator function. */
 #define NZ_ACTIVATOR_ARRAY \
   nzActivator *_nz_activator[] = {\
@@ -79,6 +639,9 @@ nzActivator nz_activator_softplus = {
     &nz_activator_relu,\
     &nz_activator_blunt_relu,\
     &nz_activator_softplus,\
+    &nz_activator_sigmoid_fast,\
+    &nz_activator_sigmoid_table,\
+    &nz_activator_softplus_fast,\
     NULL,\
   }
 
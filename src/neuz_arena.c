@@ -0,0 +1,67 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * arena allocator.
+ */
+
+#include <neuz/neuz_arena.h>
+
+#define NZ_ARENA_ALIGN          16
+#define NZ_ARENA_BLOCK_SIZE_MIN 4096
+#define NZ_ARENA_BLOCK_SIZE_MAX 0x200000
+
+#define _nzArenaAlign(size)      ( ( (size) + NZ_ARENA_ALIGN - 1 ) & ~(size_t)( NZ_ARENA_ALIGN - 1 ) )
+#define _nzArenaBlockHeaderSize  _nzArenaAlign( sizeof(nzArenaBlock) )
+#define _nzArenaBlockBuf(block)  ( (char *)(block) + _nzArenaBlockHeaderSize )
+
+/* initialize an arena. */
+void nzArenaInit(nzArena *arena)
+{
+  arena->block = NULL;
+  arena->blocksize = NZ_ARENA_BLOCK_SIZE_MIN;
+}
+
+/* add a new block to an arena. */
+static nzArenaBlock *_nzArenaAddBlock(nzArena *arena, size_t size)
+{
+  nzArenaBlock *block;
+
+  if( arena->blocksize < NZ_ARENA_BLOCK_SIZE_MIN ) arena->blocksize = NZ_ARENA_BLOCK_SIZE_MIN;
+  size = zMax( size, arena->blocksize );
+  if( !( block = (nzArenaBlock *)zAlloc( char, _nzArenaBlockHeaderSize + size ) ) ){
+    ZALLOCERROR();
+    return NULL;
+  }
+  block->size = size;
+  block->used = 0;
+  block->next = arena->block;
+  arena->block = block;
+  if( arena->blocksize < NZ_ARENA_BLOCK_SIZE_MAX ) arena->blocksize *= 2;
+  return block;
+}
+
+/* allocate a zero-cleared memory from an arena. */
+void *nzArenaAlloc(nzArena *arena, size_t size)
+{
+  nzArenaBlock *block;
+  void *mem;
+
+  size = _nzArenaAlign( size );
+  if( !( block = arena->block ) || block->used + size > block->size )
+    if( !( block = _nzArenaAddBlock( arena, size ) ) ) return NULL;
+  mem = _nzArenaBlockBuf(block) + block->used;
+  block->used += size;
+  return mem;
+}
+
+/* destroy an arena to release all allocated objects at once. */
+void nzArenaDestroy(nzArena *arena)
+{
+  nzArenaBlock *block;
+
+  while( ( block = arena->block ) ){
+    arena->block = block->next;
+    free( block );
+  }
+  nzArenaInit( arena );
+}
@@ -0,0 +1,526 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * binary dataset of training samples.
+ */
+
+#define _DEFAULT_SOURCE
+#include <neuz/neuz_dataset.h>
+#include <neuz/neuz_errmsg.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+
+/* dataset files are mapped to memory on POSIX systems. */
+#if defined(__unix__) || defined(__APPLE__)
+#define __NEUZ_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif /* __unix__ || __APPLE__ */
+
+#define NZ_DATASET_MAGIC     "NEUZDAT"
+#define NZ_DATASET_BYTEORDER 0x01020304
+
+/* header of a binary dataset file. */
+typedef struct{
+  char magic[8];      /* NZ_DATASET_MAGIC */
+  uint32_t version;   /* NZ_DATASET_VERSION */
+  uint32_t byteorder; /* NZ_DATASET_BYTEORDER in the byte order of the writer */
+  uint32_t realsize;  /* size of an element in bytes */
+  uint32_t ninput;    /* number of inputs of a sample */
+  uint32_t noutput;   /* number of desired outputs of a sample */
+  uint32_t _pad;
+  uint64_t nsample;   /* number of samples */
+  uint64_t offset;    /* offset of samples from the head of the file */
+} _nzDatasetHeader;
+
+/* offset of samples in a binary dataset file. */
+#define _nzDatasetOffset() \
+  ( ( sizeof(_nzDatasetHeader) + NZ_DATASET_ALIGN - 1 ) / NZ_DATASET_ALIGN * NZ_DATASET_ALIGN )
+
+/* writer */
+
+/* write the header of a binary dataset file. */
+static bool _nzDatasetWriterHeader(nzDatasetWriter *writer)
+{
+  _nzDatasetHeader header;
+  size_t pos;
+
+  memset( &header, 0, sizeof(header) );
+  strcpy( header.magic, NZ_DATASET_MAGIC );
+  header.version = NZ_DATASET_VERSION;
+  header.byteorder = NZ_DATASET_BYTEORDER;
+  header.realsize = writer->realsize;
+  header.ninput = writer->ninput;
+  header.noutput = writer->noutput;
+  header.nsample = writer->nsample;
+  header.offset = _nzDatasetOffset();
+  if( fseek( writer->_fp, 0, SEEK_SET ) != 0 ||
+      fwrite( &header, sizeof(header), 1, writer->_fp ) != 1 ) return false;
+  for( pos=sizeof(header); pos<header.offset; pos++ )
+    if( fputc( 0, writer->_fp ) == EOF ) return false;
+  return true;
+}
+
+/* open a binary dataset file to write. */
+nzDatasetWriter *nzDatasetWriterOpen(nzDatasetWriter *writer, const char filename[], int ninput, int noutput, int realsize)
+{
+  writer->_fp = NULL;
+  writer->ninput = ninput;
+  writer->noutput = noutput;
+  writer->realsize = realsize;
+  writer->nsample = 0;
+  writer->_row = NULL;
+  writer->_ok = true;
+  if( ninput < 0 || noutput < 0 || ninput + noutput < 1 ||
+      ( realsize != sizeof(float) && realsize != sizeof(double) ) ){
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID_SIZE, ninput, noutput, realsize );
+    return NULL;
+  }
+  if( !( writer->_fp = fopen( filename, "wb" ) ) ){
+    ZOPENERROR( filename );
+    return NULL;
+  }
+  if( !( writer->_row = zAlloc( char, (size_t)realsize * ( ninput + noutput ) ) ) ){
+    ZALLOCERROR();
+    goto FAILURE;
+  }
+  if( !_nzDatasetWriterHeader( writer ) ){
+    ZRUNERROR( NEUZ_ERR_DATASET_WRITE, filename );
+    goto FAILURE;
+  }
+  return writer;
+
+ FAILURE:
+  fclose( writer->_fp );
+  writer->_fp = NULL;
+  zFree( writer->_row );
+  return NULL;
+}
+
+/* append a sample to a binary dataset file. */
+bool nzDatasetWriterAdd(nzDatasetWriter *writer, const double input[], const double des[])
+{
+  int i, n;
+
+  n = writer->ninput + writer->noutput;
+  if( writer->realsize == sizeof(float) ){
+    for( i=0; i<writer->ninput; i++ ) ((float *)writer->_row)[i] = input[i];
+    for( i=0; i<writer->noutput; i++ ) ((float *)writer->_row)[writer->ninput+i] = des[i];
+  } else{
+    for( i=0; i<writer->ninput; i++ ) ((double *)writer->_row)[i] = input[i];
+    for( i=0; i<writer->noutput; i++ ) ((double *)writer->_row)[writer->ninput+i] = des[i];
+  }
+  if( fwrite( writer->_row, writer->realsize, n, writer->_fp ) != (size_t)n ) return writer->_ok = false;
+  writer->nsample++;
+  return true;
+}
+
+/* close a binary dataset file. */
+bool nzDatasetWriterClose(nzDatasetWriter *writer)
+{
+  bool ret;
+
+  if( !writer->_fp ) return false;
+  ret = writer->_ok && _nzDatasetWriterHeader( writer );
+  if( fclose( writer->_fp ) != 0 ) ret = false;
+  writer->_fp = NULL;
+  zFree( writer->_row );
+  return ret;
+}
+
+/* read values of a line of a text file separated by commas, semicolons, tabs or spaces.
+ * the number of values is returned, which is n+1 if the line has more than n values. */
+static int _nzDatasetParseLine(char *line, double val[], int n)
+{
+  char *cp, *ep;
+  int i;
+
+  for( cp=line, i=0; ; i++ ){
+    while( *cp == ',' || *cp == ';' || isspace( (unsigned char)*cp ) ) cp++;
+    if( *cp == '\0' ) break;
+    if( i >= n ) return n + 1;
+    val[i] = strtod( cp, &ep );
+    if( ep == cp ) return -1;
+    cp = ep;
+  }
+  return i;
+}
+
+/* convert a text file of samples to a binary dataset file. */
+long nzDatasetConvertText(const char textfile[], const char binfile[], int ninput, int noutput, int realsize)
+{
+  FILE *fp;
+  nzDatasetWriter writer;
+  char buf[BUFSIZ], *line = NULL, *cp;
+  size_t len, size = 0;
+  double *val = NULL;
+  long lineno = 0, nsample = -1;
+  int n;
+
+  if( !( fp = fopen( textfile, "r" ) ) ){
+    ZOPENERROR( textfile );
+    return -1;
+  }
+  if( !nzDatasetWriterOpen( &writer, binfile, ninput, noutput, realsize ) ) goto TERMINATE;
+  if( !( val = zAlloc( double, ninput + noutput ) ) ){
+    ZALLOCERROR();
+    goto TERMINATE;
+  }
+  while( 1 ){
+    /* read a line of an arbitrary length */
+    for( len=0; fgets( buf, BUFSIZ, fp ); ){
+      n = strlen( buf );
+      if( len + n + 1 > size ){
+        size = ( len + n + 1 ) * 2;
+        if( !( cp = zRealloc( line, char, size ) ) ){
+          ZALLOCERROR();
+          goto TERMINATE;
+        }
+        line = cp;
+      }
+      memcpy( line + len, buf, n + 1 );
+      len += n;
+      if( line[len-1] == '\n' ) break;
+    }
+    if( len == 0 ) break;
+    lineno++;
+    for( cp=line; isspace( (unsigned char)*cp ); cp++ );
+    if( *cp == '\0' || *cp == '#' ) continue;
+    n = _nzDatasetParseLine( cp, val, ninput + noutput );
+    if( n < 0 && lineno == 1 ) continue; /* header of columns */
+    if( n != ninput + noutput ){
+      ZRUNERROR( NEUZ_ERR_DATASET_TEXT, textfile, lineno, ninput + noutput );
+      goto TERMINATE;
+    }
+    if( !nzDatasetWriterAdd( &writer, val, val + ninput ) ) break;
+  }
+  nsample = writer.nsample;
+
+ TERMINATE:
+  if( writer._fp && !nzDatasetWriterClose( &writer ) && nsample >= 0 ){
+    ZRUNERROR( NEUZ_ERR_DATASET_WRITE, binfile );
+    nsample = -1;
+  }
+  zFree( line );
+  zFree( val );
+  fclose( fp );
+  return nsample;
+}
+
+/* reader */
+
+/* initialize a dataset. */
+static void _nzDatasetInit(nzDataset *ds)
+{
+  ds->ninput = ds->noutput = ds->realsize = 0;
+  ds->nsample = ds->rowsize = 0;
+  ds->blocksize = ds->window = 0;
+  ds->shuffle = false;
+  ds->nblock = 0;
+  ds->_block = ds->_order = NULL;
+  ds->_wblock = 0;
+  ds->_wsize = ds->_wpos = 0;
+  ds->_data = NULL;
+  ds->_map = NULL;
+  ds->_mapsize = 0;
+  ds->_fp = NULL;
+  ds->_offset = 0;
+  ds->_row = NULL;
+}
+
+/* check the header of a binary dataset file. */
+static bool _nzDatasetCheckHeader(nzDataset *ds, const _nzDatasetHeader *header, uint64_t filesize, const char filename[])
+{
+  uint64_t rowsize;
+
+  if( strncmp( header->magic, NZ_DATASET_MAGIC, sizeof(header->magic) ) != 0 ){
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID, filename );
+    return false;
+  }
+  if( header->version != NZ_DATASET_VERSION ){
+    ZRUNERROR( NEUZ_ERR_DATASET_VERSION, filename, (int)header->version );
+    return false;
+  }
+  if( header->byteorder != NZ_DATASET_BYTEORDER ){
+    ZRUNERROR( NEUZ_ERR_DATASET_BYTEORDER, filename );
+    return false;
+  }
+  /* sizes are checked without overflow before they are stored in int and size_t */
+  if( ( header->realsize != sizeof(float) && header->realsize != sizeof(double) ) ||
+      header->ninput > INT_MAX || header->noutput > INT_MAX ||
+      (uint64_t)header->ninput + header->noutput < 1 ||
+      (uint64_t)header->ninput + header->noutput > INT_MAX ||
+      header->offset != _nzDatasetOffset() || header->offset > filesize ){
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID, filename );
+    return false;
+  }
+  rowsize = (uint64_t)header->realsize * ( (uint64_t)header->ninput + header->noutput );
+  if( rowsize > SIZE_MAX || header->nsample > ( filesize - header->offset ) / rowsize ){
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID, filename );
+    return false;
+  }
+  ds->ninput = header->ninput;
+  ds->noutput = header->noutput;
+  ds->realsize = header->realsize;
+  ds->nsample = header->nsample;
+  ds->rowsize = rowsize;
+  ds->_offset = header->offset;
+  return true;
+}
+
+#ifdef __NEUZ_MMAP
+/* map a binary dataset file to memory. */
+static bool _nzDatasetMap(nzDataset *ds, const char filename[])
+{
+  struct stat st;
+  int fd;
+
+  if( ( fd = open( filename, O_RDONLY ) ) < 0 ){
+    ZOPENERROR( filename );
+    return false;
+  }
+  if( fstat( fd, &st ) < 0 || (size_t)st.st_size < sizeof(_nzDatasetHeader) ){
+    close( fd );
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID, filename );
+    return false;
+  }
+  ds->_map = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( ds->_map == MAP_FAILED ){
+    ds->_map = NULL;
+    ZOPENERROR( filename );
+    return false;
+  }
+  ds->_mapsize = st.st_size;
+  if( !_nzDatasetCheckHeader( ds, (_nzDatasetHeader *)ds->_map, st.st_size, filename ) ) return false;
+  ds->_data = (const char *)ds->_map + ds->_offset;
+  return true;
+}
+#else
+/* open a binary dataset file to read samples one by one. */
+static bool _nzDatasetFOpen(nzDataset *ds, const char filename[])
+{
+  _nzDatasetHeader header;
+  long filesize;
+
+  if( !( ds->_fp = fopen( filename, "rb" ) ) ){
+    ZOPENERROR( filename );
+    return false;
+  }
+  if( fseek( ds->_fp, 0, SEEK_END ) != 0 || ( filesize = ftell( ds->_fp ) ) < 0 ||
+      fseek( ds->_fp, 0, SEEK_SET ) != 0 ||
+      fread( &header, sizeof(header), 1, ds->_fp ) != 1 ){
+    ZRUNERROR( NEUZ_ERR_DATASET_INVALID, filename );
+    return false;
+  }
+  if( !_nzDatasetCheckHeader( ds, &header, filesize, filename ) ) return false;
+  if( !( ds->_row = zAlloc( char, ds->rowsize ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  return true;
+}
+#endif /* __NEUZ_MMAP */
+
+/* open a binary dataset file to read. */
+nzDataset *nzDatasetOpen(nzDataset *ds, const char filename[])
+{
+  _nzDatasetInit( ds );
+#ifdef __NEUZ_MMAP
+  if( !_nzDatasetMap( ds, filename ) ) goto FAILURE;
+#else
+  if( !_nzDatasetFOpen( ds, filename ) ) goto FAILURE;
+#endif /* __NEUZ_MMAP */
+  if( !nzDatasetSetShuffle( ds, true, NZ_DATASET_DEFAULT_BLOCKSIZE, NZ_DATASET_DEFAULT_WINDOW ) ) goto FAILURE;
+  return ds;
+
+ FAILURE:
+  nzDatasetClose( ds );
+  return NULL;
+}
+
+/* close a binary dataset file. */
+void nzDatasetClose(nzDataset *ds)
+{
+#ifdef __NEUZ_MMAP
+  if( ds->_map ) munmap( ds->_map, ds->_mapsize );
+#endif /* __NEUZ_MMAP */
+  if( ds->_fp ) fclose( ds->_fp );
+  zFree( ds->_row );
+  zFree( ds->_block );
+  zFree( ds->_order );
+  _nzDatasetInit( ds );
+}
+
+/* range of samples of the i-th block in the order of an epoch. */
+static size_t _nzDatasetBlockRange(nzDataset *ds, size_t i, size_t *n)
+{
+  size_t head;
+
+  head = ds->_block[i] * ds->blocksize;
+  *n = zMin( (size_t)ds->blocksize, ds->nsample - head );
+  return head;
+}
+
+#ifdef __NEUZ_MMAP
+/* advise the system of pages of blocks of a window. */
+static void _nzDatasetAdviseWindow(nzDataset *ds, size_t wblock, int advice)
+{
+  size_t i, head, n, pagesize;
+  uintptr_t p0, p1;
+
+  pagesize = sysconf( _SC_PAGESIZE );
+  for( i=wblock; i<ds->nblock && i<wblock+ds->window; i++ ){
+    head = _nzDatasetBlockRange( ds, i, &n );
+    p0 = (uintptr_t)( ds->_data + head * ds->rowsize );
+    p1 = p0 + n * ds->rowsize;
+    /* only whole pages of the block are released */
+    if( advice == MADV_DONTNEED ){
+      p0 = ( p0 + pagesize - 1 ) / pagesize * pagesize;
+      p1 = p1 / pagesize * pagesize;
+    } else
+      p0 = p0 / pagesize * pagesize;
+    if( p1 > p0 ) madvise( (void *)p0, p1 - p0, advice );
+  }
+}
+#endif /* __NEUZ_MMAP */
+
+/* prepare samples of a window of blocks. */
+static void _nzDatasetLoadWindow(nzDataset *ds)
+{
+  size_t i, j, k, head, n, tmp;
+
+  for( ds->_wsize=0, i=ds->_wblock; i<ds->nblock && i<ds->_wblock+ds->window; i++ ){
+    head = _nzDatasetBlockRange( ds, i, &n );
+    for( j=0; j<n; j++ ) ds->_order[ds->_wsize++] = head + j;
+  }
+  if( ds->shuffle && ds->_wsize > 1 )
+    for( j=ds->_wsize-1; j>0; j-- ){
+      k = zRandI( 0, (int)j );
+      tmp = ds->_order[j]; ds->_order[j] = ds->_order[k]; ds->_order[k] = tmp;
+    }
+  ds->_wpos = 0;
+#ifdef __NEUZ_MMAP
+  if( ds->_map ){
+    if( ds->_wblock >= (size_t)ds->window )
+      _nzDatasetAdviseWindow( ds, ds->_wblock - ds->window, MADV_DONTNEED );
+    _nzDatasetAdviseWindow( ds, ds->_wblock + ds->window, MADV_WILLNEED );
+  }
+#endif /* __NEUZ_MMAP */
+}
+
+/* set the order of samples of a dataset. */
+bool nzDatasetSetShuffle(nzDataset *ds, bool shuffle, int blocksize, int window)
+{
+  size_t *block, *order;
+
+  if( blocksize < 1 ) blocksize = NZ_DATASET_DEFAULT_BLOCKSIZE;
+  if( window < 1 ) window = NZ_DATASET_DEFAULT_WINDOW;
+  ds->nblock = ( ds->nsample + blocksize - 1 ) / blocksize;
+  if( !( block = zRealloc( ds->_block, size_t, zMax( ds->nblock, 1 ) ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  ds->_block = block;
+  if( !( order = zRealloc( ds->_order, size_t, (size_t)blocksize * window ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  ds->_order = order;
+  ds->shuffle = shuffle;
+  ds->blocksize = blocksize;
+  ds->window = window;
+  nzDatasetRewind( ds );
+  return true;
+}
+
+/* begin a new epoch of a dataset. */
+void nzDatasetRewind(nzDataset *ds)
+{
+  size_t i, j, tmp;
+
+  for( i=0; i<ds->nblock; i++ ) ds->_block[i] = i;
+  if( ds->shuffle && ds->nblock > 1 )
+    for( i=ds->nblock-1; i>0; i-- ){
+      j = zRandI( 0, (int)i );
+      tmp = ds->_block[i]; ds->_block[i] = ds->_block[j]; ds->_block[j] = tmp;
+    }
+  ds->_wblock = 0;
+  _nzDatasetLoadWindow( ds );
+}
+
+/* copy elements of a row to arrays. */
+static void _nzDatasetCopyRow(nzDataset *ds, const void *row, double input[], double des[])
+{
+  int i;
+
+  if( ds->realsize == sizeof(float) ){
+    if( input ) for( i=0; i<ds->ninput; i++ ) input[i] = ((const float *)row)[i];
+    if( des ) for( i=0; i<ds->noutput; i++ ) des[i] = ((const float *)row)[ds->ninput+i];
+  } else{
+    if( input ) memcpy( input, row, sizeof(double) * ds->ninput );
+    if( des ) memcpy( des, (const double *)row + ds->ninput, sizeof(double) * ds->noutput );
+  }
+}
+
+/* get a sample of a dataset. */
+bool nzDatasetGetSample(nzDataset *ds, size_t i, double input[], double des[])
+{
+  if( i >= ds->nsample ){
+    ZRUNWARN( NEUZ_WARN_DATASET_OUTOFRANGE, (unsigned long)i, (unsigned long)ds->nsample );
+    return false;
+  }
+  if( ds->_data ){
+    _nzDatasetCopyRow( ds, ds->_data + i * ds->rowsize, input, des );
+    return true;
+  }
+  if( fseek( ds->_fp, (long)( ds->_offset + i * ds->rowsize ), SEEK_SET ) != 0 ||
+      fread( ds->_row, ds->rowsize, 1, ds->_fp ) != 1 ) return false;
+  _nzDatasetCopyRow( ds, ds->_row, input, des );
+  return true;
+}
+
+/* index of the next sample of the current epoch of a dataset. */
+static bool _nzDatasetNext(nzDataset *ds, size_t *index)
+{
+  if( ds->_wpos >= ds->_wsize ){
+    if( ( ds->_wblock += ds->window ) >= ds->nblock ){
+      ds->_wblock = ds->nblock;
+      ds->_wsize = ds->_wpos = 0;
+      return false;
+    }
+    _nzDatasetLoadWindow( ds );
+  }
+  *index = ds->_order[ds->_wpos++];
+  return true;
+}
+
+/* indices of the next samples of a dataset. */
+int nzDatasetNextIndex(nzDataset *ds, size_t index[], int n)
+{
+  int i;
+
+  for( i=0; i<n; i++ )
+    if( !_nzDatasetNext( ds, &index[i] ) ) break;
+  return i;
+}
+
+/* get the next mini-batch of a dataset. */
+int nzDatasetNextBatch(nzDataset *ds, zMat input, zMat des)
+{
+  size_t index;
+  int n;
+
+  if( zMatColSizeNC(input) != ds->ninput || zMatColSizeNC(des) != ds->noutput ||
+      zMatRowSizeNC(input) != zMatRowSizeNC(des) ){
+    ZRUNWARN( NEUZ_WARN_DATASET_MISMATCH );
+    return -1;
+  }
+  for( n=0; n<zMatRowSizeNC(input); n++ )
+    if( !_nzDatasetNext( ds, &index ) ||
+        !nzDatasetGetSample( ds, index, zMatRowBufNC(input,n), zMatRowBufNC(des,n) ) ) break;
+  return n;
+}
@@ -0,0 +1,905 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * compiled dense-layer network.
+ */
+
+#include <neuz/neuz_dense.h>
+#include <stdint.h>
+
+/* binary files are mapped to memory on POSIX systems. */
+#if defined(__unix__) || defined(__APPLE__)
+#define __NEUZ_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif /* __unix__ || __APPLE__ */
+
+/* inner product of two arrays. */
+static nzReal _nzDenseDotDefault(const nzReal *a, const nzReal *b, int n)
+{
+  nzReal s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i;
+
+  for( i=0; i<=n-4; i+=4 ){
+    s0 += a[i  ] * b[i  ];
+    s1 += a[i+1] * b[i+1];
+    s2 += a[i+2] * b[i+2];
+    s3 += a[i+3] * b[i+3];
+  }
+  for( ; i<n; i++ ) s0 += a[i] * b[i];
+  return ( s0 + s1 ) + ( s2 + s3 );
+}
+
+/* inner products of an array with four arrays aligned at an interval. */
+static void _nzDenseDot4Default(const nzReal *w, const nzReal *u, int n, nzReal *x, int stride)
+{
+  const nzReal *u0, *u1, *u2, *u3;
+  nzReal s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i;
+
+  u0 = u; u1 = u0 + n; u2 = u1 + n; u3 = u2 + n;
+  for( i=0; i<n; i++ ){
+    s0 += w[i] * u0[i];
+    s1 += w[i] * u1[i];
+    s2 += w[i] * u2[i];
+    s3 += w[i] * u3[i];
+  }
+  x[0] += s0; x[stride] += s1; x[2*stride] += s2; x[3*stride] += s3;
+}
+
+/* add a scaled array to another array. */
+static void _nzDenseAxpyDefault(nzReal *y, nzReal a, const nzReal *x, int n)
+{
+  int i;
+
+  for( i=0; i<n; i++ ) y[i] += a * x[i];
+}
+
+#ifdef __NEUZ_SIMD_X86
+#include <immintrin.h>
+
+/* packed real numbers in a 256-bit register. */
+#ifdef __NEUZ_FLOAT32__
+#define NZ_DENSE_LANE 8
+#define _nzDenseVec             __m256
+#define _nzDenseVecZero()       _mm256_setzero_ps()
+#define _nzDenseVecSet1(a)      _mm256_set1_ps( a )
+#define _nzDenseVecLoad(p)      _mm256_loadu_ps( p )
+#define _nzDenseVecStore(p,x)   _mm256_storeu_ps( p, x )
+#define _nzDenseVecAdd(x,y)     _mm256_add_ps( x, y )
+#define _nzDenseVecFMA(a,x,y)   _mm256_fmadd_ps( a, x, y )
+#else
+#define NZ_DENSE_LANE 4
+#define _nzDenseVec             __m256d
+#define _nzDenseVecZero()       _mm256_setzero_pd()
+#define _nzDenseVecSet1(a)      _mm256_set1_pd( a )
+#define _nzDenseVecLoad(p)      _mm256_loadu_pd( p )
+#define _nzDenseVecStore(p,x)   _mm256_storeu_pd( p, x )
+#define _nzDenseVecAdd(x,y)     _mm256_add_pd( x, y )
+#define _nzDenseVecFMA(a,x,y)   _mm256_fmadd_pd( a, x, y )
+#endif /* __NEUZ_FLOAT32__ */
+
+/* sum of packed real numbers. */
+__NZ_AVX2 static nzReal _nzDenseVecSum(_nzDenseVec x)
+{
+  nzReal s[NZ_DENSE_LANE];
+  int k;
+
+  _nzDenseVecStore( s, x );
+  for( k=1; k<NZ_DENSE_LANE; k++ ) s[0] += s[k];
+  return s[0];
+}
+
+/* inner product of two arrays. */
+__NZ_AVX2 static nzReal _nzDenseDotAVX2(const nzReal *a, const nzReal *b, int n)
+{
+  _nzDenseVec s0, s1, s2, s3;
+  nzReal s;
+  int i;
+
+  s0 = s1 = s2 = s3 = _nzDenseVecZero();
+  for( i=0; i<=n-4*NZ_DENSE_LANE; i+=4*NZ_DENSE_LANE ){
+    s0 = _nzDenseVecFMA( _nzDenseVecLoad( a+i                 ), _nzDenseVecLoad( b+i                 ), s0 );
+    s1 = _nzDenseVecFMA( _nzDenseVecLoad( a+i+  NZ_DENSE_LANE ), _nzDenseVecLoad( b+i+  NZ_DENSE_LANE ), s1 );
+    s2 = _nzDenseVecFMA( _nzDenseVecLoad( a+i+2*NZ_DENSE_LANE ), _nzDenseVecLoad( b+i+2*NZ_DENSE_LANE ), s2 );
+    s3 = _nzDenseVecFMA( _nzDenseVecLoad( a+i+3*NZ_DENSE_LANE ), _nzDenseVecLoad( b+i+3*NZ_DENSE_LANE ), s3 );
+  }
+  for( ; i<=n-NZ_DENSE_LANE; i+=NZ_DENSE_LANE )
+    s0 = _nzDenseVecFMA( _nzDenseVecLoad( a+i ), _nzDenseVecLoad( b+i ), s0 );
+  s = _nzDenseVecSum( _nzDenseVecAdd( _nzDenseVecAdd( s0, s1 ), _nzDenseVecAdd( s2, s3 ) ) );
+  for( ; i<n; i++ ) s += a[i] * b[i];
+  return s;
+}
+
+/* inner products of an array with four arrays aligned at an interval. */
+__NZ_AVX2 static void _nzDenseDot4AVX2(const nzReal *w, const nzReal *u, int n, nzReal *x, int stride)
+{
+  const nzReal *u0, *u1, *u2, *u3;
+  _nzDenseVec s0, s1, s2, s3, wv;
+  nzReal t0, t1, t2, t3;
+  int i;
+
+  u0 = u; u1 = u0 + n; u2 = u1 + n; u3 = u2 + n;
+  s0 = s1 = s2 = s3 = _nzDenseVecZero();
+  for( i=0; i<=n-NZ_DENSE_LANE; i+=NZ_DENSE_LANE ){
+    wv = _nzDenseVecLoad( w+i );
+    s0 = _nzDenseVecFMA( wv, _nzDenseVecLoad( u0+i ), s0 );
+    s1 = _nzDenseVecFMA( wv, _nzDenseVecLoad( u1+i ), s1 );
+    s2 = _nzDenseVecFMA( wv, _nzDenseVecLoad( u2+i ), s2 );
+    s3 = _nzDenseVecFMA( wv, _nzDenseVecLoad( u3+i ), s3 );
+  }
+  t0 = _nzDenseVecSum( s0 ); t1 = _nzDenseVecSum( s1 );
+  t2 = _nzDenseVecSum( s2 ); t3 = _nzDenseVecSum( s3 );
+  for( ; i<n; i++ ){
+    t0 += w[i] * u0[i];
+    t1 += w[i] * u1[i];
+    t2 += w[i] * u2[i];
+    t3 += w[i] * u3[i];
+  }
+  x[0] += t0; x[stride] += t1; x[2*stride] += t2; x[3*stride] += t3;
+}
+
+/* add a scaled array to another array. */
+__NZ_AVX2 static void _nzDenseAxpyAVX2(nzReal *y, nzReal a, const nzReal *x, int n)
+{
+  _nzDenseVec av;
+  int i;
+
+  av = _nzDenseVecSet1( a );
+  for( i=0; i<=n-NZ_DENSE_LANE; i+=NZ_DENSE_LANE )
+    _nzDenseVecStore( y+i, _nzDenseVecFMA( av, _nzDenseVecLoad( x+i ), _nzDenseVecLoad( y+i ) ) );
+  for( ; i<n; i++ ) y[i] += a * x[i];
+}
+#endif /* __NEUZ_SIMD_X86 */
+
+/* inner product of two arrays. */
+static nzReal _nzDenseDot(const nzReal *a, const nzReal *b, int n)
+{
+#ifdef __NEUZ_SIMD_X86
+  if( nzSIMDLevel() == NZ_SIMD_AVX2 ) return _nzDenseDotAVX2( a, b, n );
+#endif /* __NEUZ_SIMD_X86 */
+  return _nzDenseDotDefault( a, b, n );
+}
+
+/* inner products of an array with four arrays aligned at an interval. */
+static void _nzDenseDot4(const nzReal *w, const nzReal *u, int n, nzReal *x, int stride)
+{
+#ifdef __NEUZ_SIMD_X86
+  if( nzSIMDLevel() == NZ_SIMD_AVX2 ){
+    _nzDenseDot4AVX2( w, u, n, x, stride );
+    return;
+  }
+#endif /* __NEUZ_SIMD_X86 */
+  _nzDenseDot4Default( w, u, n, x, stride );
+}
+
+/* add a scaled array to another array. */
+static void _nzDenseAxpy(nzReal *y, nzReal a, const nzReal *x, int n)
+{
+#ifdef __NEUZ_SIMD_X86
+  if( nzSIMDLevel() == NZ_SIMD_AVX2 ){
+    _nzDenseAxpyAVX2( y, a, x, n );
+    return;
+  }
+#endif /* __NEUZ_SIMD_X86 */
+  _nzDenseAxpyDefault( y, a, x, n );
+}
+
+/* copy an array of double-precision values to an array of real numbers. */
+static void _nzDenseCopyIn(nzReal *dest, const double *src, int n)
+{
+  int i;
+
+  for( i=0; i<n; i++ ) dest[i] = src[i];
+}
+
+/* copy an array of real numbers to an array of double-precision values. */
+static void _nzDenseCopyOut(double *dest, const nzReal *src, int n)
+{
+  int i;
+
+  for( i=0; i<n; i++ ) dest[i] = src[i];
+}
+
+/* number of weights of a layer to be kept on cache in a batch. */
+#define NZ_DENSE_BLOCK_SIZE 8192
+
+/* propagate upstream outputs through a dense layer. */
+static void _nzDenseLayerPropagate(nzDenseLayer *layer, const nzReal *upstream)
+{
+  const nzReal *w;
+  int i;
+
+  for( w=layer->weight, i=0; i<layer->nout; i++, w+=layer->nin )
+    layer->input[i] = layer->bias[i] + _nzDenseDot( w, upstream, layer->nin );
+  nzActivatorFArray( layer->activator, layer->input, layer->output, layer->nout );
+}
+
+/* propagate a batch of upstream outputs through a dense layer. */
+static void _nzDenseLayerPropagateBatch(nzDenseLayer *layer, const nzReal *upstream, int n)
+{
+  const nzReal *w;
+  nzReal *x;
+  int i, i0, i1, s, blk;
+
+  for( x=layer->batch_input, s=0; s<n; s++, x+=layer->nout )
+    memcpy( x, layer->bias, sizeof(nzReal)*layer->nout );
+  blk = zMax( NZ_DENSE_BLOCK_SIZE / zMax( layer->nin, 1 ), 1 );
+  for( i0=0; i0<layer->nout; i0=i1 ){ /* a block of rows of weights is reused for every sample */
+    i1 = zMin( i0 + blk, layer->nout );
+    for( s=0; s<=n-4; s+=4 ){
+      x = layer->batch_input + s*layer->nout;
+      for( w=layer->weight+i0*layer->nin, i=i0; i<i1; i++, w+=layer->nin )
+        _nzDenseDot4( w, upstream+s*layer->nin, layer->nin, x+i, layer->nout );
+    }
+    for( ; s<n; s++ ){
+      x = layer->batch_input + s*layer->nout;
+      for( w=layer->weight+i0*layer->nin, i=i0; i<i1; i++, w+=layer->nin )
+        x[i] += _nzDenseDot( w, upstream+s*layer->nin, layer->nin );
+    }
+  }
+  nzActivatorFArray( layer->activator, layer->batch_input, layer->batch_output, n*layer->nout );
+}
+
+/* multiply back-propagated loss gradients of a batch by derivatives of the activator. */
+static void _nzDenseLayerDifBatch(nzDenseLayer *layer, int n)
+{
+  int i;
+
+  nzActivatorDFArray( layer->activator, layer->batch_input, layer->_batch_v, n*layer->nout );
+  for( i=0; i<n*layer->nout; i++ )
+    layer->_batch_p[i] *= layer->_batch_v[i];
+}
+
+/* back-propagate loss gradients of a batch through a dense layer.
+ * gradients of weights and biases are accumulated, and loss gradients
+ * with respect to upstream outputs are added to upstream_p unless it is
+ * the null pointer. */
+static void _nzDenseLayerBackPropagateBatch(nzDenseLayer *layer, const nzReal *upstream, nzReal *upstream_p, int n)
+{
+  const nzReal *p;
+  int i, i0, i1, s, blk;
+
+  for( p=layer->_batch_p, s=0; s<n; s++, p+=layer->nout )
+    _nzDenseAxpy( layer->_db, 1.0, p, layer->nout );
+  blk = zMax( NZ_DENSE_BLOCK_SIZE / zMax( layer->nin, 1 ), 1 );
+  for( i0=0; i0<layer->nout; i0=i1 ){ /* blocks of weights and gradients are reused for every sample */
+    i1 = zMin( i0 + blk, layer->nout );
+    for( s=0; s<n; s++ ){
+      p = layer->_batch_p + s*layer->nout;
+      for( i=i0; i<i1; i++ ){
+        _nzDenseAxpy( layer->_dw+i*layer->nin, p[i], upstream+s*layer->nin, layer->nin );
+        if( upstream_p )
+          _nzDenseAxpy( upstream_p+s*layer->nin, p[i], layer->weight+i*layer->nin, layer->nin );
+      }
+    }
+  }
+}
+
+/* initialize a compiled dense-layer network. */
+void nzDenseNetInit(nzDenseNet *dn)
+{
+  dn->size = 0;
+  dn->layer = NULL;
+  dn->input = NULL;
+  dn->nparam = 0;
+  dn->_param = NULL;
+  dn->_grad = NULL;
+  dn->_work = NULL;
+  dn->batchsize = 0;
+  dn->batch_input = NULL;
+  dn->_batch = NULL;
+  dn->_output = dn->_des = NULL;
+  dn->_map = NULL;
+  dn->_mapsize = 0;
+}
+
+/* destroy a compiled dense-layer network. */
+void nzDenseNetDestroy(nzDenseNet *dn)
+{
+  free( dn->layer );
+#ifdef __NEUZ_MMAP
+  if( dn->_map )
+    munmap( dn->_map, dn->_mapsize );
+  else
+#endif /* __NEUZ_MMAP */
+  free( dn->_param );
+  free( dn->_grad );
+  free( dn->_work );
+  free( dn->_batch );
+  zVecFreeAtOnce( 2, dn->_output, dn->_des );
+  nzDenseNetInit( dn );
+}
+
+/* check if identifiers of neurons in a group coincide with their order. */
+static bool _nzDenseNetCheckOrder(nzNeuronGroup *ng)
+{
+  nzNeuron *np;
+  int i = 0;
+
+  zListForEach( &ng->list, np )
+    if( np->data.gid != ng->id || np->data.nid != i++ ) return false;
+  return true;
+}
+
+/* allocate buffers of gradients and values of layers of a compiled dense-layer network. */
+static bool _nzDenseNetAllocWork(nzDenseNet *dn)
+{
+  nzDenseLayer *layer;
+  nzReal *gp, *wp;
+  int nwork;
+
+  nwork = nzDenseNetInputSize(dn);
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ )
+    nwork += 2 * layer->nout;
+  if( !( dn->_grad = zAlloc( nzReal, dn->nparam ) ) ||
+      !( dn->_work = zAlloc( nzReal, nwork ) ) ||
+      !( dn->_output = zVecAlloc( nzDenseNetOutputSize(dn) ) ) ||
+      !( dn->_des = zVecAlloc( nzDenseNetOutputSize(dn) ) ) ) return false;
+  gp = dn->_grad;
+  wp = dn->input = dn->_work;
+  wp += nzDenseNetInputSize(dn);
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ ){
+    layer->_dw    = gp; gp += layer->nin * layer->nout;
+    layer->_db    = gp; gp += layer->nout;
+    layer->input  = wp; wp += layer->nout;
+    layer->output = wp; wp += layer->nout;
+  }
+  return true;
+}
+
+/* allocate buffers of a compiled dense-layer network. */
+static bool _nzDenseNetAlloc(nzDenseNet *dn, nzNet *net)
+{
+  nzNetCell *nc;
+  nzDenseLayer *layer;
+  nzReal *pp;
+
+  dn->size = zListSize(net) - 1;
+  if( !( dn->layer = zAlloc( nzDenseLayer, dn->size ) ) ) return false;
+  for( layer=dn->layer, nc=zListCellNext(zListTail(net)); nc!=zListRoot(net); nc=zListCellNext(nc), layer++ ){
+    layer->nin = zListSize( &zListCellPrev(nc)->data.list );
+    layer->nout = zListSize( &nc->data.list );
+    dn->nparam += ( layer->nin + 1 ) * layer->nout;
+  }
+  if( !( dn->_param = zAlloc( nzReal, dn->nparam ) ) ) return false;
+  for( pp=dn->_param, layer=dn->layer; layer<dn->layer+dn->size; layer++ ){
+    layer->weight = pp; pp += layer->nin * layer->nout;
+    layer->bias   = pp; pp += layer->nout;
+  }
+  return _nzDenseNetAllocWork( dn );
+}
+
+/* copy weights and biases of a neuron group to a dense layer. */
+static bool _nzDenseLayerCompile(nzDenseLayer *layer, nzNeuronGroup *ngu, nzNeuronGroup *ng)
+{
+  nzNeuron *np, *nu;
+  nzAxon *ap;
+  int i = 0;
+
+  if( !_nzDenseNetCheckOrder( ng ) ) return false;
+  layer->activator = zListTail(&ng->list)->data.activator;
+  zListForEach( &ng->list, np ){
+    if( !np->data.activator || np->data.activator != layer->activator ) return false;
+    layer->bias[i] = np->data.bias;
+    for( ap=np->data.axon; ap; ap=ap->next ){
+      nu = (nzNeuron *)ap->upstream;
+      if( nu->data.gid != ngu->id ) return false;
+      layer->weight[i*layer->nin+nu->data.nid] += ap->weight;
+    }
+    i++;
+  }
+  return true;
+}
+
+/* compile a layered neural network into a dense-layer network. */
+nzDenseNet *nzDenseNetCompile(nzDenseNet *dn, nzNet *net)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzDenseLayer *layer;
+
+  nzDenseNetInit( dn );
+  if( zListSize(net) < 2 ){
+    ZRUNERROR( NEUZ_ERR_DENSE_TOOFEWLAYER );
+    return NULL;
+  }
+  if( !_nzDenseNetCheckOrder( nzNetInputLayer(net) ) ) goto FAILURE_INPUT;
+  zListForEach( &nzNetInputLayer(net)->list, np )
+    if( np->data.activator ) goto FAILURE_INPUT;
+  if( !_nzDenseNetAlloc( dn, net ) ){
+    ZALLOCERROR();
+    goto FAILURE;
+  }
+  for( layer=dn->layer, nc=zListCellNext(zListTail(net)); nc!=zListRoot(net); nc=zListCellNext(nc), layer++ )
+    if( !_nzDenseLayerCompile( layer, &zListCellPrev(nc)->data, &nc->data ) ){
+      ZRUNERROR( NEUZ_ERR_DENSE_INVALID_GROUP, nc->data.id );
+      goto FAILURE;
+    }
+  return dn;
+
+ FAILURE_INPUT:
+  ZRUNERROR( NEUZ_ERR_DENSE_INVALID_GROUP, nzNetInputLayer(net)->id );
+ FAILURE:
+  nzDenseNetDestroy( dn );
+  return NULL;
+}
+
+/* create a compiled dense-layer network that shares weights and biases with another. */
+nzDenseNet *nzDenseNetShare(nzDenseNet *dn, nzDenseNet *src)
+{
+  nzDenseLayer *layer;
+
+  nzDenseNetInit( dn );
+  if( !( dn->layer = zAlloc( nzDenseLayer, src->size ) ) ) goto FAILURE;
+  memcpy( dn->layer, src->layer, sizeof(nzDenseLayer)*src->size );
+  dn->size = src->size;
+  dn->nparam = src->nparam;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ )
+    layer->batch_input = layer->batch_output = layer->_batch_p = layer->_batch_v = NULL;
+  if( !_nzDenseNetAllocWork( dn ) ) goto FAILURE;
+  return dn;
+
+ FAILURE:
+  ZALLOCERROR();
+  nzDenseNetDestroy( dn );
+  return NULL;
+}
+
+/* check if a neural network has the same layered structure with a compiled dense-layer network. */
+static bool _nzDenseNetCheckNet(nzDenseNet *dn, nzNet *net)
+{
+  nzNetCell *nc;
+  nzDenseLayer *layer;
+
+  if( zListSize(net) != dn->size + 1 || nzNetInputSize(net) != nzDenseNetInputSize(dn) ) goto FAILURE;
+  for( layer=dn->layer, nc=zListCellNext(zListTail(net)); nc!=zListRoot(net); nc=zListCellNext(nc), layer++ )
+    if( zListSize(&nc->data.list) != layer->nout ) goto FAILURE;
+  return true;
+ FAILURE:
+  ZRUNERROR( NEUZ_ERR_DENSE_MISMATCH );
+  return false;
+}
+
+/* copy weights and biases of a compiled dense-layer network back to a neural network. */
+bool nzDenseNetCopyToNet(nzDenseNet *dn, nzNet *net)
+{
+  nzNetCell *nc;
+  nzNeuron *np, *nu;
+  nzAxon *ap;
+  nzDenseLayer *layer;
+  bool *assigned;
+  int i;
+
+  if( !_nzDenseNetCheckNet( dn, net ) ) return false;
+  for( layer=dn->layer, nc=zListCellNext(zListTail(net)); nc!=zListRoot(net); nc=zListCellNext(nc), layer++ ){
+    if( !( assigned = zAlloc( bool, layer->nin ) ) ){
+      ZALLOCERROR();
+      return false;
+    }
+    i = 0;
+    zListForEach( &nc->data.list, np ){
+      np->data.bias = layer->bias[i];
+      for( ap=np->data.axon; ap; ap=ap->next ){
+        nu = (nzNeuron *)ap->upstream;
+        ap->weight = assigned[nu->data.nid] ? 0 : layer->weight[i*layer->nin+nu->data.nid];
+        assigned[nu->data.nid] = true;
+      }
+      for( ap=np->data.axon; ap; ap=ap->next )
+        assigned[((nzNeuron *)ap->upstream)->data.nid] = false;
+      i++;
+    }
+    free( assigned );
+  }
+  return true;
+}
+
+/* add gradients of a compiled dense-layer network to a neural network. */
+bool nzDenseNetAddGradToNet(nzDenseNet *dn, nzNet *net)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzDenseLayer *layer;
+  nzAxon *ap;
+  int i;
+
+  if( !_nzDenseNetCheckNet( dn, net ) ) return false;
+  for( layer=dn->layer, nc=zListCellNext(zListTail(net)); nc!=zListRoot(net); nc=zListCellNext(nc), layer++ ){
+    i = 0;
+    zListForEach( &nc->data.list, np ){
+      np->data._db += layer->_db[i];
+      for( ap=np->data.axon; ap; ap=ap->next )
+        ap->_dw += layer->_dw[i*layer->nin+((nzNeuron *)ap->upstream)->data.nid];
+      i++;
+    }
+  }
+  return true;
+}
+
+/* set input values to a compiled dense-layer network. */
+bool nzDenseNetSetInput(nzDenseNet *dn, zVec input)
+{
+  if( nzDenseNetInputSize(dn) != zVecSize(input) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzDenseNetInputSize(dn), zVecSize(input) );
+    return false;
+  }
+  _nzDenseCopyIn( dn->input, zVecBufNC(input), zVecSizeNC(input) );
+  return true;
+}
+
+/* get output values from a compiled dense-layer network. */
+bool nzDenseNetGetOutput(nzDenseNet *dn, zVec output)
+{
+  if( nzDenseNetOutputSize(dn) != zVecSize(output) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzDenseNetOutputSize(dn), zVecSize(output) );
+    return false;
+  }
+  _nzDenseCopyOut( zVecBufNC(output), nzDenseNetOutputLayer(dn)->output, zVecSizeNC(output) );
+  return true;
+}
+
+/* propagate input values to a compiled dense-layer network to the output. */
+bool nzDenseNetPropagate(nzDenseNet *dn, zVec input)
+{
+  nzDenseLayer *layer;
+  nzReal *upstream;
+
+  if( input )
+    if( !nzDenseNetSetInput( dn, input ) ) return false;
+  for( upstream=dn->input, layer=dn->layer; layer<dn->layer+dn->size; upstream=layer->output, layer++ )
+    _nzDenseLayerPropagate( layer, upstream );
+  return true;
+}
+
+/* allocate workspace of a compiled dense-layer network for a batch. */
+static bool _nzDenseNetAllocBatch(nzDenseNet *dn, int n)
+{
+  nzDenseLayer *layer;
+  nzReal *bp;
+  int size;
+
+  if( n <= dn->batchsize ) return true;
+  size = nzDenseNetInputSize(dn) * n;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ )
+    size += 4 * layer->nout * n;
+  free( dn->_batch );
+  if( !( dn->_batch = zAlloc( nzReal, size ) ) ){
+    ZALLOCERROR();
+    dn->batchsize = 0;
+    return false;
+  }
+  bp = dn->batch_input = dn->_batch;
+  bp += nzDenseNetInputSize(dn) * n;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ ){
+    layer->batch_input  = bp; bp += layer->nout * n;
+    layer->batch_output = bp; bp += layer->nout * n;
+    layer->_batch_p     = bp; bp += layer->nout * n;
+    layer->_batch_v     = bp; bp += layer->nout * n;
+  }
+  dn->batchsize = n;
+  return true;
+}
+
+/* propagate a batch of input values through layers of a compiled dense-layer network. */
+static void _nzDenseNetPropagateBatch(nzDenseNet *dn, const double *input, int n)
+{
+  nzDenseLayer *layer;
+  const nzReal *upstream;
+
+  _nzDenseCopyIn( dn->batch_input, input, n*nzDenseNetInputSize(dn) );
+  for( upstream=dn->batch_input, layer=dn->layer; layer<dn->layer+dn->size; upstream=layer->batch_output, layer++ )
+    _nzDenseLayerPropagateBatch( layer, upstream, n );
+}
+
+/* propagate a batch of input values to a compiled dense-layer network. */
+bool nzDenseNetPropagateBatch(nzDenseNet *dn, zMat input, zMat output)
+{
+  int n;
+
+  n = zMatRowSize(input);
+  if( zMatColSize(input) != nzDenseNetInputSize(dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetInputSize(dn), n, zMatColSize(input) );
+    return false;
+  }
+  if( zMatRowSize(output) != n || zMatColSize(output) != nzDenseNetOutputSize(dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetOutputSize(dn), zMatRowSize(output), zMatColSize(output) );
+    return false;
+  }
+  if( !_nzDenseNetAllocBatch( dn, n ) ) return false;
+  _nzDenseNetPropagateBatch( dn, zMatBufNC(input), n );
+  _nzDenseCopyOut( zMatBufNC(output), nzDenseNetOutputLayer(dn)->batch_output, n*nzDenseNetOutputSize(dn) );
+  return true;
+}
+
+/* initialize gradients of weights and biases of a compiled dense-layer network. */
+void nzDenseNetInitGrad(nzDenseNet *dn)
+{
+  memset( dn->_grad, 0, sizeof(nzReal)*dn->nparam );
+}
+
+/* set loss gradients of a batch at the output layer of a compiled dense-layer network. */
+static void _nzDenseNetInitPBatch(nzDenseNet *dn, const double *des, int n, double (* lossgrad)(zVec,zVec,int))
+{
+  nzDenseLayer *layer;
+  nzReal *p;
+  int s, i;
+
+  layer = nzDenseNetOutputLayer(dn);
+  for( p=layer->_batch_p, s=0; s<n; s++, p+=layer->nout ){
+    _nzDenseCopyOut( zVecBufNC(dn->_output), layer->batch_output+s*layer->nout, layer->nout );
+    memcpy( zVecBufNC(dn->_des), des+s*layer->nout, sizeof(double)*layer->nout );
+    for( i=0; i<layer->nout; i++ )
+      p[i] = lossgrad( dn->_output, dn->_des, i );
+  }
+}
+
+/* back-propagate loss of a batch of samples in a compiled dense-layer network. */
+bool nzDenseNetBackPropagateBatch(nzDenseNet *dn, zMat input, zMat des, double (* lossgrad)(zVec,zVec,int))
+{
+  int n;
+
+  n = zMatRowSize(input);
+  if( zMatColSize(input) != nzDenseNetInputSize(dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetInputSize(dn), n, zMatColSize(input) );
+    return false;
+  }
+  if( zMatRowSize(des) != n || zMatColSize(des) != nzDenseNetOutputSize(dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetOutputSize(dn), zMatRowSize(des), zMatColSize(des) );
+    return false;
+  }
+  return nzDenseNetBackPropagateBatchNC( dn, zMatBufNC(input), zMatBufNC(des), n, lossgrad );
+}
+
+/* back-propagate loss of a batch of samples stored in arrays in a compiled dense-layer network. */
+bool nzDenseNetBackPropagateBatchNC(nzDenseNet *dn, const double *input, const double *des, int n, double (* lossgrad)(zVec,zVec,int))
+{
+  nzDenseLayer *layer;
+
+  if( !_nzDenseNetAllocBatch( dn, n ) ) return false;
+  _nzDenseNetPropagateBatch( dn, input, n );
+  _nzDenseNetInitPBatch( dn, des, n, lossgrad );
+  for( layer=nzDenseNetOutputLayer(dn); layer>dn->layer; layer-- ){
+    _nzDenseLayerDifBatch( layer, n );
+    memset( (layer-1)->_batch_p, 0, sizeof(nzReal)*n*layer->nin );
+    _nzDenseLayerBackPropagateBatch( layer, (layer-1)->batch_output, (layer-1)->_batch_p, n );
+  }
+  _nzDenseLayerDifBatch( layer, n );
+  _nzDenseLayerBackPropagateBatch( layer, dn->batch_input, NULL, n );
+  return true;
+}
+
+/* train a compiled dense-layer network based on the steepest descent method. */
+void nzDenseNetTrainSDM(nzDenseNet *dn, double rate)
+{
+  _nzDenseAxpy( dn->_param, (nzReal)-rate, dn->_grad, dn->nparam );
+}
+
+/* binary file */
+
+#define NZ_DENSE_BINARY_MAGIC     "NEUZBIN"
+#define NZ_DENSE_BINARY_BYTEORDER 0x01020304
+
+/* header of a binary file of a compiled dense-layer network. */
+typedef struct{
+  char magic[8];      /* NZ_DENSE_BINARY_MAGIC */
+  uint32_t version;   /* NZ_DENSE_BINARY_VERSION */
+  uint32_t byteorder; /* NZ_DENSE_BINARY_BYTEORDER in the byte order of the writer */
+  uint32_t realsize;  /* size of nzReal in bytes */
+  uint32_t size;      /* number of layers except the input layer */
+  uint32_t nparam;    /* number of weights and biases */
+  uint32_t _pad;
+  uint64_t offset;    /* offset of weights and biases from the head of the file */
+} _nzDenseNetBinaryHeader;
+
+/* layer entry of a binary file of a compiled dense-layer network. */
+typedef struct{
+  uint32_t nin;       /* size of input */
+  uint32_t nout;      /* size of output */
+  char activator[24]; /* type string of the activator function */
+} _nzDenseLayerBinaryHeader;
+
+/* offset of weights and biases in a binary file of a compiled dense-layer network. */
+static size_t _nzDenseNetBinaryOffset(int size)
+{
+  size_t offset;
+
+  offset = sizeof(_nzDenseNetBinaryHeader) + sizeof(_nzDenseLayerBinaryHeader) * size;
+  return ( offset + NZ_DENSE_BINARY_ALIGN - 1 ) / NZ_DENSE_BINARY_ALIGN * NZ_DENSE_BINARY_ALIGN;
+}
+
+/* write a compiled dense-layer network to a binary file. */
+bool nzDenseNetWriteBinary(nzDenseNet *dn, const char filename[])
+{
+  FILE *fp;
+  _nzDenseNetBinaryHeader header;
+  _nzDenseLayerBinaryHeader lh;
+  nzDenseLayer *layer;
+  size_t pos;
+  bool ret = false;
+
+  if( !( fp = fopen( filename, "wb" ) ) ){
+    ZOPENERROR( filename );
+    return false;
+  }
+  memset( &header, 0, sizeof(header) );
+  strcpy( header.magic, NZ_DENSE_BINARY_MAGIC );
+  header.version = NZ_DENSE_BINARY_VERSION;
+  header.byteorder = NZ_DENSE_BINARY_BYTEORDER;
+  header.realsize = sizeof(nzReal);
+  header.size = dn->size;
+  header.nparam = dn->nparam;
+  header.offset = _nzDenseNetBinaryOffset( dn->size );
+  if( fwrite( &header, sizeof(header), 1, fp ) != 1 ) goto TERMINATE;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ ){
+    memset( &lh, 0, sizeof(lh) );
+    lh.nin = layer->nin;
+    lh.nout = layer->nout;
+    strncpy( lh.activator, layer->activator->typestr, sizeof(lh.activator)-1 );
+    if( fwrite( &lh, sizeof(lh), 1, fp ) != 1 ) goto TERMINATE;
+  }
+  for( pos=sizeof(header)+sizeof(lh)*dn->size; pos<header.offset; pos++ )
+    if( fputc( 0, fp ) == EOF ) goto TERMINATE;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ )
+    if( fwrite( layer->weight, sizeof(nzReal), layer->nin*layer->nout, fp ) != (size_t)( layer->nin*layer->nout ) ||
+        fwrite( layer->bias, sizeof(nzReal), layer->nout, fp ) != (size_t)layer->nout ) goto TERMINATE;
+  ret = true;
+ TERMINATE:
+  if( fclose( fp ) != 0 ) ret = false;
+  if( !ret ) ZRUNERROR( NEUZ_ERR_BINARY_WRITE, filename );
+  return ret;
+}
+
+/* check the header of a binary file of a compiled dense-layer network. */
+static bool _nzDenseNetBinaryCheckHeader(const _nzDenseNetBinaryHeader *header, const char filename[])
+{
+  if( strncmp( header->magic, NZ_DENSE_BINARY_MAGIC, sizeof(header->magic) ) != 0 ){
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    return false;
+  }
+  if( header->version != NZ_DENSE_BINARY_VERSION ){
+    ZRUNERROR( NEUZ_ERR_BINARY_VERSION, filename, (int)header->version );
+    return false;
+  }
+  if( header->byteorder != NZ_DENSE_BINARY_BYTEORDER || header->realsize != sizeof(nzReal) ){
+    ZRUNERROR( NEUZ_ERR_BINARY_PRECISION, filename );
+    return false;
+  }
+  if( header->size < 1 || header->offset != _nzDenseNetBinaryOffset( header->size ) ){
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    return false;
+  }
+  return true;
+}
+
+/* set layers of a compiled dense-layer network from entries in a binary file.
+ * weights and biases are arranged in a buffer param. */
+static bool _nzDenseNetBinaryLayers(nzDenseNet *dn, const _nzDenseNetBinaryHeader *header, const _nzDenseLayerBinaryHeader *lh, nzReal *param, const char filename[])
+{
+  nzDenseLayer *layer;
+  char typestr[sizeof(lh->activator)];
+  uint64_t nparam = 0;
+
+  if( !( dn->layer = zAlloc( nzDenseLayer, header->size ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  dn->size = header->size;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++, lh++ ){
+    layer->nin = lh->nin;
+    layer->nout = lh->nout;
+    memcpy( typestr, lh->activator, sizeof(typestr) );
+    typestr[sizeof(typestr)-1] = '\0';
+    if( !( layer->activator = nzActivatorAssignByStr( typestr ) ) ){
+      ZRUNERROR( NEUZ_ERR_UNKNOWN_ACTIVATOR, typestr );
+      return false;
+    }
+    if( lh->nin < 1 || lh->nout < 1 ||
+        ( layer > dn->layer && layer->nin != (layer-1)->nout ) ) goto FAILURE;
+    nparam += ( (uint64_t)lh->nin + 1 ) * lh->nout;
+    if( nparam > header->nparam ) goto FAILURE;
+  }
+  if( nparam != header->nparam ) goto FAILURE;
+  dn->nparam = header->nparam;
+  dn->_param = param;
+  for( layer=dn->layer; layer<dn->layer+dn->size; layer++ ){
+    layer->weight = param; param += layer->nin * layer->nout;
+    layer->bias   = param; param += layer->nout;
+  }
+  if( !_nzDenseNetAllocWork( dn ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  return true;
+
+ FAILURE:
+  ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+  return false;
+}
+
+/* read a compiled dense-layer network from a binary file. */
+nzDenseNet *nzDenseNetReadBinary(nzDenseNet *dn, const char filename[])
+{
+  FILE *fp;
+  _nzDenseNetBinaryHeader header;
+  _nzDenseLayerBinaryHeader *lh = NULL;
+  nzReal *param = NULL;
+
+  nzDenseNetInit( dn );
+  if( !( fp = fopen( filename, "rb" ) ) ){
+    ZOPENERROR( filename );
+    return NULL;
+  }
+  if( fread( &header, sizeof(header), 1, fp ) != 1 ){
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    goto FAILURE;
+  }
+  if( !_nzDenseNetBinaryCheckHeader( &header, filename ) ) goto FAILURE;
+  if( !( lh = zAlloc( _nzDenseLayerBinaryHeader, header.size ) ) ||
+      !( param = zAlloc( nzReal, header.nparam ) ) ){
+    ZALLOCERROR();
+    goto FAILURE;
+  }
+  if( fread( lh, sizeof(_nzDenseLayerBinaryHeader), header.size, fp ) != header.size ||
+      fseek( fp, (long)header.offset, SEEK_SET ) != 0 ||
+      fread( param, sizeof(nzReal), header.nparam, fp ) != header.nparam ){
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    goto FAILURE;
+  }
+  if( !_nzDenseNetBinaryLayers( dn, &header, lh, param, filename ) ) goto FAILURE;
+  free( lh );
+  fclose( fp );
+  return dn;
+
+ FAILURE:
+  if( !dn->_param ) free( param );
+  free( lh );
+  fclose( fp );
+  nzDenseNetDestroy( dn );
+  return NULL;
+}
+
+/* map a binary file of a compiled dense-layer network to memory. */
+nzDenseNet *nzDenseNetMapBinary(nzDenseNet *dn, const char filename[])
+{
+#ifdef __NEUZ_MMAP
+  struct stat st;
+  _nzDenseNetBinaryHeader *header;
+  int fd;
+
+  nzDenseNetInit( dn );
+  if( ( fd = open( filename, O_RDONLY ) ) < 0 ){
+    ZOPENERROR( filename );
+    return NULL;
+  }
+  if( fstat( fd, &st ) < 0 || (size_t)st.st_size < sizeof(_nzDenseNetBinaryHeader) ){
+    close( fd );
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    return NULL;
+  }
+  dn->_map = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if( dn->_map == MAP_FAILED ){
+    dn->_map = NULL;
+    ZOPENERROR( filename );
+    return NULL;
+  }
+  dn->_mapsize = st.st_size;
+  header = (_nzDenseNetBinaryHeader *)dn->_map;
+  if( !_nzDenseNetBinaryCheckHeader( header, filename ) ) goto FAILURE;
+  if( header->offset + (uint64_t)header->nparam * sizeof(nzReal) > dn->_mapsize ){
+    ZRUNERROR( NEUZ_ERR_BINARY_INVALID, filename );
+    goto FAILURE;
+  }
+  if( !_nzDenseNetBinaryLayers( dn, header, (_nzDenseLayerBinaryHeader *)( header + 1 ),
+        (nzReal *)( (char *)dn->_map + header->offset ), filename ) ) goto FAILURE;
+  return dn;
+
+ FAILURE:
+  nzDenseNetDestroy( dn );
+  return NULL;
+#else
+  return nzDenseNetReadBinary( dn, filename );
+#endif /* __NEUZ_MMAP */
+}
@@ -0,0 +1,144 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * frozen inference-only network.
+ */
+
+#include <neuz/neuz_frozen.h>
+#include <neuz/neuz_errmsg.h>
+
+/* initialize a frozen network. */
+void nzFrozenNetInit(nzFrozenNet *fn)
+{
+  fn->ninput = fn->noutput = fn->nneuron = fn->nconn = fn->nactivator = 0;
+  fn->weight = fn->bias = NULL;
+  fn->activator = NULL;
+  fn->offset = fn->upstream = NULL;
+  fn->activator_id = NULL;
+  fn->_size = 0;
+  fn->_buf = NULL;
+}
+
+/* destroy a frozen network. */
+void nzFrozenNetDestroy(nzFrozenNet *fn)
+{
+  free( fn->_buf );
+  nzFrozenNetInit( fn );
+}
+
+/* identifier of an activator function in a table, which is added if not found. */
+static int _nzFrozenNetActivatorID(nzActivator *table[], int *n, nzActivator *activator)
+{
+  int i;
+
+  for( i=0; i<*n; i++ )
+    if( table[i] == activator ) return i;
+  if( *n >= NZ_FROZEN_ACTIVATOR_MAX ){
+    ZRUNERROR( NEUZ_ERR_FROZEN_TOOMANYACTIVATOR, NZ_FROZEN_ACTIVATOR_MAX );
+    return -1;
+  }
+  table[*n] = activator;
+  return (*n)++;
+}
+
+/* count neurons, connections and activator functions of a neural network to be frozen. */
+static bool _nzFrozenNetCount(nzFrozenNet *fn, nzNet *net, nzActivator *table[])
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+
+  if( !nzNetCountCSR( net, &fn->nneuron, &fn->nconn ) ) return false;
+  fn->ninput = nzNetInputSize(net);
+  fn->noutput = nzNetOutputSize(net);
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+    zListForEach( &nc->data.list, np )
+      if( _nzFrozenNetActivatorID( table, &fn->nactivator, np->data.activator ) < 0 ) return false;
+  return true;
+}
+
+/* size of an array in a buffer aligned at 8 bytes. */
+#define _nzFrozenNetAlign(size) ( ( (size) + 7 ) & ~(size_t)7 )
+
+/* allocate the buffer of a frozen network and assign arrays to it. */
+static bool _nzFrozenNetAlloc(nzFrozenNet *fn)
+{
+  char *p;
+
+  fn->_size = _nzFrozenNetAlign( sizeof(nzActivator *) * fn->nactivator )
+            + _nzFrozenNetAlign( sizeof(nzReal) * fn->nconn )
+            + _nzFrozenNetAlign( sizeof(nzReal) * fn->nneuron )
+            + _nzFrozenNetAlign( sizeof(int) * ( fn->nneuron + 1 ) )
+            + _nzFrozenNetAlign( sizeof(int) * fn->nconn )
+            + _nzFrozenNetAlign( sizeof(unsigned char) * fn->nneuron );
+  if( !( fn->_buf = p = zAlloc( char, fn->_size ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  fn->activator = (nzActivator **)p; p += _nzFrozenNetAlign( sizeof(nzActivator *) * fn->nactivator );
+  fn->weight = (nzReal *)p;          p += _nzFrozenNetAlign( sizeof(nzReal) * fn->nconn );
+  fn->bias = (nzReal *)p;            p += _nzFrozenNetAlign( sizeof(nzReal) * fn->nneuron );
+  fn->offset = (int *)p;             p += _nzFrozenNetAlign( sizeof(int) * ( fn->nneuron + 1 ) );
+  fn->upstream = (int *)p;           p += _nzFrozenNetAlign( sizeof(int) * fn->nconn );
+  fn->activator_id = (unsigned char *)p;
+  return true;
+}
+
+/* freeze a neural network into an inference-only network. */
+nzFrozenNet *nzFrozenNetFreeze(nzFrozenNet *fn, nzNet *net)
+{
+  nzActivator *table[NZ_FROZEN_ACTIVATOR_MAX];
+  nzNeuronGroup *ng;
+  int gid, nid, i;
+
+  nzFrozenNetInit( fn );
+  if( zListSize(net) < 2 ){
+    ZRUNERROR( NEUZ_ERR_FROZEN_TOOFEWLAYER );
+    return NULL;
+  }
+  if( !_nzFrozenNetCount( fn, net, table ) ||
+      !_nzFrozenNetAlloc( fn ) ||
+      !nzNetToCSR( net, fn->offset, fn->upstream, fn->weight, fn->bias, NULL ) ) goto FAILURE;
+  memcpy( fn->activator, table, sizeof(nzActivator *) * fn->nactivator );
+  for( i=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++, i++ )
+      fn->activator_id[i] = _nzFrozenNetActivatorID( fn->activator, &fn->nactivator, ng->index[nid]->data.activator );
+  }
+  return fn;
+
+ FAILURE:
+  nzFrozenNetDestroy( fn );
+  return NULL;
+}
+
+/* propagate input values to a frozen network to the output. */
+bool nzFrozenNetPropagate(const nzFrozenNet *fn, zVec input, zVec output, nzReal *work)
+{
+  nzReal *buf = NULL, *value;
+  double x;
+  int i, j;
+
+  if( zVecSizeNC(input) != fn->ninput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, fn->ninput, zVecSizeNC(input) );
+    return false;
+  }
+  if( zVecSizeNC(output) != fn->noutput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, fn->noutput, zVecSizeNC(output) );
+    return false;
+  }
+  if( !work && !( work = buf = zAlloc( nzReal, nzFrozenNetWorkSize(fn) ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  for( i=0; i<fn->ninput; i++ ) work[i] = zVecElemNC(input,i);
+  for( value=work+fn->ninput, i=0; i<fn->nneuron; i++ ){
+    x = fn->bias[i];
+    for( j=fn->offset[i]; j<fn->offset[i+1]; j++ )
+      x += fn->weight[j] * work[fn->upstream[j]];
+    value[i] = fn->activator[fn->activator_id[i]]->f( x );
+  }
+  for( value+=fn->nneuron-fn->noutput, i=0; i<fn->noutput; i++ )
+    zVecElemNC(output,i) = value[i];
+  free( buf );
+  return true;
+}
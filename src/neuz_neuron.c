@@ -22,6 +22,7 @@ nzNeuron *nzNeuronInit(nzNeuron *neuron, int gid, int nid)
   neuron->data._v = 0;
   neuron->data.activator = &nz_activator_sigmoid;
   neuron->data.axon = NULL;
+  neuron->data.arena = NULL;
   return neuron;
 }
 
@@ -30,6 +31,10 @@ void nzNeuronDestroy(nzNeuron *neuron)
 {
   nzAxon *ap;
 
+  if( neuron->data.arena ){ /* released with the arena */
+    neuron->data.axon = NULL;
+    return;
+  }
   while( ( ap = neuron->data.axon ) ){
     neuron->data.axon = ap->next;
     free( ap );
@@ -41,7 +46,7 @@ bool nzNeuronConnect(nzNeuron *nu, nzNeuron *nd, double weight)
 {
   nzAxon *axon;
 
-  if( !( axon = zAlloc( nzAxon, 1 ) ) ){
+  if( !( axon = nd->data.arena ? nzArenaAllocType( nd->data.arena, nzAxon, 1 ) : zAlloc( nzAxon, 1 ) ) ){
     ZALLOCERROR();
     return false;
   }
@@ -126,19 +131,41 @@ nzNeuronGroup *nzNeuronGroupInit(nzNeuronGroup *ng, int id)
 {
   ng->id = id;
   zListInit( &ng->list );
+  ng->arena = NULL;
+  ng->capacity = 0;
+  ng->index = NULL;
   return ng;
 }
 
+/* reserve the index of a neuron group for a given number of neurons. */
+static bool _nzNeuronGroupReserve(nzNeuronGroup *ng, int num)
+{
+  nzNeuron **index;
+
+  if( num <= ng->capacity ) return true;
+  num = zMax( num, 2*ng->capacity );
+  if( !( index = zRealloc( ng->index, nzNeuron *, num ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  ng->index = index;
+  ng->capacity = num;
+  return true;
+}
+
 /* add a neuron into a group. */
 bool nzNeuronGroupAddOne(nzNeuronGroup *ng)
 {
   nzNeuron *neuron;
 
-  if( !( neuron = zAlloc( nzNeuron, 1 ) ) ){
+  if( !_nzNeuronGroupReserve( ng, zListSize(&ng->list)+1 ) ) return false;
+  if( !( neuron = ng->arena ? nzArenaAllocType( ng->arena, nzNeuron, 1 ) : zAlloc( nzNeuron, 1 ) ) ){
     ZALLOCERROR();
     return false;
   }
   nzNeuronInit( neuron, ng->id, zListSize(&ng->list) );
+  neuron->data.arena = ng->arena;
+  ng->index[zListSize(&ng->list)] = neuron;
   zListInsertHead( &ng->list, neuron );
   return true;
 }
@@ -146,6 +173,7 @@ bool nzNeuronGroupAddOne(nzNeuronGroup *ng)
 /* add multiple neurons into a group. */
 bool nzNeuronGroupAdd(nzNeuronGroup *ng, int num)
 {
+  if( !_nzNeuronGroupReserve( ng, zListSize(&ng->list)+num ) ) return false;
   while( --num >= 0 )
     if( !nzNeuronGroupAddOne( ng ) ) return false;
   return true;
@@ -159,18 +187,18 @@ void nzNeuronGroupDestroy(nzNeuronGroup *ng)
   while( !zListIsEmpty( &ng->list ) ){
     zListDeleteHead( &ng->list, &np );
     nzNeuronDestroy( np );
-    free( np );
+    if( !ng->arena ) free( np );
   }
+  free( ng->index );
+  ng->index = NULL;
+  ng->capacity = 0;
 }
 
 /* find a neuron in a neuron group. */
 nzNeuron *nzNeuronGroupFindNeuron(nzNeuronGroup *ng, int gid, int nid)
 {
-  nzNeuron *np;
-
-  zListForEachRew( &ng->list, np )
-    if( np->data.gid == gid && np->data.nid == nid ) return np;
-  return NULL;
+  if( gid != ng->id || nid < 0 || nid >= zListSize(&ng->list) ) return NULL;
+  return ng->index[nid];
 }
 
 /* set activator functions of units in a neuron group. */
@@ -239,16 +267,6 @@ static void _nzNeuronGroupInitParam(nzNeuronGroup *ng)
     _nzNeuronInitParam( np );
 }
 
-/* back-propagate loss and train in a neuron group of a neural network. */
-static bool _nzNeuronGroupBackPropagate(nzNeuronGroup *ng)
-{
-  nzNeuron *np;
-
-  zListForEach( &ng->list, np )
-    _nzNeuronBackPropagate( np );
-  return true;
-}
-
 /* train a neuron group based on the steepest descent method. */
 static bool _nzNeuronGroupTrainSDM(nzNeuronGroup *ng, double rate)
 {
@@ -272,22 +290,85 @@ void nzNeuronGroupFPrint(FILE *fp, nzNeuronGroup *ng)
 
 /* neural network class */
 
+/* initialize a neural network. */
+void nzNetInit(nzNet *net)
+{
+  zListInit( net );
+  nzArenaInit( &net->arena );
+  net->capacity = 0;
+  net->index = NULL;
+  net->parallel.pool = NULL;
+  net->parallel.threshold = NZ_NET_PARALLEL_THRESHOLD;
+  net->parallel.nworker = net->parallel.ngroup = net->parallel.nneuron = 0;
+  net->parallel.offset = NULL;
+  net->parallel.neuron = NULL;
+  net->parallel.p = NULL;
+  net->parallel.range = NULL;
+  net->schedule.valid = net->schedule.grouped = false;
+  net->schedule.nneuron = net->schedule.nlevel = 0;
+  net->schedule.neuron = NULL;
+  net->schedule.level = NULL;
+  net->stats = NULL;
+}
+
+/* attach a thread pool to a neural network. */
+void nzNetSetThreadPool(nzNet *net, nzThreadPool *pool)
+{
+  net->parallel.pool = pool;
+}
+
+/* attach statistics to a neural network. */
+bool nzNetSetStats(nzNet *net, nzNetStats *stats)
+{
+  nzNetCell *nc;
+  nzGroupStats *gs;
+  nzNeuron *np;
+  nzAxon *ap;
+
+  if( !( net->stats = stats ) ) return true;
+  if( !nzNetStatsAlloc( stats, zListSize(net) ) ){
+    net->stats = NULL;
+    return false;
+  }
+  zListForEach( net, nc ){
+    gs = &stats->group[nc->data.id];
+    gs->nneuron = zListSize( &nc->data.list );
+    gs->nconn = 0;
+    zListForEach( &nc->data.list, np )
+      for( ap=np->data.axon; ap; ap=ap->next ) gs->nconn++;
+    np = zListTail( &nc->data.list );
+    gs->activator = gs->nneuron > 0 && np->data.activator ? np->data.activator->typestr : "nil";
+  }
+  return true;
+}
+
 /* add a neuron group to a neural network. */
 bool nzNetAddGroup(nzNet *net, int num)
 {
   nzNetCell *nc;
+  nzNeuronGroup **index;
 
-  if( !( nc = zAlloc( nzNetCell, 1 ) ) ){
+  if( zListSize(net) >= net->capacity ){
+    if( !( index = zRealloc( net->index, nzNeuronGroup *, zMax( 2*net->capacity, 8 ) ) ) ){
+      ZALLOCERROR();
+      return false;
+    }
+    net->index = index;
+    net->capacity = zMax( 2*net->capacity, 8 );
+  }
+  if( !( nc = nzArenaAllocType( &net->arena, nzNetCell, 1 ) ) ){
     ZALLOCERROR();
     return false;
   }
   nzNeuronGroupInit( &nc->data, zListSize(net) );
+  nc->data.arena = &net->arena;
   if( !nzNeuronGroupAdd( &nc->data, num ) ){
     nzNeuronGroupDestroy( &nc->data );
-    free( nc );
     return false;
   }
+  net->index[zListSize(net)] = &nc->data;
   zListInsertHead( net, nc );
+  net->schedule.valid = false;
   return true;
 }
 
@@ -307,18 +388,22 @@ void nzNetDestroy(nzNet *net)
   while( !zListIsEmpty( net ) ){
     zListDeleteHead( net, &nc );
     nzNeuronGroupDestroy( &nc->data );
-    free( nc );
   }
+  nzArenaDestroy( &net->arena );
+  free( net->index );
+  free( net->parallel.offset );
+  free( net->parallel.neuron );
+  free( net->parallel.p );
+  free( net->parallel.range );
+  free( net->schedule.neuron );
+  free( net->schedule.level );
+  nzNetInit( net );
 }
 
 /* find a neuron group in a neural network. */
 nzNeuronGroup *nzNetFindGroup(nzNet *net, int id)
 {
-  nzNetCell *nc;
-
-  zListForEachRew( net, nc )
-    if( nc->data.id == id ) return &nc->data;
-  return NULL;
+  return id >= 0 && id < zListSize(net) ? net->index[id] : NULL;
 }
 
 /* find a neuron in a neural network. */
@@ -336,10 +421,17 @@ bool nzNetAddNeuron(nzNet *net, int gid, int nid, nzActivator *activator, double
   nzNeuronGroup *ng;
   nzNeuron *np;
 
-  while( !( ng = nzNetFindGroup( net, gid ) ) )
+  if( gid < 0 || nid < 0 ){
+    ZRUNERROR( NEUZ_ERR_NEURON_NOT_FOUND, gid, nid );
+    return false;
+  }
+  net->schedule.valid = false;
+  while( zListSize(net) <= gid )
     if( !nzNetAddGroup( net, 0 ) ) return false;
-  while( !( np = nzNeuronGroupFindNeuron( ng, gid, nid ) ) )
-    if( !nzNeuronGroupAddOne( ng ) ) return false;
+  ng = nzNetFindGroup( net, gid );
+  if( zListSize(&ng->list) <= nid )
+    if( !nzNeuronGroupAdd( ng, nid + 1 - zListSize(&ng->list) ) ) return false;
+  np = nzNeuronGroupFindNeuron( ng, gid, nid );
   np->data.bias = bias;
   np->data.activator = activator;
   return true;
@@ -359,6 +451,7 @@ bool nzNetConnectGroup(nzNet *net, int iu, int id)
     ZRUNERROR( NEUZ_ERR_GROUP_NOT_FOUND, id );
     return false;
   }
+  net->schedule.valid = false;
   zListForEach( &ngd->list, nd ){
     zListForEach( &ngu->list, nu ){
       if( !nzNeuronConnect( nu, nd, zRandF( -1, 1 ) ) ) return false;
@@ -380,9 +473,127 @@ bool nzNetConnect(nzNet *net, int ugid, int unid, int dgid, int dnid, double wei
     ZRUNERROR( NEUZ_ERR_NEURON_NOT_FOUND, dgid, dnid );
     return false;
   }
+  net->schedule.valid = false;
   return nzNeuronConnect( nu, nd, weight );
 }
 
+/* serial number of a neuron in the order of groups. */
+#define _nzNetSerial(offset,np) ( (offset)[(np)->data.gid] + (np)->data.nid )
+
+/* find a neuron on a cycle of neurons left unsorted, which have upstream neurons left unsorted. */
+static nzNeuron *_nzNetTopoSortCycle(nzNeuron **serial, int *offset, int *indeg, int n)
+{
+  nzAxon *ap;
+  int i, j;
+
+  for( j=0; indeg[j]==0; j++ );
+  for( i=0; i<n; i++ ) /* a cycle is reached after n steps upstream */
+    for( ap=serial[j]->data.axon; ap; ap=ap->next )
+      if( indeg[_nzNetSerial(offset,(nzNeuron *)ap->upstream)] > 0 ){
+        j = _nzNetSerial( offset, (nzNeuron *)ap->upstream );
+        break;
+      }
+  return serial[j];
+}
+
+/* sort neurons of a neural network topologically. */
+bool nzNetTopoSort(nzNet *net)
+{
+  nzNetSchedule *sc;
+  nzNetCell *nc;
+  nzNeuron *np, **serial;
+  nzAxon *ap;
+  int *offset, *level, *indeg, *head, *down, *queue;
+  int n = 0, naxon = 0, i, j, k, qh, qt, rank;
+  bool ret = false;
+
+  sc = &net->schedule;
+  zListForEach( net, nc ){
+    n += zListSize( &nc->data.list );
+    zListForEach( &nc->data.list, np )
+      for( ap=np->data.axon; ap; ap=ap->next ) naxon++;
+  }
+  serial = zAlloc( nzNeuron *, n + 1 );
+  offset = zAlloc( int, zListSize(net) + 5 * n + naxon + 2 );
+  if( !serial || !offset ){
+    ZALLOCERROR();
+    goto TERMINATE;
+  }
+  level = offset + zListSize(net);
+  indeg = level + n + 1;
+  head = indeg + n;
+  queue = head + n + 1;
+  down = queue + n;
+  /* serial numbers of neurons and downstream neurons of each neuron */
+  j = 0;
+  zListForEach( net, nc ){
+    offset[nc->data.id] = j;
+    j += zListSize( &nc->data.list );
+  }
+  zListForEach( net, nc )
+    zListForEach( &nc->data.list, np ){
+      serial[_nzNetSerial(offset,np)] = np;
+      for( ap=np->data.axon; ap; ap=ap->next ){
+        indeg[_nzNetSerial(offset,np)]++;
+        head[_nzNetSerial(offset,(nzNeuron *)ap->upstream)+1]++;
+      }
+    }
+  for( j=0; j<n; j++ ) head[j+1] += head[j];
+  memcpy( queue, head, sizeof(int) * n ); /* cursors */
+  for( j=0; j<n; j++ )
+    for( ap=serial[j]->data.axon; ap; ap=ap->next )
+      down[queue[_nzNetSerial(offset,(nzNeuron *)ap->upstream)]++] = j;
+  /* levels of neurons in the order of Kahn's algorithm */
+  for( qt=j=0; j<n; j++ )
+    if( indeg[j] == 0 ) queue[qt++] = j;
+  for( qh=0; qh<qt; qh++ )
+    for( k=head[queue[qh]]; k<head[queue[qh]+1]; k++ ){
+      j = down[k];
+      level[j] = zMax( level[j], level[queue[qh]] + 1 );
+      if( --indeg[j] == 0 ) queue[qt++] = j;
+    }
+  if( qt < n ){
+    np = _nzNetTopoSortCycle( serial, offset, indeg, n );
+    ZRUNERROR( NEUZ_ERR_NET_CYCLIC, np->data.gid, np->data.nid );
+    goto TERMINATE;
+  }
+  /* neurons sorted by levels, and by serial numbers in each level */
+  for( sc->nlevel=0, j=0; j<n; j++ )
+    if( level[j] >= sc->nlevel ) sc->nlevel = level[j] + 1;
+  free( sc->neuron );
+  free( sc->level );
+  sc->neuron = zAlloc( nzNeuron *, n + 1 );
+  sc->level = zAlloc( int, sc->nlevel + 2 );
+  if( !sc->neuron || !sc->level ){
+    ZALLOCERROR();
+    zFree( sc->neuron );
+    zFree( sc->level );
+    sc->nneuron = sc->nlevel = 0;
+    goto TERMINATE;
+  }
+  for( j=0; j<n; j++ ) sc->level[level[j]+1]++;
+  for( i=0; i<sc->nlevel; i++ ) sc->level[i+1] += sc->level[i];
+  memcpy( queue, sc->level, sizeof(int) * sc->nlevel ); /* cursors */
+  for( j=0; j<n; j++ )
+    sc->neuron[queue[level[j]]++] = serial[j];
+  sc->nneuron = n;
+  /* check if levels coincide with non-empty groups in order */
+  sc->grouped = true;
+  rank = 0;
+  zListForEach( net, nc ){
+    if( zListSize( &nc->data.list ) == 0 ) continue;
+    zListForEach( &nc->data.list, np )
+      if( level[_nzNetSerial(offset,np)] != rank ) sc->grouped = false;
+    rank++;
+  }
+  ret = sc->valid = true;
+
+ TERMINATE:
+  free( serial );
+  free( offset );
+  return ret;
+}
+
 /* set input values to the input layer of a neural network. */
 bool nzNetSetInput(nzNet *net, zVec input)
 {
@@ -395,15 +606,224 @@ bool nzNetGetOutput(nzNet *net, zVec output)
   return nzNeuronGroupGetOutput( nzNetOutputLayer(net), output );
 }
 
+/* parallel computation of dependency levels of neurons */
+
+/* task of a dependency level for workers of a thread pool. */
+typedef struct{
+  nzNet *net;
+  nzNeuron **neuron; /* neurons of a level */
+  int n;             /* number of neurons of a level */
+  int lo, hi; /* range of serial numbers of upstream neurons */
+} _nzNetTask;
+
+/* the first neuron of a dependency level of a neural network. */
+#define _nzNetLevelNeuron(net,l) ( (net)->schedule.neuron + (net)->schedule.level[l] )
+/* number of neurons of a dependency level of a neural network. */
+#define _nzNetLevelSize(net,l)   ( (net)->schedule.level[(l)+1] - (net)->schedule.level[l] )
+
+/* check if a dependency level of a neural network is processed in parallel. */
+static bool _nzNetIsParallel(nzNet *net, int l)
+{
+  return net->parallel.pool && net->parallel.pool->size > 1 &&
+    _nzNetLevelSize(net,l) >= net->parallel.threshold;
+}
+
+/* the first neuron of a chunk of a dependency level assigned to a worker. */
+static nzNeuron **_nzNetTaskChunk(_nzNetTask *task, int id, int *n)
+{
+  int i, size;
+
+  size = task->net->parallel.pool->size;
+  i = nzThreadPartition( task->n, id, size );
+  *n = nzThreadPartition( task->n, id+1, size ) - i;
+  return task->neuron + i;
+}
+
+/* propagate a chunk of a dependency level. */
+static void _nzNetPropagateTask(void *arg, int id)
+{
+  nzNeuron **np;
+  int n;
+
+  for( np=_nzNetTaskChunk( (_nzNetTask *)arg, id, &n ); n>0; n--, np++ )
+    nzNeuronPropagate( *np );
+}
+
+/* propagate output values of upstream neurons to a dependency level of a neural network. */
+static void _nzNetLevelPropagate(nzNet *net, int l)
+{
+  _nzNetTask task;
+  nzNeuron **np;
+  int n;
+
+  if( !_nzNetIsParallel( net, l ) ){
+    for( np=_nzNetLevelNeuron(net,l), n=_nzNetLevelSize(net,l); n>0; n--, np++ )
+      nzNeuronPropagate( *np );
+    return;
+  }
+  task.net = net;
+  task.neuron = _nzNetLevelNeuron(net,l);
+  task.n = _nzNetLevelSize(net,l);
+  nzThreadPoolRun( net->parallel.pool, _nzNetPropagateTask, &task );
+}
+
+/* allocate workspace of a neural network for parallel back-propagation. */
+static bool _nzNetParallelAlloc(nzNet *net)
+{
+  nzNetParallel *parallel;
+  nzNetCell *nc;
+  nzNeuron *np;
+  int n = 0;
+
+  parallel = &net->parallel;
+  zListForEach( net, nc ) n += zListSize( &nc->data.list );
+  if( zListSize(net) > parallel->ngroup ){
+    free( parallel->offset );
+    if( !( parallel->offset = zAlloc( int, zListSize(net) ) ) ) goto FAILURE;
+    parallel->ngroup = zListSize(net);
+  }
+  if( n > parallel->nneuron || parallel->pool->size != parallel->nworker ){
+    free( parallel->neuron );
+    free( parallel->p );
+    free( parallel->range );
+    if( !( parallel->neuron = zAlloc( nzNeuron *, n ) ) ||
+        !( parallel->p = zAlloc( double, parallel->pool->size * n ) ) ||
+        !( parallel->range = zAlloc( int, 2 * parallel->pool->size ) ) ) goto FAILURE;
+    parallel->nneuron = n;
+    parallel->nworker = parallel->pool->size;
+  }
+  n = 0;
+  zListForEach( net, nc ){
+    parallel->offset[nc->data.id] = n;
+    zListForEach( &nc->data.list, np )
+      parallel->neuron[n+np->data.nid] = np;
+    n += zListSize( &nc->data.list );
+  }
+  return true;
+
+ FAILURE:
+  ZALLOCERROR();
+  free( parallel->offset ); parallel->offset = NULL;
+  free( parallel->neuron ); parallel->neuron = NULL;
+  free( parallel->p ); parallel->p = NULL;
+  free( parallel->range ); parallel->range = NULL;
+  parallel->nworker = parallel->ngroup = parallel->nneuron = 0;
+  return false;
+}
+
+/* back-propagate loss in a chunk of a dependency level.
+ * loss gradients of upstream neurons are accumulated in a buffer of the worker. */
+static void _nzNetBackPropagateTask(void *arg, int id)
+{
+  nzNetParallel *parallel;
+  nzNeuron **npp, *np, *nu;
+  nzAxon *ap;
+  double *p;
+  int n, j, lo, hi;
+
+  parallel = &((_nzNetTask *)arg)->net->parallel;
+  p = parallel->p + id * parallel->nneuron;
+  lo = parallel->nneuron; hi = -1;
+  for( npp=_nzNetTaskChunk( (_nzNetTask *)arg, id, &n ); n>0; n--, npp++ ){
+    np = *npp;
+    np->data._p *= np->data._v;
+    for( ap=np->data.axon; ap; ap=ap->next ){
+      nu = (nzNeuron *)ap->upstream;
+      j = parallel->offset[nu->data.gid] + nu->data.nid;
+      p[j] += np->data._p * ap->weight;
+      ap->_dw += np->data._p * nu->data.output;
+      if( j < lo ) lo = j;
+      if( j > hi ) hi = j;
+    }
+    np->data._db += np->data._p;
+  }
+  parallel->range[2*id] = lo;
+  parallel->range[2*id+1] = hi;
+}
+
+/* add loss gradients accumulated by workers to upstream neurons in the order of workers. */
+static void _nzNetReducePTask(void *arg, int id)
+{
+  _nzNetTask *task;
+  nzNetParallel *parallel;
+  double *p;
+  int j, j1, k;
+
+  task = (_nzNetTask *)arg;
+  parallel = &task->net->parallel;
+  j  = task->lo + nzThreadPartition( task->hi - task->lo, id,   parallel->pool->size );
+  j1 = task->lo + nzThreadPartition( task->hi - task->lo, id+1, parallel->pool->size );
+  for( ; j<j1; j++ )
+    for( k=0; k<parallel->pool->size; k++ ){
+      p = parallel->p + k * parallel->nneuron + j;
+      parallel->neuron[j]->data._p += *p;
+      *p = 0;
+    }
+}
+
+/* back-propagate loss in a dependency level of a neural network. */
+static void _nzNetLevelBackPropagate(nzNet *net, int l)
+{
+  _nzNetTask task;
+  nzNeuron **np;
+  int k;
+
+  if( !_nzNetIsParallel( net, l ) ){
+    for( np=_nzNetLevelNeuron(net,l), k=_nzNetLevelSize(net,l); k>0; k--, np++ )
+      _nzNeuronBackPropagate( *np );
+    return;
+  }
+  task.net = net;
+  task.neuron = _nzNetLevelNeuron(net,l);
+  task.n = _nzNetLevelSize(net,l);
+  nzThreadPoolRun( net->parallel.pool, _nzNetBackPropagateTask, &task );
+  task.lo = net->parallel.nneuron;
+  task.hi = 0;
+  for( k=0; k<net->parallel.pool->size; k++ ){
+    task.lo = zMin( task.lo, net->parallel.range[2*k] );
+    task.hi = zMax( task.hi, net->parallel.range[2*k+1] + 1 );
+  }
+  if( task.lo < task.hi )
+    nzThreadPoolRun( net->parallel.pool, _nzNetReducePTask, &task );
+}
+
+/* back-propagate loss to neurons without upstream neurons except those of the input layer. */
+static void _nzNetLevelBackPropagateSource(nzNet *net)
+{
+  nzNeuron **np;
+  int n;
+
+  if( net->schedule.nlevel == 0 ) return;
+  for( np=_nzNetLevelNeuron(net,0), n=_nzNetLevelSize(net,0); n>0; n--, np++ )
+    if( (*np)->data.gid != nzNetInputLayer(net)->id )
+      _nzNeuronBackPropagate( *np );
+}
+
+/* statistics are recorded only if attached to a network. */
+#ifdef __NEUZ_NO_STATS__
+#define _nzNetStatsEnabled(net) false
+#else
+#define _nzNetStatsEnabled(net) ( (net)->stats != NULL )
+#endif /* __NEUZ_NO_STATS__ */
+
+/* statistics of a dependency level are recorded as those of a group only if levels coincide with groups. */
+#define _nzNetLevelStatsEnabled(net) ( _nzNetStatsEnabled(net) && (net)->schedule.grouped )
+#define _nzNetLevelGroupID(net,l)    (*_nzNetLevelNeuron(net,l))->data.gid
+
 /* propagate input values to a neural network to the output. */
 double nzNetPropagate(nzNet *net, zVec input)
 {
-  nzNetCell *nc;
+  double t0 = 0;
+  int l;
 
   if( input )
     if( !nzNetSetInput( net, input ) ) return false;
-  zListForEach( net, nc )
-    nzNeuronGroupPropagate( &nc->data );
+  if( !net->schedule.valid && !nzNetTopoSort( net ) ) return false;
+  for( l=0; l<net->schedule.nlevel; l++ ){
+    if( _nzNetLevelStatsEnabled(net) ) t0 = nzStatsClock();
+    _nzNetLevelPropagate( net, l );
+    if( _nzNetLevelStatsEnabled(net) ) nzNetStatsRecord( net->stats, _nzNetLevelGroupID(net,l), NZ_STATS_PROPAGATE, t0 );
+  }
   return true;
 }
 
@@ -425,50 +845,415 @@ static void _nzNetInitParam(nzNet *net)
     _nzNeuronGroupInitParam( &nc->data );
 }
 
-/* initialize parameters of each unit of a neural network for back-propagation. */
-static bool _nzNetInitP(nzNet *net, zVec input, zVec des, double (* lossgrad)(zVec,zVec,int))
+/* initialize parameters of each unit of a neural network for back-propagation.
+ * output is a buffer to store output values of the network. */
+static void _nzNetInitP(nzNet *net, zVec output, zVec des, double (* lossgrad)(zVec,zVec,int))
 {
-  zVec output;
   nzNeuron *np;
   int i = 0;
 
-  if( zVecSize(des) != zListSize( &nzNetOutputLayer(net)->list ) ) return false;
-  if( !( output = zVecAlloc( zVecSizeNC(des) ) ) ) return false;
-  nzNetPropagate( net, input );
   nzNetGetOutput( net, output );
   _nzNetInitParam( net );
   zListForEach( &nzNetOutputLayer(net)->list, np )
     np->data._p = lossgrad( output, des, i++ );
-  zVecFree( output );
+}
+
+/* back-propagate loss of the last propagation in a neural network.
+ * output is a buffer to store output values of the network. */
+static bool _nzNetBackPropagate(nzNet *net, zVec output, zVec des, double (* lossgrad)(zVec,zVec,int))
+{
+  double t0 = 0;
+  int l;
+
+  if( !net->schedule.valid && !nzNetTopoSort( net ) ) return false;
+  if( net->parallel.pool && net->parallel.pool->size > 1 )
+    if( !_nzNetParallelAlloc( net ) ) return false;
+  _nzNetInitP( net, output, des, lossgrad );
+  for( l=net->schedule.nlevel-1; l>0; l-- ){
+    if( _nzNetLevelStatsEnabled(net) ) t0 = nzStatsClock();
+    _nzNetLevelBackPropagate( net, l );
+    if( _nzNetLevelStatsEnabled(net) ) nzNetStatsRecord( net->stats, _nzNetLevelGroupID(net,l), NZ_STATS_BACKPROPAGATE, t0 );
+  }
+  _nzNetLevelBackPropagateSource( net );
   return true;
 }
 
+/* check if loss can be back-propagated in a neural network. */
+static bool _nzNetBackPropagateCheck(nzNet *net, zVec des)
+{
+  if( zListSize(net) < 3 ){
+    ZRUNWARN( NEUZ_WARN_NET_TOOFEWLAYER );
+    return false;
+  }
+  return zVecSize(des) == nzNetOutputSize(net);
+}
+
 /* back-propagate loss and train a neural network. */
 bool nzNetBackPropagate(nzNet *net, zVec input, zVec des, double (* lossgrad)(zVec,zVec,int))
+{
+  zVec output;
+  bool ret;
+
+  if( !_nzNetBackPropagateCheck( net, des ) ) return false;
+  if( !( output = zVecAlloc( zVecSizeNC(des) ) ) ) return false;
+  nzNetPropagate( net, input );
+  ret = _nzNetBackPropagate( net, output, des, lossgrad );
+  zVecFree( output );
+  return ret;
+}
+
+/* allocate a workspace of a neural network for back-propagation. */
+nzNetWorkspace *nzNetWorkspaceAlloc(nzNetWorkspace *ws, nzNet *net)
+{
+  if( !( ws->output = zVecAlloc( nzNetOutputSize(net) ) ) ){
+    ZALLOCERROR();
+    return NULL;
+  }
+  if( net->parallel.pool && net->parallel.pool->size > 1 )
+    if( !_nzNetParallelAlloc( net ) ){
+      nzNetWorkspaceDestroy( ws );
+      return NULL;
+    }
+  return ws;
+}
+
+/* destroy a workspace of a neural network. */
+void nzNetWorkspaceDestroy(nzNetWorkspace *ws)
+{
+  zVecFree( ws->output );
+  ws->output = NULL;
+}
+
+/* back-propagate loss of the last propagation in a neural network. */
+bool nzNetBackPropagateWorkspace(nzNet *net, nzNetWorkspace *ws, zVec des, double (* lossgrad)(zVec,zVec,int))
+{
+  if( !_nzNetBackPropagateCheck( net, des ) ) return false;
+  if( zVecSizeNC(ws->output) != zVecSizeNC(des) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzNetOutputSize(net), zVecSizeNC(ws->output) );
+    return false;
+  }
+  return _nzNetBackPropagate( net, ws->output, des, lossgrad );
+}
+
+/* activation context of a neural network */
+
+/* serial number of a neuron in an activation context. */
+#define _nzNetContextIndex(ctx,np) ( (ctx)->offset[(np)->data.gid] + (np)->data.nid )
+
+/* allocate an activation context of a neural network. */
+nzNetContext *nzNetContextAlloc(nzNetContext *ctx, nzNet *net)
 {
   nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  int j;
 
-  if( zListSize(net) < 3 ){
-    ZRUNWARN( NEUZ_WARN_NET_TOOFEWLAYER );
+  if( !net->schedule.valid && !nzNetTopoSort( net ) ) return NULL;
+  ctx->net = net;
+  ctx->nneuron = ctx->naxon = 0;
+  zListForEach( net, nc ){
+    ctx->nneuron += zListSize( &nc->data.list );
+    zListForEach( &nc->data.list, np )
+      for( ap=np->data.axon; ap; ap=ap->next ) ctx->naxon++;
+  }
+  ctx->offset = zAlloc( int, zListSize(net) );
+  ctx->axon_offset = zAlloc( int, ctx->nneuron );
+  ctx->upstream = zAlloc( int, ctx->naxon );
+  ctx->input = zAlloc( double, 5 * ctx->nneuron + ctx->naxon );
+  ctx->_output = zVecAlloc( nzNetOutputSize(net) );
+  if( !ctx->offset || !ctx->axon_offset || ( !ctx->upstream && ctx->naxon > 0 ) || !ctx->input || !ctx->_output ){
+    ZALLOCERROR();
+    nzNetContextDestroy( ctx );
+    return NULL;
+  }
+  ctx->output = ctx->input + ctx->nneuron;
+  ctx->_p = ctx->output + ctx->nneuron;
+  ctx->_v = ctx->_p + ctx->nneuron;
+  ctx->_db = ctx->_v + ctx->nneuron;
+  ctx->_dw = ctx->_db + ctx->nneuron;
+  j = 0;
+  zListForEach( net, nc ){
+    ctx->offset[nc->data.id] = j;
+    j += zListSize( &nc->data.list );
+  }
+  j = 0;
+  zListForEach( net, nc )
+    zListForEach( &nc->data.list, np ){
+      ctx->axon_offset[_nzNetContextIndex(ctx,np)] = j;
+      for( ap=np->data.axon; ap; ap=ap->next )
+        ctx->upstream[j++] = _nzNetContextIndex( ctx, (nzNeuron *)ap->upstream );
+    }
+  return ctx;
+}
+
+/* destroy an activation context of a neural network. */
+void nzNetContextDestroy(nzNetContext *ctx)
+{
+  zFree( ctx->offset );
+  zFree( ctx->axon_offset );
+  zFree( ctx->upstream );
+  zFree( ctx->input );
+  zVecFree( ctx->_output );
+  ctx->_output = NULL;
+  ctx->output = ctx->_p = ctx->_v = ctx->_db = ctx->_dw = NULL;
+  ctx->nneuron = ctx->naxon = 0;
+  ctx->net = NULL;
+}
+
+/* set input values to an activation context. */
+bool nzNetContextSetInput(nzNetContext *ctx, zVec input)
+{
+  nzNeuron *np;
+  int i = 0;
+
+  if( nzNetInputSize(ctx->net) != zVecSize(input) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzNetInputSize(ctx->net), zVecSize(input) );
     return false;
   }
-  if( !_nzNetInitP( net, input, des, lossgrad ) ) return false;
-  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
-    _nzNeuronGroupBackPropagate( &nc->data );
+  zListForEach( &nzNetInputLayer(ctx->net)->list, np )
+    ctx->input[_nzNetContextIndex(ctx,np)] = zVecElemNC(input,i++);
+  return true;
+}
+
+/* get output values from an activation context. */
+bool nzNetContextGetOutput(nzNetContext *ctx, zVec output)
+{
+  nzNeuron *np;
+  int i = 0;
+
+  if( nzNetOutputSize(ctx->net) != zVecSize(output) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzNetOutputSize(ctx->net), zVecSize(output) );
+    return false;
+  }
+  zListForEach( &nzNetOutputLayer(ctx->net)->list, np )
+    zVecElemNC(output,i++) = ctx->output[_nzNetContextIndex(ctx,np)];
+  return true;
+}
+
+/* propagate input values to the output in an activation context. */
+bool nzNetContextPropagate(nzNetContext *ctx, zVec input)
+{
+  nzNeuron **npp, *np;
+  nzAxon *ap;
+  double x;
+  int n, j, *up;
+
+  if( input )
+    if( !nzNetContextSetInput( ctx, input ) ) return false;
+  for( npp=ctx->net->schedule.neuron, n=ctx->net->schedule.nneuron; n>0; n--, npp++ ){
+    np = *npp;
+    j = _nzNetContextIndex( ctx, np );
+    if( !np->data.activator ){ /* input layer */
+      ctx->output[j] = ctx->input[j];
+      continue;
+    }
+    x = np->data.bias;
+    up = ctx->upstream + ctx->axon_offset[j];
+    for( ap=np->data.axon; ap; ap=ap->next, up++ )
+      x += ap->weight * ctx->output[*up];
+    ctx->input[j] = x;
+    ctx->output[j] = np->data.activator->f( x );
+  }
   return true;
 }
 
+/* initialize gradients of weights and biases in an activation context. */
+void nzNetContextInitGrad(nzNetContext *ctx)
+{
+  memset( ctx->_db, 0, sizeof(double) * ( ctx->nneuron + ctx->naxon ) );
+}
+
+/* back-propagate loss of the last propagation in an activation context. */
+bool nzNetContextBackPropagate(nzNetContext *ctx, zVec des, double (* lossgrad)(zVec,zVec,int))
+{
+  nzNetSchedule *sc;
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  double *dw;
+  int i = 0, j, k, l, *up;
+
+  if( !_nzNetBackPropagateCheck( ctx->net, des ) ) return false;
+  nzNetContextGetOutput( ctx, ctx->_output );
+  zListForEach( ctx->net, nc )
+    zListForEach( &nc->data.list, np ){
+      j = _nzNetContextIndex( ctx, np );
+      ctx->_p[j] = 0;
+      ctx->_v[j] = np->data.activator ? np->data.activator->df( ctx->input[j] ) : 0;
+    }
+  zListForEach( &nzNetOutputLayer(ctx->net)->list, np )
+    ctx->_p[_nzNetContextIndex(ctx,np)] = lossgrad( ctx->_output, des, i++ );
+  /* levels in the descending order, and neurons of a level in the ascending order */
+  sc = &ctx->net->schedule;
+  for( l=sc->nlevel-1; l>=0; l-- )
+    for( k=sc->level[l]; k<sc->level[l+1]; k++ ){
+      np = sc->neuron[k];
+      if( l == 0 && np->data.gid == nzNetInputLayer(ctx->net)->id ) continue;
+      j = _nzNetContextIndex( ctx, np );
+      dw = ctx->_dw + ctx->axon_offset[j];
+      up = ctx->upstream + ctx->axon_offset[j];
+      ctx->_p[j] *= ctx->_v[j];
+      for( ap=np->data.axon; ap; ap=ap->next, dw++, up++ ){
+        ctx->_p[*up] += ctx->_p[j] * ap->weight;
+        *dw += ctx->_p[j] * ctx->output[*up];
+      }
+      ctx->_db[j] += ctx->_p[j];
+    }
+  return true;
+}
+
+/* add gradients of an activation context to the network. */
+void nzNetContextAddGradToNet(nzNetContext *ctx)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  double *dw;
+  int j;
+
+  zListForEach( ctx->net, nc )
+    zListForEach( &nc->data.list, np ){
+      j = _nzNetContextIndex( ctx, np );
+      dw = ctx->_dw + ctx->axon_offset[j];
+      for( ap=np->data.axon; ap; ap=ap->next, dw++ )
+        ap->_dw += *dw;
+      np->data._db += ctx->_db[j];
+    }
+}
+
 /* train a neural network based on the steepest descent method. */
 bool nzNetTrainSDM(nzNet *net, double rate)
 {
   nzNetCell *nc;
+  double t0 = 0;
   bool ret = true;
 
-  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) ){
+    if( _nzNetStatsEnabled(net) ) t0 = nzStatsClock();
     if( !_nzNeuronGroupTrainSDM( &nc->data, rate ) ) ret = false;
+    if( _nzNetStatsEnabled(net) ) nzNetStatsRecord( net->stats, nc->data.id, NZ_STATS_TRAIN, t0 );
+  }
   return ret;
 }
 
+/* count neurons except the input layer and axons of a neural network.
+ * if check is true, it also checks if the network can be compiled into
+ * compressed sparse rows. */
+static bool _nzNetCount(nzNet *net, int *nneuron, int *nconn, bool check)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  int gid;
+
+  *nneuron = *nconn = 0;
+  if( check )
+    zListForEach( &nzNetInputLayer(net)->list, np )
+      if( np->data.activator ){
+        ZRUNERROR( NEUZ_ERR_NET_CSR_INVALID_GROUP, nzNetInputLayer(net)->id );
+        return false;
+      }
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) ){
+    gid = nc->data.id;
+    *nneuron += zListSize( &nc->data.list );
+    zListForEach( &nc->data.list, np ){
+      if( check && !np->data.activator ){
+        ZRUNERROR( NEUZ_ERR_NET_CSR_INVALID_GROUP, gid );
+        return false;
+      }
+      for( ap=np->data.axon; ap; ap=ap->next ){
+        if( check && ((nzNeuron *)ap->upstream)->data.gid >= gid ){
+          ZRUNERROR( NEUZ_ERR_NET_CSR_INVALID_AXON, ((nzNeuron *)ap->upstream)->data.gid, gid );
+          return false;
+        }
+        (*nconn)++;
+      }
+    }
+  }
+  return true;
+}
+
+/* number of weights and biases of a neural network to be trained. */
+int nzNetNumParam(nzNet *net)
+{
+  int nneuron, nconn;
+
+  _nzNetCount( net, &nneuron, &nconn, false );
+  return nneuron + nconn;
+}
+
+/* get gradients of weights and biases of a neural network. */
+bool nzNetGetGrad(nzNet *net, zVec grad)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  double *g;
+
+  if( zVecSizeNC(grad) != nzNetNumParam( net ) ){
+    ZRUNWARN( NEUZ_WARN_NET_MISMATCH_GRAD, nzNetNumParam( net ), zVecSizeNC(grad) );
+    return false;
+  }
+  g = zVecBufNC(grad);
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+    zListForEach( &nc->data.list, np ){
+      for( ap=np->data.axon; ap; ap=ap->next ) *g++ = ap->_dw;
+      *g++ = np->data._db;
+    }
+  return true;
+}
+
+/* number of axons of a neural network. */
+int nzNetNumConnection(nzNet *net)
+{
+  int nneuron, nconn;
+
+  _nzNetCount( net, &nneuron, &nconn, false );
+  return nconn;
+}
+
+/* count neurons and axons of a neural network to be compiled into compressed sparse rows. */
+bool nzNetCountCSR(nzNet *net, int *nneuron, int *nconn)
+{
+  return _nzNetCount( net, nneuron, nconn, true );
+}
+
+/* convert a neural network to compressed sparse rows. */
+bool nzNetToCSR(nzNet *net, int offset[], int upstream[], nzReal weight[], nzReal bias[], nzActivator *activator[])
+{
+  nzNeuronGroup *ng;
+  nzNeuron *np, *up;
+  nzAxon *ap;
+  int *start; /* serial number of the first neuron of each group */
+  int gid, nid, i, c;
+
+  if( !( start = zAlloc( int, zListSize(net) ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  for( i=0, gid=0; gid<zListSize(net); gid++ ){
+    start[gid] = i;
+    i += zListSize( &nzNetFindGroup( net, gid )->list );
+  }
+  for( i=0, c=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++, i++ ){
+      np = ng->index[nid];
+      bias[i] = np->data.bias;
+      if( activator ) activator[i] = np->data.activator;
+      offset[i] = c;
+      for( ap=np->data.axon; ap; ap=ap->next, c++ ){
+        up = (nzNeuron *)ap->upstream;
+        weight[c] = ap->weight;
+        upstream[c] = start[up->data.gid] + up->data.nid;
+      }
+    }
+  }
+  offset[i] = c;
+  free( start );
+  return true;
+}
+
 /* print a neural network. */
 void nzNetFPrint(FILE *fp, nzNet *net)
 {
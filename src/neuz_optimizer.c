@@ -0,0 +1,170 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * optimizers of weights and biases.
+ */
+
+#include <neuz/neuz_optimizer.h>
+
+/* create an optimizer. */
+nzOptimizer *nzOptimizerCreate(nzOptimizer *opt, int type, int n, double rate)
+{
+  opt->type = type;
+  opt->rate = rate;
+  opt->beta1 = NZ_OPTIMIZER_DEFAULT_BETA1;
+  opt->beta2 = type == NZ_OPTIMIZER_RMSPROP ? NZ_OPTIMIZER_DEFAULT_RMSPROP_BETA2 : NZ_OPTIMIZER_DEFAULT_BETA2;
+  opt->eps = NZ_OPTIMIZER_DEFAULT_EPS;
+  opt->n = n;
+  opt->step = 0;
+  opt->_m = opt->_v = NULL;
+  opt->_net = NULL;
+  switch( type ){
+  case NZ_OPTIMIZER_SDM:
+    break;
+  case NZ_OPTIMIZER_MOMENTUM:
+  case NZ_OPTIMIZER_NESTEROV:
+    if( !( opt->_m = zAlloc( nzReal, n ) ) ) goto FAILURE;
+    break;
+  case NZ_OPTIMIZER_RMSPROP:
+    if( !( opt->_v = zAlloc( nzReal, n ) ) ) goto FAILURE;
+    break;
+  case NZ_OPTIMIZER_ADAM:
+    if( !( opt->_m = zAlloc( nzReal, n ) ) ||
+        !( opt->_v = zAlloc( nzReal, n ) ) ) goto FAILURE;
+    break;
+  default:
+    ZRUNERROR( NEUZ_ERR_OPTIMIZER_UNKNOWN, type );
+    return NULL;
+  }
+  return opt;
+
+ FAILURE:
+  ZALLOCERROR();
+  nzOptimizerDestroy( opt );
+  return NULL;
+}
+
+/* destroy an optimizer. */
+void nzOptimizerDestroy(nzOptimizer *opt)
+{
+  zFree( opt->_m );
+  zFree( opt->_v );
+  opt->n = opt->step = 0;
+  opt->_net = NULL;
+}
+
+/* reset internal states of an optimizer. */
+void nzOptimizerReset(nzOptimizer *opt)
+{
+  if( opt->_m ) memset( opt->_m, 0, sizeof(nzReal)*opt->n );
+  if( opt->_v ) memset( opt->_v, 0, sizeof(nzReal)*opt->n );
+  opt->step = 0;
+}
+
+/* coefficient of the update of Adam with the bias correction. */
+static double _nzOptimizerAdamRate(nzOptimizer *opt)
+{
+  return opt->rate * sqrt( 1 - pow( opt->beta2, opt->step ) ) / ( 1 - pow( opt->beta1, opt->step ) );
+}
+
+/* update rules of a parameter p with a gradient g, where i is the index of the parameter.
+ * rate, beta1, beta2, eps, m and v have to be defined in the scope. */
+#define _nzOptimizerSDM(p,g,i)      ( (p) -= rate * (g) )
+#define _nzOptimizerMomentum(p,g,i) do{\
+  m[i] = beta1 * m[i] + (g);\
+  (p) -= rate * m[i];\
+} while(0)
+#define _nzOptimizerNesterov(p,g,i) do{\
+  m[i] = beta1 * m[i] + (g);\
+  (p) -= rate * ( (g) + beta1 * m[i] );\
+} while(0)
+#define _nzOptimizerRMSProp(p,g,i)  do{\
+  v[i] = beta2 * v[i] + ( 1 - beta2 ) * (g) * (g);\
+  (p) -= rate * (g) / ( sqrt( v[i] ) + eps );\
+} while(0)
+#define _nzOptimizerAdam(p,g,i)     do{\
+  m[i] = beta1 * m[i] + ( 1 - beta1 ) * (g);\
+  v[i] = beta2 * v[i] + ( 1 - beta2 ) * (g) * (g);\
+  (p) -= rate * m[i] / ( sqrt( v[i] ) + eps );\
+} while(0)
+
+/* apply an update rule to an array of parameters. */
+#define _nzOptimizerArrayForEach(n,param,grad,rule) do{\
+  int __i;\
+  for( __i=0; __i<(n); __i++ ) rule( (param)[__i], (grad)[__i], __i );\
+} while(0)
+
+/* apply an update rule to weights and biases of a neural network in the
+ * same order with nzNetTrainSDM(). */
+#define _nzOptimizerNetForEach(net,rule) do{\
+  nzNetCell *__nc;\
+  nzNeuron *__np;\
+  nzAxon *__ap;\
+  int __i = 0;\
+  for( __nc=zListHead(net); __nc!=zListTail(net); __nc=zListCellPrev(__nc) )\
+    zListForEach( &__nc->data.list, __np ){\
+      for( __ap=__np->data.axon; __ap; __ap=__ap->next, __i++ )\
+        rule( __ap->weight, __ap->_dw, __i );\
+      rule( __np->data.bias, __np->data._db, __i );\
+      __i++;\
+    }\
+} while(0)
+
+/* update an array of parameters by an optimizer. */
+void nzOptimizerUpdate(nzOptimizer *opt, nzReal *param, const nzReal *grad)
+{
+  nzReal *m = opt->_m, *v = opt->_v;
+  double rate, beta1 = opt->beta1, beta2 = opt->beta2, eps = opt->eps;
+
+  opt->step++;
+  rate = opt->type == NZ_OPTIMIZER_ADAM ? _nzOptimizerAdamRate( opt ) : opt->rate;
+  switch( opt->type ){
+  case NZ_OPTIMIZER_MOMENTUM: _nzOptimizerArrayForEach( opt->n, param, grad, _nzOptimizerMomentum ); break;
+  case NZ_OPTIMIZER_NESTEROV: _nzOptimizerArrayForEach( opt->n, param, grad, _nzOptimizerNesterov ); break;
+  case NZ_OPTIMIZER_RMSPROP:  _nzOptimizerArrayForEach( opt->n, param, grad, _nzOptimizerRMSProp );  break;
+  case NZ_OPTIMIZER_ADAM:     _nzOptimizerArrayForEach( opt->n, param, grad, _nzOptimizerAdam );     break;
+  default:                    _nzOptimizerArrayForEach( opt->n, param, grad, _nzOptimizerSDM );
+  }
+}
+
+/* create an optimizer bound to a neural network. */
+nzOptimizer *nzOptimizerCreateNet(nzOptimizer *opt, int type, nzNet *net, double rate)
+{
+  if( !nzOptimizerCreate( opt, type, nzNetNumParam( net ), rate ) ) return NULL;
+  opt->_net = net;
+  return opt;
+}
+
+/* update weights and biases of a neural network by an optimizer. */
+bool nzOptimizerUpdateNet(nzOptimizer *opt, nzNet *net)
+{
+  nzReal *m = opt->_m, *v = opt->_v;
+  double rate, beta1 = opt->beta1, beta2 = opt->beta2, eps = opt->eps;
+  int n;
+
+  if( opt->_net != net && ( n = nzNetNumParam( net ) ) != opt->n ){
+    ZRUNERROR( NEUZ_ERR_OPTIMIZER_MISMATCH, n, opt->n );
+    return false;
+  }
+  opt->step++;
+  rate = opt->type == NZ_OPTIMIZER_ADAM ? _nzOptimizerAdamRate( opt ) : opt->rate;
+  switch( opt->type ){
+  case NZ_OPTIMIZER_MOMENTUM: _nzOptimizerNetForEach( net, _nzOptimizerMomentum ); break;
+  case NZ_OPTIMIZER_NESTEROV: _nzOptimizerNetForEach( net, _nzOptimizerNesterov ); break;
+  case NZ_OPTIMIZER_RMSPROP:  _nzOptimizerNetForEach( net, _nzOptimizerRMSProp );  break;
+  case NZ_OPTIMIZER_ADAM:     _nzOptimizerNetForEach( net, _nzOptimizerAdam );     break;
+  default:                    _nzOptimizerNetForEach( net, _nzOptimizerSDM );
+  }
+  return true;
+}
+
+/* update weights and biases of a compiled dense-layer network by an optimizer. */
+bool nzOptimizerUpdateDenseNet(nzOptimizer *opt, nzDenseNet *dn)
+{
+  if( dn->nparam != opt->n || !dn->_param ){
+    ZRUNERROR( NEUZ_ERR_OPTIMIZER_MISMATCH, dn->nparam, opt->n );
+    return false;
+  }
+  nzOptimizerUpdate( opt, dn->_param, dn->_grad );
+  return true;
+}
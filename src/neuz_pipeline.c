@@ -0,0 +1,223 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * prefetching pipeline of mini-batches.
+ */
+
+#include <neuz/neuz_pipeline.h>
+#include <neuz/neuz_thread.h>
+
+/* states of a batch in a ring buffer */
+enum{
+  NZ_PIPELINE_EMPTY = 0, NZ_PIPELINE_FILLING, NZ_PIPELINE_READY, NZ_PIPELINE_CONSUMED
+};
+
+/* read samples of a batch and transform them. */
+static void _nzPipelineFill(nzPipeline *pl, nzPipelineBatch *batch, int n)
+{
+  int i, j;
+
+  zMatSetRowSizeNC( batch->input, n );
+  zMatSetRowSizeNC( batch->des, n );
+  if( !pl->ds->_data ) /* a dataset read without mmap() is not thread-safe */
+    pthread_mutex_lock( &pl->mutex );
+  for( i=j=0; i<n; i++ ) /* samples failed to read are skipped */
+    if( nzDatasetGetSample( pl->ds, batch->index[i], zMatRowBufNC(batch->input,j), zMatRowBufNC(batch->des,j) ) ) j++;
+  if( !pl->ds->_data )
+    pthread_mutex_unlock( &pl->mutex );
+  if( pl->transform )
+    for( i=0; i<j; i++ )
+      pl->transform( pl->util, zMatRowBufNC(batch->input,i), zMatRowBufNC(batch->des,i) );
+  zMatSetRowSizeNC( batch->input, j );
+  zMatSetRowSizeNC( batch->des, j );
+  batch->n = j;
+}
+
+/* main loop of a producer thread. */
+static void *_nzPipelineProducerMain(void *arg)
+{
+  nzPipeline *pl;
+  nzPipelineBatch *batch;
+  int n;
+
+  pl = (nzPipeline *)arg;
+  pthread_mutex_lock( &pl->mutex );
+  while( 1 ){
+    while( !pl->_quit && pl->batch[pl->_seq_fill % pl->capacity]._state != NZ_PIPELINE_EMPTY )
+      pthread_cond_wait( &pl->cond_free, &pl->mutex );
+    if( pl->_quit ) break;
+    batch = &pl->batch[pl->_seq_fill % pl->capacity];
+    batch->seq = pl->_seq_fill++;
+    batch->epoch = pl->_epoch;
+    batch->_state = NZ_PIPELINE_FILLING;
+    if( pl->_eoe || ( n = nzDatasetNextIndex( pl->ds, batch->index, pl->batchsize ) ) == 0 ){
+      /* indices of the previous epoch are already copied to batches */
+      batch->n = 0;
+      batch->_eoe = true;
+      batch->_state = NZ_PIPELINE_READY;
+      pl->_eoe = false;
+      pl->_epoch++;
+      nzDatasetRewind( pl->ds );
+      pthread_cond_broadcast( &pl->cond_ready );
+      continue;
+    }
+    batch->_eoe = false;
+    if( n < pl->batchsize ) pl->_eoe = true;
+    pthread_mutex_unlock( &pl->mutex );
+    _nzPipelineFill( pl, batch, n );
+    pthread_mutex_lock( &pl->mutex );
+    batch->_state = NZ_PIPELINE_READY;
+    pthread_cond_broadcast( &pl->cond_ready );
+  }
+  pthread_mutex_unlock( &pl->mutex );
+  return NULL;
+}
+
+/* create a prefetching pipeline. */
+nzPipeline *nzPipelineCreate(nzPipeline *pl, nzDataset *ds, int batchsize, int capacity, int nthread, void (* transform)(void *, double *, double *), void *util)
+{
+  int i;
+
+  if( batchsize < 1 || capacity < 1 || nthread < 1 ){
+    ZRUNERROR( NEUZ_ERR_PIPELINE_INVALID_SIZE, batchsize, capacity, nthread );
+    return NULL;
+  }
+  pl->ds = ds;
+  pl->batchsize = batchsize;
+  pl->capacity = 0;
+  pl->nthread = 0;
+  pl->transform = transform;
+  pl->util = util;
+  pl->_seq_fill = pl->_seq_consume = 0;
+  pl->_epoch = 0;
+  pl->_eoe = pl->_quit = false;
+  pl->batch = zAlloc( nzPipelineBatch, capacity );
+  pl->thread = zAlloc( pthread_t, nthread );
+  if( !pl->batch || !pl->thread ){
+    ZALLOCERROR();
+    goto FAILURE;
+  }
+  for( ; pl->capacity<capacity; pl->capacity++ ){
+    pl->batch[pl->capacity].input = zMatAlloc( batchsize, ds->ninput );
+    pl->batch[pl->capacity].des = zMatAlloc( batchsize, ds->noutput );
+    pl->batch[pl->capacity].index = zAlloc( size_t, batchsize );
+    pl->batch[pl->capacity]._state = NZ_PIPELINE_EMPTY;
+    if( !pl->batch[pl->capacity].input || !pl->batch[pl->capacity].des || !pl->batch[pl->capacity].index ){
+      ZALLOCERROR();
+      pl->capacity++;
+      goto FAILURE;
+    }
+  }
+  pthread_mutex_init( &pl->mutex, NULL );
+  pthread_cond_init( &pl->cond_free, NULL );
+  pthread_cond_init( &pl->cond_ready, NULL );
+  nzDatasetRewind( ds );
+  for( i=0; i<nthread; i++, pl->nthread++ )
+    if( pthread_create( &pl->thread[i], NULL, _nzPipelineProducerMain, pl ) != 0 ){
+      ZRUNERROR( NEUZ_ERR_THREAD_CREATE );
+      nzPipelineDestroy( pl );
+      return NULL;
+    }
+  return pl;
+ FAILURE:
+  pl->nthread = -1; /* mutex and conditions are not initialized */
+  nzPipelineDestroy( pl );
+  return NULL;
+}
+
+/* destroy a prefetching pipeline to join all producer threads. */
+void nzPipelineDestroy(nzPipeline *pl)
+{
+  int i;
+
+  if( pl->nthread >= 0 ){
+    pthread_mutex_lock( &pl->mutex );
+    pl->_quit = true;
+    pthread_cond_broadcast( &pl->cond_free );
+    pthread_mutex_unlock( &pl->mutex );
+    for( i=0; i<pl->nthread; i++ )
+      pthread_join( pl->thread[i], NULL );
+    pthread_cond_destroy( &pl->cond_ready );
+    pthread_cond_destroy( &pl->cond_free );
+    pthread_mutex_destroy( &pl->mutex );
+  }
+  for( i=0; i<pl->capacity; i++ ){
+    zMatFree( pl->batch[i].input );
+    zMatFree( pl->batch[i].des );
+    zFree( pl->batch[i].index );
+  }
+  zFree( pl->batch );
+  zFree( pl->thread );
+  pl->capacity = pl->nthread = 0;
+}
+
+/* get the next batch of a pipeline. */
+nzPipelineBatch *nzPipelineNext(nzPipeline *pl)
+{
+  nzPipelineBatch *batch;
+
+  batch = &pl->batch[pl->_seq_consume % pl->capacity];
+  pthread_mutex_lock( &pl->mutex );
+  while( batch->_state != NZ_PIPELINE_READY || batch->seq != pl->_seq_consume )
+    pthread_cond_wait( &pl->cond_ready, &pl->mutex );
+  if( batch->_eoe ){
+    batch->_state = NZ_PIPELINE_EMPTY;
+    pl->_seq_consume++;
+    pthread_cond_broadcast( &pl->cond_free );
+    batch = NULL;
+  } else
+    batch->_state = NZ_PIPELINE_CONSUMED;
+  pthread_mutex_unlock( &pl->mutex );
+  return batch;
+}
+
+/* release a batch of a pipeline. */
+void nzPipelineRelease(nzPipeline *pl, nzPipelineBatch *batch)
+{
+  pthread_mutex_lock( &pl->mutex );
+  batch->_state = NZ_PIPELINE_EMPTY;
+  pl->_seq_consume++;
+  pthread_cond_broadcast( &pl->cond_free );
+  pthread_mutex_unlock( &pl->mutex );
+}
+
+/* train a neural network with batches of a pipeline. */
+int nzPipelineTrainNet(nzPipeline *pl, nzNet *net, double (* loss)(zVec,zVec), double (* lossgrad)(zVec,zVec,int), double rate, int nepoch, bool (* report)(void *, int, double), void *util)
+{
+  nzPipelineBatch *batch;
+  nzNetWorkspace ws;
+  zVec input, des;
+  double l;
+  int epoch = -1, i;
+
+  if( nzNetInputSize(net) != pl->ds->ninput || nzNetOutputSize(net) != pl->ds->noutput ){
+    ZRUNWARN( NEUZ_WARN_DATASET_MISMATCH );
+    return -1;
+  }
+  if( !nzNetWorkspaceAlloc( &ws, net ) ) return -1;
+  input = zVecAlloc( pl->ds->ninput );
+  des = zVecAlloc( pl->ds->noutput );
+  if( !input || !des ){
+    ZALLOCERROR();
+    goto TERMINATE;
+  }
+  for( epoch=0; epoch<nepoch; ){
+    for( l=0; ( batch = nzPipelineNext( pl ) ); nzPipelineRelease( pl, batch ) ){
+      nzNetInitGrad( net );
+      for( i=0; i<batch->n; i++ ){
+        memcpy( zVecBufNC(input), zMatRowBufNC(batch->input,i), sizeof(double)*zVecSizeNC(input) );
+        memcpy( zVecBufNC(des), zMatRowBufNC(batch->des,i), sizeof(double)*zVecSizeNC(des) );
+        nzNetPropagate( net, input );
+        nzNetBackPropagateWorkspace( net, &ws, des, lossgrad );
+        l += loss( ws.output, des );
+      }
+      nzNetTrainSDM( net, rate );
+    }
+    epoch++;
+    if( report && !report( util, epoch-1, l ) ) break;
+  }
+ TERMINATE:
+  zVecFreeAtOnce( 2, input, des );
+  nzNetWorkspaceDestroy( &ws );
+  return epoch;
+}
@@ -0,0 +1,440 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * int8-quantized dense-layer network.
+ */
+
+#include <neuz/neuz_quant.h>
+#include <neuz/neuz_errmsg.h>
+
+/* dot product of quantized arrays, the size of which is a multiple of NZ_QUANT_ALIGN. */
+static int _nzQuantDotDefault(const signed char *a, const signed char *b, int n)
+{
+  int i, s = 0;
+
+  for( i=0; i<n; i++ ) s += a[i] * b[i];
+  return s;
+}
+
+/* dot products of four rows of a quantized matrix with a quantized array. */
+static void _nzQuantDot4Default(const signed char *w, int stride, const signed char *b, int s[])
+{
+  int i, k;
+
+  for( k=0; k<4; k++, w+=stride )
+    for( s[k]=0, i=0; i<stride; i++ ) s[k] += w[i] * b[i];
+}
+
+#ifdef __NEUZ_SIMD_X86
+#include <immintrin.h>
+
+/* int8 values are sign-extended to int16 and are multiplied and added in pairs. */
+__NZ_SSE2 static int _nzQuantDotSSE2(const signed char *a, const signed char *b, int n)
+{
+  __m128i va, vb, s;
+  int i;
+
+  s = _mm_setzero_si128();
+  for( i=0; i<n; i+=16 ){
+    va = _mm_loadu_si128( (const __m128i *)( a + i ) );
+    vb = _mm_loadu_si128( (const __m128i *)( b + i ) );
+    s = _mm_add_epi32( s, _mm_madd_epi16( _mm_srai_epi16( _mm_unpacklo_epi8( va, va ), 8 ), _mm_srai_epi16( _mm_unpacklo_epi8( vb, vb ), 8 ) ) );
+    s = _mm_add_epi32( s, _mm_madd_epi16( _mm_srai_epi16( _mm_unpackhi_epi8( va, va ), 8 ), _mm_srai_epi16( _mm_unpackhi_epi8( vb, vb ), 8 ) ) );
+  }
+  s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0x4e ) );
+  s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0xb1 ) );
+  return _mm_cvtsi128_si32( s );
+}
+
+__NZ_SSE2 static void _nzQuantDot4SSE2(const signed char *w, int stride, const signed char *b, int s[])
+{
+  __m128i vb, bl, bh, va, s0, s1, s2, s3;
+  int i;
+
+  s0 = s1 = s2 = s3 = _mm_setzero_si128();
+  for( i=0; i<stride; i+=16 ){
+    vb = _mm_loadu_si128( (const __m128i *)( b + i ) );
+    bl = _mm_srai_epi16( _mm_unpacklo_epi8( vb, vb ), 8 );
+    bh = _mm_srai_epi16( _mm_unpackhi_epi8( vb, vb ), 8 );
+#define _nzQuantDot4SSE2Row(s,k) do{\
+  va = _mm_loadu_si128( (const __m128i *)( w + (k)*stride + i ) );\
+  s = _mm_add_epi32( s, _mm_madd_epi16( _mm_srai_epi16( _mm_unpacklo_epi8( va, va ), 8 ), bl ) );\
+  s = _mm_add_epi32( s, _mm_madd_epi16( _mm_srai_epi16( _mm_unpackhi_epi8( va, va ), 8 ), bh ) );\
+} while(0)
+    _nzQuantDot4SSE2Row( s0, 0 );
+    _nzQuantDot4SSE2Row( s1, 1 );
+    _nzQuantDot4SSE2Row( s2, 2 );
+    _nzQuantDot4SSE2Row( s3, 3 );
+#undef _nzQuantDot4SSE2Row
+  }
+  /* transpose and add partial sums */
+  s0 = _mm_add_epi32( _mm_unpacklo_epi32( s0, s1 ), _mm_unpackhi_epi32( s0, s1 ) );
+  s2 = _mm_add_epi32( _mm_unpacklo_epi32( s2, s3 ), _mm_unpackhi_epi32( s2, s3 ) );
+  _mm_storeu_si128( (__m128i *)s, _mm_add_epi32( _mm_unpacklo_epi64( s0, s2 ), _mm_unpackhi_epi64( s0, s2 ) ) );
+}
+
+/* the sign of a is moved to b so that unsigned |a| and signed b are
+ * multiplied by vpmaddubsw, which never saturates for values in
+ * [-127,127]. */
+__NZ_AVX2 static int _nzQuantDotAVX2(const signed char *a, const signed char *b, int n)
+{
+  __m256i va, vb, s, ones;
+  __m128i t;
+  int i;
+
+  s = _mm256_setzero_si256();
+  ones = _mm256_set1_epi16( 1 );
+  for( i=0; i<n; i+=32 ){
+    va = _mm256_loadu_si256( (const __m256i *)( a + i ) );
+    vb = _mm256_loadu_si256( (const __m256i *)( b + i ) );
+    s = _mm256_add_epi32( s, _mm256_madd_epi16( _mm256_maddubs_epi16( _mm256_abs_epi8( va ), _mm256_sign_epi8( vb, va ) ), ones ) );
+  }
+  t = _mm_add_epi32( _mm256_castsi256_si128( s ), _mm256_extracti128_si256( s, 1 ) );
+  t = _mm_add_epi32( t, _mm_shuffle_epi32( t, 0x4e ) );
+  t = _mm_add_epi32( t, _mm_shuffle_epi32( t, 0xb1 ) );
+  return _mm_cvtsi128_si32( t );
+}
+
+/* absolute values of b are shared by four rows. */
+__NZ_AVX2 static void _nzQuantDot4AVX2(const signed char *w, int stride, const signed char *b, int s[])
+{
+  __m256i vb, ab, s0, s1, s2, s3, ones;
+  int i;
+
+  s0 = s1 = s2 = s3 = _mm256_setzero_si256();
+  ones = _mm256_set1_epi16( 1 );
+  for( i=0; i<stride; i+=32 ){
+    vb = _mm256_loadu_si256( (const __m256i *)( b + i ) );
+    ab = _mm256_abs_epi8( vb );
+    s0 = _mm256_add_epi32( s0, _mm256_madd_epi16( _mm256_maddubs_epi16( ab, _mm256_sign_epi8( _mm256_loadu_si256( (const __m256i *)( w + i ) ), vb ) ), ones ) );
+    s1 = _mm256_add_epi32( s1, _mm256_madd_epi16( _mm256_maddubs_epi16( ab, _mm256_sign_epi8( _mm256_loadu_si256( (const __m256i *)( w + stride + i ) ), vb ) ), ones ) );
+    s2 = _mm256_add_epi32( s2, _mm256_madd_epi16( _mm256_maddubs_epi16( ab, _mm256_sign_epi8( _mm256_loadu_si256( (const __m256i *)( w + 2*stride + i ) ), vb ) ), ones ) );
+    s3 = _mm256_add_epi32( s3, _mm256_madd_epi16( _mm256_maddubs_epi16( ab, _mm256_sign_epi8( _mm256_loadu_si256( (const __m256i *)( w + 3*stride + i ) ), vb ) ), ones ) );
+  }
+  s0 = _mm256_hadd_epi32( _mm256_hadd_epi32( s0, s1 ), _mm256_hadd_epi32( s2, s3 ) );
+  _mm_storeu_si128( (__m128i *)s, _mm_add_epi32( _mm256_castsi256_si128( s0 ), _mm256_extracti128_si256( s0, 1 ) ) );
+}
+#endif /* __NEUZ_SIMD_X86 */
+
+static void _nzQuantDot4(const signed char *w, int stride, const signed char *b, int s[])
+{
+#ifdef __NEUZ_SIMD_X86
+  switch( nzSIMDLevel() ){
+  case NZ_SIMD_AVX2: _nzQuantDot4AVX2( w, stride, b, s ); return;
+  case NZ_SIMD_SSE2: _nzQuantDot4SSE2( w, stride, b, s ); return;
+  default: ;
+  }
+#endif /* __NEUZ_SIMD_X86 */
+  _nzQuantDot4Default( w, stride, b, s );
+}
+
+static int _nzQuantDot(const signed char *a, const signed char *b, int n)
+{
+#ifdef __NEUZ_SIMD_X86
+  switch( nzSIMDLevel() ){
+  case NZ_SIMD_AVX2: return _nzQuantDotAVX2( a, b, n );
+  case NZ_SIMD_SSE2: return _nzQuantDotSSE2( a, b, n );
+  default: ;
+  }
+#endif /* __NEUZ_SIMD_X86 */
+  return _nzQuantDotDefault( a, b, n );
+}
+
+/* quantize a real value with the inverse of a scale to an integer in [-127,127]. */
+static signed char _nzQuantize(double val, double invscale)
+{
+  val *= invscale;
+  if( val >= 127 ) return 127;
+  if( val <= -127 ) return -127;
+  return (signed char)( val >= 0 ? (int)( val + 0.5 ) : -(int)( 0.5 - val ) );
+}
+
+/* scale to quantize values of which the maximum absolute is amax. */
+#define _nzQuantScale(amax) ( (amax) > 0 ? (amax) / 127.0 : 1.0 )
+
+/* propagate upstream outputs through a quantized layer. */
+static void _nzQuantLayerPropagate(nzQuantLayer *layer, const nzReal *upstream, nzReal *output, signed char *q)
+{
+  const signed char *w;
+  double invscale;
+  int i, k, s[4];
+
+  invscale = 1.0 / layer->input_scale;
+  for( i=0; i<layer->nin; i++ ) q[i] = _nzQuantize( upstream[i], invscale );
+  for( ; i<layer->stride; i++ ) q[i] = 0;
+  for( w=layer->weight, i=0; i<=layer->nout-4; i+=4, w+=4*layer->stride ){
+    _nzQuantDot4( w, layer->stride, q, s );
+    for( k=0; k<4; k++ )
+      output[i+k] = layer->bias[i+k] + (double)s[k] * layer->scale[i+k] * layer->input_scale;
+  }
+  for( ; i<layer->nout; i++, w+=layer->stride )
+    output[i] = layer->bias[i] + (double)_nzQuantDot( w, q, layer->stride ) * layer->scale[i] * layer->input_scale;
+  nzActivatorFArray( layer->activator, output, output, layer->nout );
+}
+
+/* initialize a quantized network. */
+void nzQuantNetInit(nzQuantNet *qn)
+{
+  qn->size = 0;
+  qn->layer = NULL;
+  qn->granularity = NZ_QUANT_PER_NEURON;
+  qn->_size = 0;
+  qn->_buf = NULL;
+  qn->_work = NULL;
+  qn->_q = NULL;
+}
+
+/* destroy a quantized network. */
+void nzQuantNetDestroy(nzQuantNet *qn)
+{
+  free( qn->layer );
+  free( qn->_buf );
+  free( qn->_work );
+  free( qn->_q );
+  nzQuantNetInit( qn );
+}
+
+/* size of an array in a buffer aligned at NZ_QUANT_ALIGN bytes. */
+#define _nzQuantAlign(size) ( ( (size) + NZ_QUANT_ALIGN - 1 ) / NZ_QUANT_ALIGN * NZ_QUANT_ALIGN )
+
+/* allocate buffers of a quantized network. */
+static bool _nzQuantNetAlloc(nzQuantNet *qn, nzDenseNet *dn)
+{
+  nzQuantLayer *layer;
+  char *p;
+  int i, width, stride;
+
+  qn->size = dn->size;
+  if( !( qn->layer = zAlloc( nzQuantLayer, qn->size ) ) ) return false;
+  width = nzDenseNetInputSize(dn);
+  stride = 0;
+  for( i=0; i<qn->size; i++ ){
+    layer = &qn->layer[i];
+    layer->nin = dn->layer[i].nin;
+    layer->nout = dn->layer[i].nout;
+    layer->stride = _nzQuantAlign( layer->nin );
+    layer->activator = dn->layer[i].activator;
+    layer->input_scale = _nzQuantScale( 1.0 );
+    qn->_size += _nzQuantAlign( sizeof(signed char) * layer->stride * layer->nout )
+               + _nzQuantAlign( sizeof(float) * layer->nout )
+               + _nzQuantAlign( sizeof(nzReal) * layer->nout );
+    width = zMax( width, layer->nout );
+    stride = zMax( stride, layer->stride );
+  }
+  if( !( qn->_buf = p = zAlloc( char, qn->_size ) ) ||
+      !( qn->_work = zAlloc( nzReal, 2 * width ) ) ||
+      !( qn->_q = zAlloc( signed char, stride ) ) ) return false;
+  for( layer=qn->layer; layer<qn->layer+qn->size; layer++ ){
+    layer->weight = (signed char *)p; p += _nzQuantAlign( sizeof(signed char) * layer->stride * layer->nout );
+    layer->scale = (float *)p;        p += _nzQuantAlign( sizeof(float) * layer->nout );
+    layer->bias = (nzReal *)p;        p += _nzQuantAlign( sizeof(nzReal) * layer->nout );
+  }
+  return true;
+}
+
+/* quantize weights of a dense layer. */
+static void _nzQuantLayerQuantize(nzQuantLayer *layer, nzDenseLayer *src, int granularity)
+{
+  const nzReal *w;
+  double amax = 0;
+  int i, j;
+
+  for( w=src->weight, i=0; i<layer->nout; i++, w+=layer->nin ){
+    if( granularity == NZ_QUANT_PER_NEURON ) amax = 0;
+    for( j=0; j<layer->nin; j++ ) amax = zMax( amax, fabs( w[j] ) );
+    layer->scale[i] = _nzQuantScale( amax );
+  }
+  if( granularity == NZ_QUANT_PER_LAYER )
+    for( i=0; i<layer->nout; i++ ) layer->scale[i] = _nzQuantScale( amax );
+  for( w=src->weight, i=0; i<layer->nout; i++, w+=layer->nin ){
+    for( j=0; j<layer->nin; j++ )
+      layer->weight[i*layer->stride+j] = _nzQuantize( w[j], 1.0 / layer->scale[i] );
+    for( ; j<layer->stride; j++ )
+      layer->weight[i*layer->stride+j] = 0;
+    layer->bias[i] = src->bias[i];
+  }
+}
+
+/* quantize weights of a compiled dense-layer network. */
+nzQuantNet *nzQuantNetCreate(nzQuantNet *qn, nzDenseNet *dn, int granularity)
+{
+  int i;
+
+  nzQuantNetInit( qn );
+  if( granularity != NZ_QUANT_PER_LAYER && granularity != NZ_QUANT_PER_NEURON ){
+    ZRUNERROR( NEUZ_ERR_QUANT_GRANULARITY, granularity );
+    return NULL;
+  }
+  qn->granularity = granularity;
+  if( !_nzQuantNetAlloc( qn, dn ) ){
+    ZALLOCERROR();
+    nzQuantNetDestroy( qn );
+    return NULL;
+  }
+  for( i=0; i<qn->size; i++ )
+    _nzQuantLayerQuantize( &qn->layer[i], &dn->layer[i], granularity );
+  return qn;
+}
+
+/* check if a quantized network was created from a compiled dense-layer network. */
+static bool _nzQuantNetCheckDenseNet(nzQuantNet *qn, nzDenseNet *dn)
+{
+  int i;
+
+  if( qn->size != dn->size ) goto FAILURE;
+  for( i=0; i<qn->size; i++ )
+    if( qn->layer[i].nin != dn->layer[i].nin || qn->layer[i].nout != dn->layer[i].nout ) goto FAILURE;
+  return true;
+ FAILURE:
+  ZRUNERROR( NEUZ_ERR_QUANT_MISMATCH );
+  return false;
+}
+
+/* update maximum absolute inputs of layers with a sample. */
+static void _nzQuantNetCalibrateSample(nzQuantNet *qn, nzDenseNet *dn, zVec input, double amax[])
+{
+  const nzReal *upstream;
+  int i, j;
+
+  nzDenseNetPropagate( dn, input );
+  for( upstream=dn->input, i=0; i<qn->size; upstream=dn->layer[i++].output )
+    for( j=0; j<qn->layer[i].nin; j++ )
+      amax[i] = zMax( amax[i], fabs( upstream[j] ) );
+}
+
+/* set scales of inputs of layers from maximum absolute inputs. */
+static void _nzQuantNetCalibrateScale(nzQuantNet *qn, double amax[])
+{
+  int i;
+
+  for( i=0; i<qn->size; i++ )
+    qn->layer[i].input_scale = _nzQuantScale( amax[i] );
+}
+
+/* calibrate scales of inputs of layers of a quantized network. */
+bool nzQuantNetCalibrate(nzQuantNet *qn, nzDenseNet *dn, zMat sample)
+{
+  double *amax;
+  zVec input;
+  int i;
+
+  if( !_nzQuantNetCheckDenseNet( qn, dn ) ) return false;
+  if( zMatColSizeNC(sample) != nzQuantNetInputSize(qn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzQuantNetInputSize(qn), zMatRowSizeNC(sample), zMatColSizeNC(sample) );
+    return false;
+  }
+  amax = zAlloc( double, qn->size );
+  input = zVecAlloc( nzQuantNetInputSize(qn) );
+  if( !amax || !input ){
+    ZALLOCERROR();
+    free( amax );
+    zVecFree( input );
+    return false;
+  }
+  for( i=0; i<zMatRowSizeNC(sample); i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(sample,i), sizeof(double)*zVecSizeNC(input) );
+    _nzQuantNetCalibrateSample( qn, dn, input, amax );
+  }
+  _nzQuantNetCalibrateScale( qn, amax );
+  free( amax );
+  zVecFree( input );
+  return true;
+}
+
+/* calibrate scales of inputs of layers of a quantized network with a list of samples. */
+bool nzQuantNetCalibrateList(nzQuantNet *qn, nzDenseNet *dn, zVecList *sample)
+{
+  zVecListCell *cp;
+  double *amax;
+
+  if( !_nzQuantNetCheckDenseNet( qn, dn ) ) return false;
+  zListForEach( sample, cp )
+    if( zVecSizeNC(cp->data) != nzQuantNetInputSize(qn) ){
+      ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzQuantNetInputSize(qn), zVecSizeNC(cp->data) );
+      return false;
+    }
+  if( !( amax = zAlloc( double, qn->size ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  zListForEach( sample, cp )
+    _nzQuantNetCalibrateSample( qn, dn, cp->data, amax );
+  _nzQuantNetCalibrateScale( qn, amax );
+  free( amax );
+  return true;
+}
+
+/* maximum size of input and output of layers of a quantized network. */
+static int _nzQuantNetWidth(nzQuantNet *qn)
+{
+  int i, width;
+
+  width = nzQuantNetInputSize(qn);
+  for( i=0; i<qn->size; i++ ) width = zMax( width, qn->layer[i].nout );
+  return width;
+}
+
+/* propagate input values to a quantized network to the output. */
+bool nzQuantNetPropagate(nzQuantNet *qn, zVec input, zVec output)
+{
+  nzReal *upstream, *downstream, *tmp;
+  int i;
+
+  if( zVecSizeNC(input) != nzQuantNetInputSize(qn) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzQuantNetInputSize(qn), zVecSizeNC(input) );
+    return false;
+  }
+  if( zVecSizeNC(output) != nzQuantNetOutputSize(qn) ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, nzQuantNetOutputSize(qn), zVecSizeNC(output) );
+    return false;
+  }
+  upstream = qn->_work;
+  downstream = qn->_work + _nzQuantNetWidth( qn );
+  for( i=0; i<zVecSizeNC(input); i++ ) upstream[i] = zVecElemNC(input,i);
+  for( i=0; i<qn->size; i++ ){
+    _nzQuantLayerPropagate( &qn->layer[i], upstream, downstream, qn->_q );
+    tmp = upstream; upstream = downstream; downstream = tmp;
+  }
+  for( i=0; i<zVecSizeNC(output); i++ ) zVecElemNC(output,i) = upstream[i];
+  return true;
+}
+
+/* accuracy of a quantized network against a neural network. */
+bool nzQuantNetDelta(nzQuantNet *qn, nzNet *net, zMat sample, double *maxerr, double *rmserr)
+{
+  zVec input, output, output_q;
+  double e, emax = 0, esum = 0;
+  int i, j;
+
+  if( nzNetInputSize(net) != nzQuantNetInputSize(qn) || nzNetOutputSize(net) != nzQuantNetOutputSize(qn) ){
+    ZRUNERROR( NEUZ_ERR_QUANT_MISMATCH );
+    return false;
+  }
+  if( zMatColSizeNC(sample) != nzQuantNetInputSize(qn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzQuantNetInputSize(qn), zMatRowSizeNC(sample), zMatColSizeNC(sample) );
+    return false;
+  }
+  input = zVecAlloc( nzQuantNetInputSize(qn) );
+  output = zVecAlloc( nzQuantNetOutputSize(qn) );
+  output_q = zVecAlloc( nzQuantNetOutputSize(qn) );
+  if( !input || !output || !output_q ){
+    ZALLOCERROR();
+    zVecFreeAtOnce( 3, input, output, output_q );
+    return false;
+  }
+  for( i=0; i<zMatRowSizeNC(sample); i++ ){
+    memcpy( zVecBufNC(input), zMatRowBufNC(sample,i), sizeof(double)*zVecSizeNC(input) );
+    nzNetPropagate( net, input );
+    nzNetGetOutput( net, output );
+    nzQuantNetPropagate( qn, input, output_q );
+    for( j=0; j<zVecSizeNC(output); j++ ){
+      e = fabs( zVecElemNC(output,j) - zVecElemNC(output_q,j) );
+      emax = zMax( emax, e );
+      esum += e * e;
+    }
+  }
+  if( maxerr ) *maxerr = emax;
+  if( rmserr ) *rmserr = zMatRowSizeNC(sample) > 0 ? sqrt( esum / ( zMatRowSizeNC(sample) * zVecSizeNC(output) ) ) : 0;
+  zVecFreeAtOnce( 3, input, output, output_q );
+  return true;
+}
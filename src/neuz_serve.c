@@ -0,0 +1,228 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * protocol and client of the inference server.
+ */
+
+#define _DEFAULT_SOURCE
+#include <neuz/neuz_serve.h>
+#include <neuz/neuz_errmsg.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL /* SIGPIPE is to be ignored by the caller */
+#define MSG_NOSIGNAL 0
+#endif /* MSG_NOSIGNAL */
+
+/* send all bytes of a buffer to a socket. */
+static bool _nzServeWriteAll(int fd, const void *buf, size_t len)
+{
+  ssize_t n;
+
+  while( len > 0 ){
+    if( ( n = send( fd, buf, len, MSG_NOSIGNAL ) ) < 0 ){
+      if( errno == EINTR ) continue;
+      return false;
+    }
+    buf = (const char *)buf + n;
+    len -= n;
+  }
+  return true;
+}
+
+/* receive bytes of a given length from a socket. */
+static bool _nzServeReadAll(int fd, void *buf, size_t len)
+{
+  ssize_t n;
+
+  while( len > 0 ){
+    if( ( n = recv( fd, buf, len, 0 ) ) <= 0 ){
+      if( n < 0 && errno == EINTR ) continue;
+      return false;
+    }
+    buf = (char *)buf + n;
+    len -= n;
+  }
+  return true;
+}
+
+/* send a message to a socket. */
+bool nzServeSend(int fd, uint32_t code, const void *payload, uint32_t len)
+{
+  uint32_t header[2];
+
+  header[0] = code;
+  header[1] = len;
+  return _nzServeWriteAll( fd, header, sizeof(header) ) &&
+         ( len == 0 || _nzServeWriteAll( fd, payload, len ) );
+}
+
+/* receive a message from a socket. */
+bool nzServeRecv(int fd, uint32_t *code, uint32_t *len, void **buf, size_t *size)
+{
+  uint32_t header[2];
+  void *p;
+
+  if( !_nzServeReadAll( fd, header, sizeof(header) ) ) return false;
+  *code = header[0];
+  *len = header[1];
+  if( *len > NZ_SERVE_MAX_PAYLOAD ){
+    ZRUNERROR( NEUZ_ERR_SERVE_TOOLONG, (unsigned long)*len );
+    return false;
+  }
+  if( *len + 1 > *size ){ /* one more byte to terminate a text */
+    if( !( p = zRealloc( *buf, char, *len + 1 ) ) ){
+      ZALLOCERROR();
+      return false;
+    }
+    *buf = p;
+    *size = *len + 1;
+  }
+  ((char *)*buf)[*len] = '\0';
+  return *len == 0 || _nzServeReadAll( fd, *buf, *len );
+}
+
+/* comparison of values for qsort(). */
+static int _nzServeCmp(const void *v1, const void *v2)
+{
+  return *(const double *)v1 < *(const double *)v2 ? -1 :
+         *(const double *)v1 > *(const double *)v2 ? 1 : 0;
+}
+
+/* percentiles of values. */
+void nzServePercentile(double val[], int n, const double p[], double q[], int np)
+{
+  int i, k;
+
+  qsort( val, n, sizeof(double), _nzServeCmp );
+  for( i=0; i<np; i++ ){
+    if( n == 0 ){
+      q[i] = 0;
+      continue;
+    }
+    k = (int)ceil( p[i] / 100 * n ) - 1;
+    q[i] = val[zLimit(k,0,n-1)];
+  }
+}
+
+/* send a request and receive the response. */
+static bool _nzServeClientRequest(nzServeClient *client, uint32_t code, const void *payload, uint32_t len, uint32_t *rlen)
+{
+  uint32_t status;
+
+  if( !nzServeSend( client->fd, code, payload, len ) ||
+      !nzServeRecv( client->fd, &status, rlen, &client->_buf, &client->_size ) ){
+    ZRUNERROR( NEUZ_ERR_SERVE_DISCONNECT );
+    return false;
+  }
+  if( status != NZ_SERVE_OK ){
+    ZRUNERROR( NEUZ_ERR_SERVE_FAILED, (const char *)client->_buf );
+    return false;
+  }
+  return true;
+}
+
+/* connect to the inference server. */
+nzServeClient *nzServeClientConnect(nzServeClient *client, const char path[])
+{
+  struct sockaddr_un addr;
+  uint32_t len;
+
+  client->_buf = NULL;
+  client->_size = 0;
+  client->ninput = client->noutput = 0;
+  if( !path ) path = NZ_SERVE_DEFAULT_PATH;
+  if( strlen( path ) >= sizeof(addr.sun_path) ){
+    ZRUNERROR( NEUZ_ERR_SERVE_PATH, path );
+    return NULL;
+  }
+  memset( &addr, 0, sizeof(addr) );
+  addr.sun_family = AF_UNIX;
+  strcpy( addr.sun_path, path );
+  if( ( client->fd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) < 0 ||
+      connect( client->fd, (struct sockaddr *)&addr, sizeof(addr) ) < 0 ){
+    ZRUNERROR( NEUZ_ERR_SERVE_CONNECT, path );
+    goto FAILURE;
+  }
+  if( !_nzServeClientRequest( client, NZ_SERVE_INFO, NULL, 0, &len ) ) goto FAILURE;
+  if( len != 2 * sizeof(uint32_t) ){
+    ZRUNERROR( NEUZ_ERR_SERVE_PROTOCOL );
+    goto FAILURE;
+  }
+  client->ninput = ((uint32_t *)client->_buf)[0];
+  client->noutput = ((uint32_t *)client->_buf)[1];
+  return client;
+
+ FAILURE:
+  nzServeClientClose( client );
+  return NULL;
+}
+
+/* close a connection to the inference server. */
+void nzServeClientClose(nzServeClient *client)
+{
+  if( client->fd >= 0 ) close( client->fd );
+  client->fd = -1;
+  zFree( client->_buf );
+  client->_size = 0;
+}
+
+/* predict outputs of a sample by the inference server. */
+bool nzServeClientPredict(nzServeClient *client, zVec input, zVec output)
+{
+  uint32_t len;
+
+  if( zVecSizeNC(input) != client->ninput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, client->ninput, zVecSizeNC(input) );
+    return false;
+  }
+  if( zVecSizeNC(output) != client->noutput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, client->noutput, zVecSizeNC(output) );
+    return false;
+  }
+  if( !_nzServeClientRequest( client, NZ_SERVE_PREDICT, zVecBufNC(input), sizeof(double)*client->ninput, &len ) )
+    return false;
+  if( len != sizeof(double) * client->noutput ){
+    ZRUNERROR( NEUZ_ERR_SERVE_PROTOCOL );
+    return false;
+  }
+  memcpy( zVecBufNC(output), client->_buf, len );
+  return true;
+}
+
+/* predict outputs of a batch of samples by the inference server. */
+bool nzServeClientPredictBatch(nzServeClient *client, zMat input, zMat output)
+{
+  uint32_t len;
+
+  if( zMatColSizeNC(input) != client->ninput || zMatColSizeNC(output) != client->noutput ||
+      zMatRowSizeNC(input) != zMatRowSizeNC(output) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, client->ninput, zMatRowSizeNC(input), zMatColSizeNC(input) );
+    return false;
+  }
+  if( !_nzServeClientRequest( client, NZ_SERVE_PREDICT, zMatBufNC(input), sizeof(double)*zMatRowSizeNC(input)*client->ninput, &len ) )
+    return false;
+  if( len != sizeof(double) * zMatRowSizeNC(output) * client->noutput ){
+    ZRUNERROR( NEUZ_ERR_SERVE_PROTOCOL );
+    return false;
+  }
+  memcpy( zMatBufNC(output), client->_buf, len );
+  return true;
+}
+
+/* statistics of the inference server. */
+char *nzServeClientStats(nzServeClient *client)
+{
+  uint32_t len;
+  char *str;
+
+  if( !_nzServeClientRequest( client, NZ_SERVE_STATS, NULL, 0, &len ) ) return NULL;
+  if( !( str = zAlloc( char, len + 1 ) ) ){
+    ZALLOCERROR();
+    return NULL;
+  }
+  memcpy( str, client->_buf, len + 1 );
+  return str;
+}
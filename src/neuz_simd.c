@@ -0,0 +1,33 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * selection of SIMD instruction sets.
+ */
+
+#include <neuz/neuz_simd.h>
+
+static int __nz_simd_level = -1;
+
+/* the highest level of SIMD instruction set supported by the processor. */
+static int _nzSIMDLevelSupported(void)
+{
+#ifdef __NEUZ_SIMD_X86
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) ) return NZ_SIMD_AVX2;
+  if( __builtin_cpu_supports( "sse2" ) ) return NZ_SIMD_SSE2;
+#endif /* __NEUZ_SIMD_X86 */
+  return NZ_SIMD_NONE;
+}
+
+/* level of SIMD instruction set currently used. */
+int nzSIMDLevel(void)
+{
+  if( __nz_simd_level < 0 ) __nz_simd_level = _nzSIMDLevelSupported();
+  return __nz_simd_level;
+}
+
+/* set the level of SIMD instruction set. */
+int nzSIMDSetLevel(int level)
+{
+  return __nz_simd_level = zMax( zMin( level, _nzSIMDLevelSupported() ), NZ_SIMD_NONE );
+}
@@ -0,0 +1,305 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * pruning and compiled sparse network.
+ */
+
+#include <neuz/neuz_sparse.h>
+#include <neuz/neuz_errmsg.h>
+
+/* free an axon unless it is allocated from the arena of a neuron. */
+static void _nzNeuronFreeAxon(nzNeuron *np, nzAxon *ap)
+{
+  if( !np->data.arena ) free( ap );
+}
+
+/* prune axons with small absolute weights. */
+int nzNetPrune(nzNet *net, double threshold)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon **app, *ap;
+  int n = 0;
+
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+    zListForEach( &nc->data.list, np )
+      for( app=&np->data.axon; *app; ){
+        if( fabs( (*app)->weight ) >= threshold ){
+          app = &(*app)->next;
+          continue;
+        }
+        ap = *app;
+        *app = ap->next;
+        _nzNeuronFreeAxon( np, ap );
+        n++;
+      }
+  net->schedule.valid = false;
+  return n;
+}
+
+/* axon with its position in a list to be sorted. */
+typedef struct{
+  nzAxon *axon;
+  int order;
+} _nzAxonRank;
+
+/* comparison of axons in descending order of absolute weights. */
+static int _nzAxonRankCmpWeight(const void *v1, const void *v2)
+{
+  const _nzAxonRank *r1 = v1, *r2 = v2;
+  double w1, w2;
+
+  w1 = fabs( r1->axon->weight );
+  w2 = fabs( r2->axon->weight );
+  if( w1 > w2 ) return -1;
+  if( w1 < w2 ) return 1;
+  return r1->order - r2->order;
+}
+
+/* comparison of axons in ascending order of positions. */
+static int _nzAxonRankCmpOrder(const void *v1, const void *v2)
+{
+  return ((const _nzAxonRank *)v1)->order - ((const _nzAxonRank *)v2)->order;
+}
+
+/* keep axons with the largest absolute weights of a neuron. */
+static int _nzNeuronPruneTopK(nzNeuron *np, int k, _nzAxonRank *rank)
+{
+  nzAxon *ap;
+  int i, n;
+
+  for( n=0, ap=np->data.axon; ap; ap=ap->next, n++ ){
+    rank[n].axon = ap;
+    rank[n].order = n;
+  }
+  if( n <= k ) return 0;
+  qsort( rank, n, sizeof(_nzAxonRank), _nzAxonRankCmpWeight );
+  for( i=k; i<n; i++ ) _nzNeuronFreeAxon( np, rank[i].axon );
+  if( k == 0 ){
+    np->data.axon = NULL;
+    return n;
+  }
+  qsort( rank, k, sizeof(_nzAxonRank), _nzAxonRankCmpOrder );
+  np->data.axon = rank[0].axon;
+  for( i=1; i<k; i++ ) rank[i-1].axon->next = rank[i].axon;
+  rank[k-1].axon->next = NULL;
+  return n - k;
+}
+
+/* prune axons except those with the largest absolute weights of each neuron. */
+int nzNetPruneTopK(nzNet *net, int k)
+{
+  nzNetCell *nc;
+  nzNeuron *np;
+  nzAxon *ap;
+  _nzAxonRank *rank;
+  int n, nmax = 0;
+
+  if( k < 0 ) k = 0;
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+    zListForEach( &nc->data.list, np ){
+      for( n=0, ap=np->data.axon; ap; ap=ap->next ) n++;
+      if( n > nmax ) nmax = n;
+    }
+  if( nmax <= k ) return 0;
+  if( !( rank = zAlloc( _nzAxonRank, nmax ) ) ){
+    ZALLOCERROR();
+    return -1;
+  }
+  n = 0;
+  for( nc=zListHead(net); nc!=zListTail(net); nc=zListCellPrev(nc) )
+    zListForEach( &nc->data.list, np )
+      n += _nzNeuronPruneTopK( np, k, rank );
+  free( rank );
+  net->schedule.valid = false;
+  return n;
+}
+
+/* initialize a compiled sparse network. */
+void nzSparseNetInit(nzSparseNet *sn)
+{
+  sn->ninput = sn->noutput = sn->nneuron = sn->nconn = sn->nparam = 0;
+  sn->weight = sn->bias = NULL;
+  sn->offset = sn->upstream = NULL;
+  sn->activator = NULL;
+  sn->value = sn->input = NULL;
+  sn->_param = sn->_grad = sn->_dw = sn->_db = sn->_p = NULL;
+  sn->_output = NULL;
+}
+
+/* destroy a compiled sparse network. */
+void nzSparseNetDestroy(nzSparseNet *sn)
+{
+  free( sn->offset );
+  free( sn->upstream );
+  free( sn->activator );
+  free( sn->value );
+  free( sn->input );
+  free( sn->_param );
+  free( sn->_grad );
+  free( sn->_p );
+  zVecFree( sn->_output );
+  nzSparseNetInit( sn );
+}
+
+/* allocate arrays of a compiled sparse network. */
+static bool _nzSparseNetAlloc(nzSparseNet *sn)
+{
+  sn->offset = zAlloc( int, sn->nneuron + 1 );
+  sn->upstream = zAlloc( int, sn->nconn );
+  sn->activator = zAlloc( nzActivator *, sn->nneuron );
+  sn->value = zAlloc( nzReal, sn->ninput + sn->nneuron );
+  sn->input = zAlloc( nzReal, sn->nneuron );
+  sn->_param = zAlloc( nzReal, sn->nparam );
+  sn->_grad = zAlloc( nzReal, sn->nparam );
+  sn->_p = zAlloc( nzReal, sn->ninput + sn->nneuron );
+  sn->_output = zVecAlloc( sn->noutput );
+  if( !sn->offset || ( sn->nconn > 0 && !sn->upstream ) || !sn->activator || !sn->value || !sn->input ||
+      !sn->_param || !sn->_grad || !sn->_p || !sn->_output ){
+    ZALLOCERROR();
+    return false;
+  }
+  sn->weight = sn->_param;
+  sn->bias = sn->_param + sn->nconn;
+  sn->_dw = sn->_grad;
+  sn->_db = sn->_grad + sn->nconn;
+  return true;
+}
+
+/* compile a neural network into a sparse network. */
+nzSparseNet *nzSparseNetCompile(nzSparseNet *sn, nzNet *net)
+{
+  nzSparseNetInit( sn );
+  if( zListSize(net) < 2 ){
+    ZRUNERROR( NEUZ_ERR_SPARSE_TOOFEWLAYER );
+    return NULL;
+  }
+  if( !nzNetCountCSR( net, &sn->nneuron, &sn->nconn ) ) goto FAILURE;
+  sn->ninput = nzNetInputSize(net);
+  sn->noutput = nzNetOutputSize(net);
+  sn->nparam = sn->nconn + sn->nneuron;
+  if( !_nzSparseNetAlloc( sn ) ||
+      !nzNetToCSR( net, sn->offset, sn->upstream, sn->weight, sn->bias, sn->activator ) ) goto FAILURE;
+  nzSparseNetInitGrad( sn );
+  return sn;
+
+ FAILURE:
+  nzSparseNetDestroy( sn );
+  return NULL;
+}
+
+/* copy weights and biases of a compiled sparse network back to a neural network. */
+bool nzSparseNetCopyToNet(nzSparseNet *sn, nzNet *net)
+{
+  nzNeuronGroup *ng;
+  nzNeuron *np;
+  nzAxon *ap;
+  int gid, nid, i, c;
+
+  if( zListSize(net) < 2 || nzNetInputSize(net) != sn->ninput ) goto FAILURE;
+  for( i=0, c=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++, i++ ){
+      if( i >= sn->nneuron ) goto FAILURE;
+      np = ng->index[nid];
+      for( ap=np->data.axon; ap; ap=ap->next, c++ ){
+        if( c >= sn->offset[i+1] ) goto FAILURE;
+        ap->weight = sn->weight[c];
+      }
+      if( c != sn->offset[i+1] ) goto FAILURE;
+      np->data.bias = sn->bias[i];
+    }
+  }
+  if( i == sn->nneuron ) return true;
+ FAILURE:
+  ZRUNERROR( NEUZ_ERR_SPARSE_MISMATCH );
+  return false;
+}
+
+/* set input values to a compiled sparse network. */
+bool nzSparseNetSetInput(nzSparseNet *sn, zVec input)
+{
+  int i;
+
+  if( zVecSizeNC(input) != sn->ninput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, sn->ninput, zVecSizeNC(input) );
+    return false;
+  }
+  for( i=0; i<sn->ninput; i++ ) sn->value[i] = zVecElemNC(input,i);
+  return true;
+}
+
+/* get output values from a compiled sparse network. */
+bool nzSparseNetGetOutput(nzSparseNet *sn, zVec output)
+{
+  nzReal *value;
+  int i;
+
+  if( zVecSizeNC(output) != sn->noutput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, sn->noutput, zVecSizeNC(output) );
+    return false;
+  }
+  value = sn->value + sn->ninput + sn->nneuron - sn->noutput;
+  for( i=0; i<sn->noutput; i++ ) zVecElemNC(output,i) = value[i];
+  return true;
+}
+
+/* propagate input values to a compiled sparse network to the output. */
+bool nzSparseNetPropagate(nzSparseNet *sn, zVec input)
+{
+  nzReal *value;
+  double x;
+  int i, j;
+
+  if( input && !nzSparseNetSetInput( sn, input ) ) return false;
+  for( value=sn->value+sn->ninput, i=0; i<sn->nneuron; i++ ){
+    x = sn->bias[i];
+    for( j=sn->offset[i]; j<sn->offset[i+1]; j++ )
+      x += sn->weight[j] * sn->value[sn->upstream[j]];
+    sn->input[i] = x;
+    value[i] = sn->activator[i]->f( x );
+  }
+  return true;
+}
+
+/* initialize gradients of weights and biases of a compiled sparse network. */
+void nzSparseNetInitGrad(nzSparseNet *sn)
+{
+  memset( sn->_grad, 0, sizeof(nzReal) * sn->nparam );
+}
+
+/* back-propagate loss in a compiled sparse network. */
+bool nzSparseNetBackPropagate(nzSparseNet *sn, zVec input, zVec des, double (* lossgrad)(zVec,zVec,int))
+{
+  nzReal *p, *po, delta;
+  int i, j;
+
+  if( zVecSizeNC(des) != sn->noutput ){
+    ZRUNWARN( NEUZ_WARN_GROUP_MISMATCH_SIZ, sn->noutput, zVecSizeNC(des) );
+    return false;
+  }
+  if( !nzSparseNetPropagate( sn, input ) ) return false;
+  nzSparseNetGetOutput( sn, sn->_output );
+  memset( sn->_p, 0, sizeof(nzReal) * ( sn->ninput + sn->nneuron ) );
+  p = sn->_p + sn->ninput;
+  po = p + sn->nneuron - sn->noutput;
+  for( i=0; i<sn->noutput; i++ ) po[i] = lossgrad( sn->_output, des, i );
+  for( i=sn->nneuron-1; i>=0; i-- ){
+    delta = p[i] *= sn->activator[i]->df( sn->input[i] );
+    for( j=sn->offset[i]; j<sn->offset[i+1]; j++ ){
+      sn->_p[sn->upstream[j]] += delta * sn->weight[j];
+      sn->_dw[j] += delta * sn->value[sn->upstream[j]];
+    }
+    sn->_db[i] += delta;
+  }
+  return true;
+}
+
+/* train a compiled sparse network based on the steepest descent method. */
+void nzSparseNetTrainSDM(nzSparseNet *sn, double rate)
+{
+  int i;
+
+  for( i=0; i<sn->nparam; i++ )
+    sn->_param[i] -= rate * sn->_grad[i];
+}
@@ -0,0 +1,105 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * statistics of computation of neural networks.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include <neuz/neuz_stats.h>
+
+/* current time of a monotonic clock in seconds. */
+double nzStatsClock(void)
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/* initialize statistics of a neural network. */
+void nzNetStatsInit(nzNetStats *stats)
+{
+  stats->size = 0;
+  stats->group = NULL;
+}
+
+/* allocate statistics of a neural network for a given number of groups. */
+bool nzNetStatsAlloc(nzNetStats *stats, int size)
+{
+  nzNetStatsDestroy( stats );
+  if( !( stats->group = zAlloc( nzGroupStats, size ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  stats->size = size;
+  return true;
+}
+
+/* destroy statistics of a neural network. */
+void nzNetStatsDestroy(nzNetStats *stats)
+{
+  free( stats->group );
+  nzNetStatsInit( stats );
+}
+
+/* reset counters of statistics of a neural network. */
+void nzNetStatsReset(nzNetStats *stats)
+{
+  nzGroupStats *gs;
+  int k;
+
+  for( gs=stats->group; gs<stats->group+stats->size; gs++ )
+    for( k=0; k<NZ_STATS_PHASE_NUM; k++ ){
+      gs->time[k] = gs->madd[k] = 0;
+      gs->calls[k] = 0;
+    }
+}
+
+/* record a call of a phase of a neuron group. */
+void nzNetStatsRecord(nzNetStats *stats, int gid, int phase, double t0)
+{
+  nzGroupStats *gs;
+
+  if( gid < 0 || gid >= stats->size ) return;
+  gs = &stats->group[gid];
+  gs->time[phase] += nzStatsClock() - t0;
+  gs->calls[phase]++;
+  switch( phase ){
+  case NZ_STATS_PROPAGATE:     gs->madd[phase] += gs->nconn; break;
+  case NZ_STATS_BACKPROPAGATE: gs->madd[phase] += 2.0 * gs->nconn; break;
+  case NZ_STATS_TRAIN:         gs->madd[phase] += gs->nconn + gs->nneuron; break;
+  default: ;
+  }
+}
+
+/* total wall time of a phase over neuron groups. */
+double nzNetStatsTotalTime(nzNetStats *stats, int phase)
+{
+  double t = 0;
+  int i;
+
+  for( i=0; i<stats->size; i++ ) t += stats->group[i].time[phase];
+  return t;
+}
+
+/* print statistics of a neural network. */
+void nzNetStatsFPrint(FILE *fp, nzNetStats *stats)
+{
+  const char *phasename[] = { "propagate", "backpropagate", "train" };
+  nzGroupStats *gs;
+  int i, k;
+
+  fprintf( fp, "group neurons connections activator  phase          calls    time[s]   mean[us]   Mmadd/s\n" );
+  for( i=0; i<stats->size; i++ ){
+    gs = &stats->group[i];
+    for( k=0; k<NZ_STATS_PHASE_NUM; k++ ){
+      if( gs->calls[k] == 0 ) continue;
+      fprintf( fp, "%5d %7d %11d %-10s %-13s %7ld %10.6f %10.3f %9.2f\n",
+        i, gs->nneuron, gs->nconn, gs->activator ? gs->activator : "nil", phasename[k], gs->calls[k], gs->time[k],
+        1.0e6 * gs->time[k] / gs->calls[k], gs->time[k] > 0 ? 1.0e-6 * gs->madd[k] / gs->time[k] : 0 );
+    }
+  }
+  for( k=0; k<NZ_STATS_PHASE_NUM; k++ )
+    fprintf( fp, "total %-13s %10.6f [s]\n", phasename[k], nzNetStatsTotalTime( stats, k ) );
+}
@@ -0,0 +1,114 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * thread pool.
+ */
+
+#include <neuz/neuz_thread.h>
+#include <unistd.h>
+
+/* number of processors available. */
+int nzThreadNumProcessors(void)
+{
+  long n;
+
+  return ( n = sysconf( _SC_NPROCESSORS_ONLN ) ) > 0 ? (int)n : 1;
+}
+
+/* main loop of a worker thread. */
+static void *_nzThreadWorkerMain(void *arg)
+{
+  nzThreadWorker *worker;
+  nzThreadPool *pool;
+  unsigned long generation;
+
+  worker = (nzThreadWorker *)arg;
+  pool = worker->pool;
+  generation = 0; /* no task has been issued when the thread is created */
+  pthread_mutex_lock( &pool->mutex );
+  while( 1 ){
+    while( pool->generation == generation && !pool->quit )
+      pthread_cond_wait( &pool->cond_task, &pool->mutex );
+    if( pool->quit ) break;
+    generation = pool->generation;
+    pthread_mutex_unlock( &pool->mutex );
+    pool->task( pool->arg, worker->id );
+    pthread_mutex_lock( &pool->mutex );
+    if( --pool->nrunning == 0 )
+      pthread_cond_signal( &pool->cond_done );
+  }
+  pthread_mutex_unlock( &pool->mutex );
+  return NULL;
+}
+
+/* create a thread pool. */
+nzThreadPool *nzThreadPoolCreate(nzThreadPool *pool, int size)
+{
+  int i;
+
+  if( size < 1 ) size = nzThreadNumProcessors();
+  pool->size = 1;
+  pool->task = NULL;
+  pool->arg = NULL;
+  pool->generation = 0;
+  pool->nrunning = 0;
+  pool->quit = false;
+  if( !( pool->worker = zAlloc( nzThreadWorker, size - 1 ) ) && size > 1 ){
+    ZALLOCERROR();
+    pool->size = 0;
+    return NULL;
+  }
+  pthread_mutex_init( &pool->mutex, NULL );
+  pthread_cond_init( &pool->cond_task, NULL );
+  pthread_cond_init( &pool->cond_done, NULL );
+  for( i=0; i<size-1; i++, pool->size++ ){
+    pool->worker[i].pool = pool;
+    pool->worker[i].id = i + 1;
+    if( pthread_create( &pool->worker[i].thread, NULL, _nzThreadWorkerMain, &pool->worker[i] ) != 0 ){
+      ZRUNERROR( NEUZ_ERR_THREAD_CREATE );
+      nzThreadPoolDestroy( pool );
+      return NULL;
+    }
+  }
+  return pool;
+}
+
+/* destroy a thread pool to join all threads. */
+void nzThreadPoolDestroy(nzThreadPool *pool)
+{
+  int i;
+
+  if( pool->size == 0 ) return;
+  pthread_mutex_lock( &pool->mutex );
+  pool->quit = true;
+  pthread_cond_broadcast( &pool->cond_task );
+  pthread_mutex_unlock( &pool->mutex );
+  for( i=0; i<pool->size-1; i++ )
+    pthread_join( pool->worker[i].thread, NULL );
+  pthread_cond_destroy( &pool->cond_done );
+  pthread_cond_destroy( &pool->cond_task );
+  pthread_mutex_destroy( &pool->mutex );
+  zFree( pool->worker );
+  pool->size = 0;
+}
+
+/* run a task on every worker of a thread pool. */
+void nzThreadPoolRun(nzThreadPool *pool, void (* task)(void *, int), void *arg)
+{
+  if( pool->size <= 1 ){
+    task( arg, 0 );
+    return;
+  }
+  pthread_mutex_lock( &pool->mutex );
+  pool->task = task;
+  pool->arg = arg;
+  pool->nrunning = pool->size - 1;
+  pool->generation++;
+  pthread_cond_broadcast( &pool->cond_task );
+  pthread_mutex_unlock( &pool->mutex );
+  task( arg, 0 );
+  pthread_mutex_lock( &pool->mutex );
+  while( pool->nrunning > 0 )
+    pthread_cond_wait( &pool->cond_done, &pool->mutex );
+  pthread_mutex_unlock( &pool->mutex );
+}
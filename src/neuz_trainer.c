@@ -0,0 +1,103 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * data-parallel trainer of a compiled dense-layer network.
+ */
+
+#include <neuz/neuz_trainer.h>
+
+/* create a data-parallel trainer of a compiled dense-layer network. */
+nzDenseTrainer *nzDenseTrainerCreate(nzDenseTrainer *tr, nzDenseNet *dn, int nthread)
+{
+  int i;
+
+  tr->dn = dn;
+  tr->replica = NULL;
+  tr->_ret = NULL;
+  nzSIMDLevel(); /* to detect the instruction set before threads start */
+  if( !nzThreadPoolCreate( &tr->pool, nthread ) ) return NULL;
+  if( !( tr->replica = zAlloc( nzDenseNet, tr->pool.size ) ) ||
+      !( tr->_ret = zAlloc( bool, tr->pool.size ) ) ){
+    ZALLOCERROR();
+    goto FAILURE;
+  }
+  for( i=0; i<tr->pool.size; i++ )
+    if( !nzDenseNetShare( &tr->replica[i], dn ) ) goto FAILURE;
+  return tr;
+
+ FAILURE:
+  nzDenseTrainerDestroy( tr );
+  return NULL;
+}
+
+/* destroy a data-parallel trainer. */
+void nzDenseTrainerDestroy(nzDenseTrainer *tr)
+{
+  int i;
+
+  if( tr->replica )
+    for( i=0; i<tr->pool.size; i++ ) nzDenseNetDestroy( &tr->replica[i] );
+  zFree( tr->replica );
+  zFree( tr->_ret );
+  nzThreadPoolDestroy( &tr->pool );
+  tr->dn = NULL;
+}
+
+/* back-propagate a chunk of a batch in a replica. */
+static void _nzDenseTrainerBackPropagateTask(void *arg, int id)
+{
+  nzDenseTrainer *tr;
+  nzDenseNet *replica;
+  int s0, s1;
+
+  tr = (nzDenseTrainer *)arg;
+  replica = &tr->replica[id];
+  nzDenseNetInitGrad( replica );
+  s0 = nzThreadPartition( tr->_n, id,   tr->pool.size );
+  s1 = nzThreadPartition( tr->_n, id+1, tr->pool.size );
+  tr->_ret[id] = s0 == s1 ? true :
+    nzDenseNetBackPropagateBatchNC( replica,
+      tr->_input + s0*nzDenseNetInputSize(replica),
+      tr->_des + s0*nzDenseNetOutputSize(replica), s1 - s0, tr->_lossgrad );
+}
+
+/* add gradients of replicas to a part of those of the network. */
+static void _nzDenseTrainerReduceTask(void *arg, int id)
+{
+  nzDenseTrainer *tr;
+  nzReal *g, *gr;
+  int i, j, i0, i1;
+
+  tr = (nzDenseTrainer *)arg;
+  i0 = nzThreadPartition( tr->dn->nparam, id,   tr->pool.size );
+  i1 = nzThreadPartition( tr->dn->nparam, id+1, tr->pool.size );
+  g = tr->dn->_grad;
+  for( j=0; j<tr->pool.size; j++ )
+    for( gr=tr->replica[j]._grad, i=i0; i<i1; i++ )
+      g[i] += gr[i];
+}
+
+/* back-propagate loss of a batch of samples in parallel. */
+bool nzDenseTrainerBackPropagateBatch(nzDenseTrainer *tr, zMat input, zMat des, double (* lossgrad)(zVec,zVec,int))
+{
+  int i, n;
+
+  n = zMatRowSize(input);
+  if( zMatColSize(input) != nzDenseNetInputSize(tr->dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetInputSize(tr->dn), n, zMatColSize(input) );
+    return false;
+  }
+  if( zMatRowSize(des) != n || zMatColSize(des) != nzDenseNetOutputSize(tr->dn) ){
+    ZRUNWARN( NEUZ_WARN_BATCH_MISMATCH_SIZ, nzDenseNetOutputSize(tr->dn), zMatRowSize(des), zMatColSize(des) );
+    return false;
+  }
+  tr->_input = zMatBufNC(input);
+  tr->_des = zMatBufNC(des);
+  tr->_n = n;
+  tr->_lossgrad = lossgrad;
+  nzThreadPoolRun( &tr->pool, _nzDenseTrainerBackPropagateTask, tr );
+  for( i=0; i<tr->pool.size; i++ )
+    if( !tr->_ret[i] ) return false;
+  nzThreadPoolRun( &tr->pool, _nzDenseTrainerReduceTask, tr );
+  return true;
+}
@@ -0,0 +1,387 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * nz_codegen - generate a standalone C source of propagation of a
+ * neural network read from a ZTK file. The generated source depends
+ * only on the standard C library (math.h), and is compiled by any C89
+ * compiler.
+ */
+
+#include <ctype.h>
+#include <neuz/neuz.h>
+
+/* code generation options */
+typedef struct{
+  const char *prefix;   /* prefix of identifiers */
+  const char *type;     /* floating-point type of generated code */
+  bool loop;            /* generate loops over compressed sparse rows instead of straight-line code */
+  const char *input;    /* input ZTK file */
+  const char *output;   /* output C file */
+} codegen_t;
+
+/* activator functions supported in generated code */
+typedef struct{
+  nzActivator *activator; /* activator of the library */
+  const char *name;       /* suffix of the generated function */
+  const char *body;       /* body of the generated function, where x is the argument */
+  bool approx;            /* true if the activator of the library approximates the generated function */
+} codegen_activator_t;
+
+static const codegen_activator_t codegen_activator[] = {
+  { &nz_activator_ident,         NULL,         NULL, false },
+  { &nz_activator_step,          "step",       "x >= 0 ? 1 : 0", false },
+  { &nz_activator_sigmoid,       "sigmoid",    "1.0 / ( 1.0 + exp( -4.0 * x ) )", false },
+  { &nz_activator_sigmoid_fast,  "sigmoid",    "1.0 / ( 1.0 + exp( -4.0 * x ) )", true },
+  { &nz_activator_sigmoid_table, "sigmoid",    "1.0 / ( 1.0 + exp( -4.0 * x ) )", true },
+  { &nz_activator_relu,          "relu",       "x > 0 ? x : 0", false },
+  { &nz_activator_blunt_relu,    "blunt_relu", "0.5 * ( x + sqrt( x*x + 1 ) )", false },
+  { &nz_activator_softplus,      "softplus",   "log( 1.0 + exp( x ) )", false },
+  { &nz_activator_softplus_fast, "softplus",   "log( 1.0 + exp( x ) )", true },
+  { NULL, NULL, NULL, false },
+};
+
+void codegen_usage(const char *cmd)
+{
+  eprintf( "Usage: %s [options] <ZTK file>\n", cmd );
+  eprintf( " -p <prefix>  prefix of generated identifiers (default: nn)\n" );
+  eprintf( " -t <type>    floating-point type, float or double (default: double)\n" );
+  eprintf( " -l           generate loops over compressed sparse rows instead of straight-line code\n" );
+  eprintf( " -o <file>    output C file (default: the standard output)\n" );
+}
+
+bool codegen_option(codegen_t *cg, int argc, char *argv[])
+{
+  int i;
+
+  cg->prefix = "nn";
+  cg->type = "double";
+  cg->loop = false;
+  cg->input = cg->output = NULL;
+  for( i=1; i<argc; i++ ){
+    if( argv[i][0] != '-' ){
+      if( cg->input ) goto FAILURE;
+      cg->input = argv[i];
+      continue;
+    }
+    if( argv[i][1] == '\0' || argv[i][2] != '\0' ) goto FAILURE;
+    if( argv[i][1] == 'l' ){
+      cg->loop = true;
+      continue;
+    }
+    if( i+1 >= argc ) goto FAILURE;
+    switch( argv[i++][1] ){
+    case 'p': cg->prefix = argv[i]; break;
+    case 't': cg->type = argv[i]; break;
+    case 'o': cg->output = argv[i]; break;
+    default: goto FAILURE;
+    }
+  }
+  if( !cg->input ) goto FAILURE;
+  if( strcmp( cg->type, "double" ) != 0 && strcmp( cg->type, "float" ) != 0 ) goto FAILURE;
+  return true;
+
+ FAILURE:
+  codegen_usage( argv[0] );
+  return false;
+}
+
+/* find an activator function supported in generated code. */
+const codegen_activator_t *codegen_find_activator(nzActivator *activator)
+{
+  const codegen_activator_t *ca;
+
+  for( ca=codegen_activator; ca->activator; ca++ )
+    if( ca->activator == activator ) return ca;
+  return NULL;
+}
+
+/* number the neurons of a network serially, and check if it can be generated. */
+bool codegen_check(nzNet *net, int start[], int *nneuron, int *nconn)
+{
+  const codegen_activator_t *ca;
+  nzNeuronGroup *ng;
+  nzNeuron *np;
+  nzAxon *ap;
+  int gid, nid;
+  bool replaced = false;
+
+  if( zListSize(net) < 2 ){
+    eprintf( "cannot generate a one-or-less-layered network.\n" );
+    return false;
+  }
+  *nneuron = *nconn = 0;
+  for( gid=0; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    start[gid] = *nneuron;
+    *nneuron += zListSize( &ng->list );
+    for( nid=0; nid<zListSize(&ng->list); nid++ ){
+      np = ng->index[nid];
+      if( gid == 0 ){
+        if( np->data.activator ){
+          eprintf( "neurons of the input layer must not have activators.\n" );
+          return false;
+        }
+        continue;
+      }
+      if( !np->data.activator ){
+        eprintf( "neuron %d of group %d has no activator.\n", nid, gid );
+        return false;
+      }
+      if( !( ca = codegen_find_activator( np->data.activator ) ) ){
+        eprintf( "activator %s is not supported in generated code.\n", np->data.activator->typestr );
+        return false;
+      }
+      if( ca->approx && !replaced ){
+        eprintf( "warning: %s is replaced with the exact %s in generated code.\n", ca->activator->typestr, ca->name );
+        replaced = true;
+      }
+      for( ap=np->data.axon; ap; ap=ap->next, (*nconn)++ )
+        if( ((nzNeuron *)ap->upstream)->data.gid >= gid ){
+          eprintf( "axon from neuron group %d to %d cannot be generated.\n", ((nzNeuron *)ap->upstream)->data.gid, gid );
+          return false;
+        }
+    }
+  }
+  return true;
+}
+
+/* serial number of a neuron. */
+#define codegen_serial(start,np) ( (start)[(np)->data.gid] + (np)->data.nid )
+
+/* print an array of values separated by commas. */
+void codegen_print_array_begin(FILE *fp, codegen_t *cg, const char *name, int n)
+{
+  fprintf( fp, "static const %s %s_%s[%d] = {", cg->type, cg->prefix, name, zMax( n, 1 ) );
+}
+
+void codegen_print_array_elem(FILE *fp, int i, const char *fmt, double val)
+{
+  fprintf( fp, i % 4 == 0 ? "\n  " : " " );
+  fprintf( fp, fmt, val );
+  fprintf( fp, "," );
+}
+
+void codegen_print_array_end(FILE *fp, int n)
+{
+  fprintf( fp, n > 0 ? "\n};\n" : "\n  0\n};\n" );
+}
+
+/* print weights and biases. */
+void codegen_print_param(FILE *fp, codegen_t *cg, nzNet *net, int nconn, int nneuron)
+{
+  nzNeuronGroup *ng;
+  nzAxon *ap;
+  const char *fmt;
+  int gid, nid, i;
+
+  fmt = strcmp( cg->type, "float" ) == 0 ? "%.9g" : "%.17g";
+  codegen_print_array_begin( fp, cg, "weight", nconn );
+  for( i=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++ )
+      for( ap=ng->index[nid]->data.axon; ap; ap=ap->next )
+        codegen_print_array_elem( fp, i++, fmt, ap->weight );
+  }
+  codegen_print_array_end( fp, nconn );
+  codegen_print_array_begin( fp, cg, "bias", nneuron );
+  for( i=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++ )
+      codegen_print_array_elem( fp, i++, fmt, ng->index[nid]->data.bias );
+  }
+  codegen_print_array_end( fp, nneuron );
+}
+
+/* print compressed sparse rows of connections. */
+void codegen_print_csr(FILE *fp, codegen_t *cg, nzNet *net, int start[], int nneuron)
+{
+  nzNeuronGroup *ng;
+  nzAxon *ap;
+  int gid, nid, i, c;
+
+  fprintf( fp, "static const int %s_offset[%d] = {", cg->prefix, nneuron + 1 );
+  for( i=0, c=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++ ){
+      fprintf( fp, i++ % 8 == 0 ? "\n  %d," : " %d,", c );
+      for( ap=ng->index[nid]->data.axon; ap; ap=ap->next ) c++;
+    }
+  }
+  fprintf( fp, i % 8 == 0 ? "\n  %d\n};\n" : " %d\n};\n", c );
+  fprintf( fp, "static const int %s_upstream[%d] = {", cg->prefix, zMax( c, 1 ) );
+  for( i=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++ )
+      for( ap=ng->index[nid]->data.axon; ap; ap=ap->next )
+        fprintf( fp, i++ % 8 == 0 ? "\n  %d," : " %d,", codegen_serial( start, (nzNeuron *)ap->upstream ) );
+  }
+  fprintf( fp, i > 0 ? "\n};\n" : "\n  0\n};\n" );
+}
+
+/* print activator functions used in a network. */
+void codegen_print_activator(FILE *fp, codegen_t *cg, nzNet *net)
+{
+  const codegen_activator_t *ca, *cb, *cu;
+  nzNeuronGroup *ng;
+  int gid, nid;
+  bool used;
+
+  for( ca=codegen_activator; ca->activator; ca++ ){
+    if( !ca->name ) continue;
+    for( cb=codegen_activator; cb!=ca; cb++ )
+      if( cb->name && strcmp( cb->name, ca->name ) == 0 ) break;
+    if( cb != ca ) continue; /* already printed */
+    for( used=false, gid=1; !used && gid<zListSize(net); gid++ ){
+      ng = nzNetFindGroup( net, gid );
+      for( nid=0; nid<zListSize(&ng->list); nid++ ){
+        cu = codegen_find_activator( ng->index[nid]->data.activator );
+        if( cu->name && strcmp( cu->name, ca->name ) == 0 ){
+          used = true;
+          break;
+        }
+      }
+    }
+    if( used )
+      fprintf( fp, "static %s %s_%s(%s x){ return %s; }\n", cg->type, cg->prefix, ca->name, cg->type, ca->body );
+  }
+}
+
+/* print a call of an activator function applied to an expression. */
+void codegen_print_activate_begin(FILE *fp, codegen_t *cg, nzActivator *activator)
+{
+  const codegen_activator_t *ca;
+
+  ca = codegen_find_activator( activator );
+  if( ca->name )
+    fprintf( fp, "%s_%s( ", cg->prefix, ca->name );
+}
+
+void codegen_print_activate_end(FILE *fp, nzActivator *activator)
+{
+  if( codegen_find_activator( activator )->name )
+    fprintf( fp, " )" );
+}
+
+/* print straight-line propagation. */
+void codegen_print_straight(FILE *fp, codegen_t *cg, nzNet *net, int start[])
+{
+  nzNeuronGroup *ng;
+  nzNeuron *np;
+  nzAxon *ap;
+  int gid, nid, i, c;
+
+  for( i=0, c=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    for( nid=0; nid<zListSize(&ng->list); nid++, i++ ){
+      np = ng->index[nid];
+      fprintf( fp, "  v[%d] = ", codegen_serial( start, np ) );
+      codegen_print_activate_begin( fp, cg, np->data.activator );
+      fprintf( fp, "%s_bias[%d]", cg->prefix, i );
+      for( ap=np->data.axon; ap; ap=ap->next, c++ )
+        fprintf( fp, " + %s_weight[%d]*v[%d]", cg->prefix, c, codegen_serial( start, (nzNeuron *)ap->upstream ) );
+      codegen_print_activate_end( fp, np->data.activator );
+      fprintf( fp, ";\n" );
+    }
+  }
+}
+
+/* print propagation by loops over compressed sparse rows. */
+void codegen_print_loop(FILE *fp, codegen_t *cg, nzNet *net, int start[])
+{
+  nzNeuronGroup *ng;
+  int gid, nid, i, n;
+
+  for( i=0, gid=1; gid<zListSize(net); gid++ ){
+    ng = nzNetFindGroup( net, gid );
+    /* a loop per run of neurons sharing an activator */
+    for( nid=0; nid<zListSize(&ng->list); nid+=n, i+=n ){
+      for( n=1; nid+n<zListSize(&ng->list); n++ )
+        if( ng->index[nid+n]->data.activator != ng->index[nid]->data.activator ) break;
+      fprintf( fp, "  for( i=%d; i<%d; i++ ){\n", i, i+n );
+      fprintf( fp, "    x = %s_bias[i];\n", cg->prefix );
+      fprintf( fp, "    for( j=%s_offset[i]; j<%s_offset[i+1]; j++ ) x += %s_weight[j]*v[%s_upstream[j]];\n", cg->prefix, cg->prefix, cg->prefix, cg->prefix );
+      fprintf( fp, "    v[%d+i] = ", start[1] );
+      codegen_print_activate_begin( fp, cg, ng->index[nid]->data.activator );
+      fprintf( fp, "x" );
+      codegen_print_activate_end( fp, ng->index[nid]->data.activator );
+      fprintf( fp, ";\n  }\n" );
+    }
+  }
+}
+
+/* print a macro of a size, the name of which is prefixed in upper cases. */
+void codegen_print_macro(FILE *fp, codegen_t *cg, const char *name, int val)
+{
+  const char *cp;
+
+  fprintf( fp, "#define " );
+  for( cp=cg->prefix; *cp; cp++ ) fputc( toupper( *cp ), fp );
+  fprintf( fp, "_%s %d\n", name, val );
+}
+
+/* generate a C source of propagation of a network. */
+bool codegen(FILE *fp, codegen_t *cg, nzNet *net)
+{
+  int *start, nneuron, nconn, ninput, noutput, i;
+
+  if( !( start = zAlloc( int, zListSize(net) ) ) ){
+    ZALLOCERROR();
+    return false;
+  }
+  if( !codegen_check( net, start, &nneuron, &nconn ) ){
+    free( start );
+    return false;
+  }
+  ninput = nzNetInputSize( net );
+  noutput = nzNetOutputSize( net );
+  fprintf( fp, "/* generated by nz_codegen from %s; do not edit.\n", cg->input );
+  fprintf( fp, " * %d inputs, %d outputs, %d neurons, %d connections.\n", ninput, noutput, nneuron - ninput, nconn );
+  fprintf( fp, " *\n * void %s_propagate(const %s input[%d], %s output[%d]);\n */\n\n", cg->prefix, cg->type, ninput, cg->type, noutput );
+  fprintf( fp, "#include <math.h>\n\n" );
+  codegen_print_macro( fp, cg, "INPUT_SIZE", ninput );
+  codegen_print_macro( fp, cg, "OUTPUT_SIZE", noutput );
+  fprintf( fp, "\n" );
+  codegen_print_param( fp, cg, net, nconn, nneuron - ninput );
+  if( cg->loop ) codegen_print_csr( fp, cg, net, start, nneuron - ninput );
+  fprintf( fp, "\n" );
+  codegen_print_activator( fp, cg, net );
+  fprintf( fp, "\nvoid %s_propagate(const %s input[], %s output[])\n{\n", cg->prefix, cg->type, cg->type );
+  fprintf( fp, "  %s v[%d];\n", cg->type, nneuron );
+  if( cg->loop ) fprintf( fp, "  %s x;\n  int i, j;\n", cg->type );
+  fprintf( fp, "\n" );
+  if( cg->loop )
+    fprintf( fp, "  for( i=0; i<%d; i++ ) v[i] = input[i];\n", ninput );
+  else
+    for( i=0; i<ninput; i++ ) fprintf( fp, "  v[%d] = input[%d];\n", i, i );
+  if( cg->loop )
+    codegen_print_loop( fp, cg, net, start );
+  else
+    codegen_print_straight( fp, cg, net, start );
+  if( cg->loop )
+    fprintf( fp, "  for( i=0; i<%d; i++ ) output[i] = v[%d+i];\n", noutput, nneuron - noutput );
+  else
+    for( i=0; i<noutput; i++ ) fprintf( fp, "  output[%d] = v[%d];\n", i, nneuron - noutput + i );
+  fprintf( fp, "}\n" );
+  free( start );
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  codegen_t cg;
+  nzNet net;
+  FILE *fp = stdout;
+  bool ret;
+
+  if( !codegen_option( &cg, argc, argv ) ) return EXIT_FAILURE;
+  if( !nzNetReadZTK( &net, cg.input ) ) return EXIT_FAILURE;
+  if( cg.output && !( fp = fopen( cg.output, "w" ) ) ){
+    ZOPENERROR( cg.output );
+    nzNetDestroy( &net );
+    return EXIT_FAILURE;
+  }
+  ret = codegen( fp, &cg, &net );
+  if( fp != stdout ) fclose( fp );
+  nzNetDestroy( &net );
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,45 @@
+/* neuZ - Neural Network Library
+ * (C)Copyright, Zhidao, since 2020, all rights are reserved.
+ *
+ * nz_dataset_conv - convert a text file of samples, e.g. a CSV file,
+ * to a binary dataset file.
+ */
+
+#include <neuz/neuz.h>
+
+void dataset_conv_usage(const char *cmd)
+{
+  eprintf( "Usage: %s [options] <text file> <dataset file>\n", cmd );
+  eprintf( " -i <n>  number of inputs of a sample\n" );
+  eprintf( " -o <n>  number of desired outputs of a sample\n" );
+  eprintf( " -f      store elements in single precision (default: double precision)\n" );
+}
+
+int main(int argc, char *argv[])
+{
+  const char *file[2] = { NULL, NULL };
+  int ninput = -1, noutput = -1, realsize = sizeof(double);
+  int i, nfile = 0;
+  long nsample;
+
+  for( i=1; i<argc; i++ ){
+    if( strcmp( argv[i], "-f" ) == 0 )
+      realsize = sizeof(float);
+    else if( strcmp( argv[i], "-i" ) == 0 && i+1 < argc )
+      ninput = atoi( argv[++i] );
+    else if( strcmp( argv[i], "-o" ) == 0 && i+1 < argc )
+      noutput = atoi( argv[++i] );
+    else if( argv[i][0] != '-' && nfile < 2 )
+      file[nfile++] = argv[i];
+    else
+      break;
+  }
+  if( i < argc || nfile < 2 || ninput < 0 || noutput < 0 ){
+    dataset_conv_usage( argv[0] );
+    return EXIT_FAILURE;
+  }
+  if( ( nsample = nzDatasetConvertText( file[0], file[1], ninput, noutput, realsize ) ) < 0 )
+    return EXIT_FAILURE;
+  eprintf( "%ld samples of %d inputs and %d outputs written to %s.\n", nsample, ninput, noutput, file[1] );
+  return EXIT_SUCCESS;
+}